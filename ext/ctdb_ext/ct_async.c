@@ -0,0 +1,379 @@
+#include <ctdb_ext.h>
+#include <ct_async.h>
+
+extern VALUE mCT;
+
+/*
+ * c-tree calls only leave the GVL when linked against the multithreaded
+ * client library.  It lets any thread call c-tree as long as a session, and
+ * everything allocated from it, is used by one thread at a time.  The
+ * single threaded library keeps every call on a thread holding the GVL.
+ */
+#if defined(HAVE_CT_MTCLIENT) && defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL)
+#define CT_ASYNC_NOGVL 1
+#endif
+
+#if defined(CT_ASYNC_NOGVL) && defined(HAVE_PTHREAD_H) && \
+    defined(HAVE_RB_FIBER_SCHEDULER_CURRENT) && defined(HAVE_RB_WAIT_FOR_SINGLE_FD)
+#define CT_ASYNC_POOL 1
+#endif
+
+#ifdef CT_ASYNC_POOL
+
+#include <ruby/io.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+#define CT_ASYNC_DEFAULT_SIZE 4
+#define CT_ASYNC_MAX_SIZE 64
+
+/*
+ * A completion channel.  The worker signals the channel once the job is done
+ * and the waiting fiber polls it through the scheduler.  Channels are kept
+ * on a free list and reused.
+ */
+typedef struct ct_async_channel {
+    int rfd;
+    int wfd;
+    struct ct_async_channel *next;
+} ct_async_channel;
+
+typedef struct ct_async_job {
+    ct_async_func func;
+    void *arg;
+    void *result;
+    ct_async_channel *channel;
+    int done;
+    struct ct_async_job *next;
+} ct_async_job;
+
+static pthread_mutex_t ct_async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ct_async_ready = PTHREAD_COND_INITIALIZER;
+static ct_async_job *ct_async_head = NULL;
+static ct_async_job *ct_async_tail = NULL;
+static ct_async_channel *ct_async_channels = NULL;
+static int ct_async_size = CT_ASYNC_DEFAULT_SIZE;
+static int ct_async_workers = 0;
+static pid_t ct_async_pid = 0;
+
+static void *
+ct_async_worker(void *unused)
+{
+    ct_async_job *job;
+    uint64_t one = 1;
+    ssize_t n;
+
+    for ( ;; ) {
+        pthread_mutex_lock(&ct_async_lock);
+        while ( ct_async_head == NULL )
+            pthread_cond_wait(&ct_async_ready, &ct_async_lock);
+        job = ct_async_head;
+        if ( ( ct_async_head = job->next ) == NULL )
+            ct_async_tail = NULL;
+        pthread_mutex_unlock(&ct_async_lock);
+
+        job->result = job->func(job->arg);
+
+        do {
+#ifdef HAVE_SYS_EVENTFD_H
+            n = write(job->channel->wfd, &one, sizeof(one));
+#else
+            n = write(job->channel->wfd, "", 1);
+#endif
+        } while ( n < 0 && errno == EINTR );
+    }
+
+    return NULL;
+}
+
+/*
+ * Threads do not survive fork(2).  A child starts over with an empty pool,
+ * dropping any queued jobs and channels inherited from the parent.
+ */
+static void
+ct_async_after_fork(void)
+{
+    pid_t pid = getpid();
+
+    if ( ct_async_pid == pid ) return;
+
+    pthread_mutex_init(&ct_async_lock, NULL);
+    pthread_cond_init(&ct_async_ready, NULL);
+    ct_async_head = ct_async_tail = NULL;
+    ct_async_channels = NULL;
+    ct_async_workers = 0;
+    ct_async_pid = pid;
+}
+
+static ct_async_channel *
+ct_async_channel_checkout(void)
+{
+    ct_async_channel *channel;
+    int fds[2];
+
+    pthread_mutex_lock(&ct_async_lock);
+    if ( ( channel = ct_async_channels ) != NULL )
+        ct_async_channels = channel->next;
+    pthread_mutex_unlock(&ct_async_lock);
+
+    if ( channel != NULL ) return channel;
+
+#ifdef HAVE_SYS_EVENTFD_H
+    if ( ( fds[0] = fds[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK) ) < 0 )
+        rb_sys_fail("eventfd");
+#else
+    if ( pipe(fds) != 0 )
+        rb_sys_fail("pipe");
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+#endif
+
+    channel = ALLOC(ct_async_channel);
+    channel->rfd = fds[0];
+    channel->wfd = fds[1];
+    channel->next = NULL;
+
+    return channel;
+}
+
+static void
+ct_async_channel_checkin(ct_async_channel *channel)
+{
+    pthread_mutex_lock(&ct_async_lock);
+    channel->next = ct_async_channels;
+    ct_async_channels = channel;
+    pthread_mutex_unlock(&ct_async_lock);
+}
+
+// Consume the completion signal.  Returns non-zero once the job is done.
+static int
+ct_async_channel_read(ct_async_channel *channel)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+    uint64_t value;
+#else
+    char value;
+#endif
+    return read(channel->rfd, &value, sizeof(value)) > 0;
+}
+
+// Start a worker.  Returns 0 or the pthread_create error.
+static int
+ct_async_spawn(void)
+{
+    pthread_t thread;
+    pthread_attr_t attr;
+    int err;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if ( ( err = pthread_create(&thread, &attr, ct_async_worker, NULL) ) == 0 )
+        ct_async_workers++;
+    pthread_attr_destroy(&attr);
+
+    return err;
+}
+
+/*
+ * Queue a job.  A failed spawn is only an error when no worker is running,
+ * otherwise the job waits for an existing one.  Returns 0 or the
+ * pthread_create error, in which case the job was not queued.
+ */
+static int
+ct_async_submit(ct_async_job *job)
+{
+    int err = 0;
+
+    pthread_mutex_lock(&ct_async_lock);
+    if ( ct_async_workers < ct_async_size )
+        err = ct_async_spawn();
+    if ( ct_async_workers == 0 ) {
+        pthread_mutex_unlock(&ct_async_lock);
+        return err;
+    }
+    job->next = NULL;
+    if ( ct_async_tail == NULL )
+        ct_async_head = job;
+    else
+        ct_async_tail->next = job;
+    ct_async_tail = job;
+    pthread_cond_signal(&ct_async_ready);
+    pthread_mutex_unlock(&ct_async_lock);
+
+    return 0;
+}
+
+static VALUE
+ct_async_wait(VALUE ptr)
+{
+    ct_async_job *job = (ct_async_job *)ptr;
+
+    while ( !ct_async_channel_read(job->channel) )
+        rb_wait_for_single_fd(job->channel->rfd, RB_WAITFD_IN, NULL);
+    job->done = 1;
+
+    return Qnil;
+}
+
+static void *
+ct_async_wait_blocking(void *ptr)
+{
+    ct_async_job *job = (ct_async_job *)ptr;
+    struct pollfd pfd;
+
+    pfd.fd = job->channel->rfd;
+    pfd.events = POLLIN;
+    while ( !ct_async_channel_read(job->channel) )
+        poll(&pfd, 1, -1);
+    job->done = 1;
+
+    return NULL;
+}
+
+/*
+ * The job still references the caller's arguments, so if the fiber is
+ * interrupted the handle cannot be released until the worker has finished.
+ */
+static VALUE
+ct_async_wait_ensure(VALUE ptr)
+{
+    ct_async_job *job = (ct_async_job *)ptr;
+
+    if ( !job->done )
+        rb_thread_call_without_gvl(ct_async_wait_blocking, job, NULL, NULL);
+    ct_async_channel_checkin(job->channel);
+
+    return Qnil;
+}
+
+#endif
+
+void *
+ct_async_call(ct_async_func func, void *arg)
+{
+#ifdef CT_ASYNC_POOL
+    ct_async_job job;
+    int err;
+
+    if ( ct_async_size > 0 && rb_fiber_scheduler_current() != Qnil ) {
+        ct_async_after_fork();
+
+        job.func = func;
+        job.arg = arg;
+        job.result = NULL;
+        job.done = 0;
+        job.channel = ct_async_channel_checkout();
+
+        if ( ( err = ct_async_submit(&job) ) != 0 ) {
+            ct_async_channel_checkin(job.channel);
+            rb_syserr_fail(err, "pthread_create");
+        }
+        rb_ensure(ct_async_wait, (VALUE)&job, ct_async_wait_ensure, (VALUE)&job);
+
+        return job.result;
+    }
+#endif
+#ifdef CT_ASYNC_NOGVL
+    // c-tree calls cannot be interrupted, so there is no unblocking function.
+    return rb_thread_call_without_gvl(func, arg, NULL, NULL);
+#else
+    return func(arg);
+#endif
+}
+
+typedef struct {
+    ct_async_handle_func func;
+    CTHANDLE handle;
+    CTDBRET rc;
+} ct_async_handle_args;
+
+static void *
+ct_async_handle_run(void *ptr)
+{
+    ct_async_handle_args *args = (ct_async_handle_args *)ptr;
+    args->rc = args->func(args->handle);
+    return NULL;
+}
+
+CTDBRET
+ct_async_handle_call(ct_async_handle_func func, CTHANDLE handle)
+{
+    ct_async_handle_args args;
+
+    args.func = func;
+    args.handle = handle;
+    args.rc = CTDBRET_OK;
+    ct_async_call(ct_async_handle_run, &args);
+
+    return args.rc;
+}
+
+/*
+ * @return [Fixnum] Number of native worker threads used to run blocking
+ *   calls made from fibers under a Fiber scheduler.  0 when the extension
+ *   was built without scheduler support or against the single threaded
+ *   c-tree client library.
+ */
+static VALUE
+rb_ct_async_get_pool_size(VALUE self)
+{
+#ifdef CT_ASYNC_POOL
+    return INT2FIX(ct_async_size);
+#else
+    return INT2FIX(0);
+#endif
+}
+
+/*
+ * Set the maximum number of worker threads.  Workers are started on demand.
+ * A size of 0 disables the pool so fibers block their thread.
+ *
+ * @param [Fixnum] size
+ */
+static VALUE
+rb_ct_async_set_pool_size(VALUE self, VALUE size)
+{
+    int n;
+
+    Check_Type(size, T_FIXNUM);
+    n = FIX2INT(size);
+#ifdef CT_ASYNC_POOL
+    if ( n < 0 || n > CT_ASYNC_MAX_SIZE )
+        rb_raise(rb_eArgError, "Pool size must be between 0 and %d.", 
+            CT_ASYNC_MAX_SIZE);
+    // Workers already running are kept, a smaller size only stops growth.
+    ct_async_size = n;
+#else
+    if ( n != 0 )
+        rb_raise(rb_eNotImpError, "Built without Fiber scheduler support "
+            "or the multithreaded c-tree client.");
+#endif
+    return size;
+}
+
+void init_rb_ct_async()
+{
+#ifdef CT_ASYNC_POOL
+    ct_async_pid = getpid();
+#endif
+    /*
+     * True when built against the multithreaded c-tree client, so calls
+     * that wait on the server let other threads run.
+     */
+#ifdef CT_ASYNC_NOGVL
+    rb_define_const(mCT, "THREADED", Qtrue);
+#else
+    rb_define_const(mCT, "THREADED", Qfalse);
+#endif
+    rb_define_module_function(mCT, "async_pool_size", rb_ct_async_get_pool_size, 0);
+    rb_define_module_function(mCT, "async_pool_size=", rb_ct_async_set_pool_size, 1);
+}
@@ -0,0 +1,22 @@
+#ifndef RB_CT_ASYNC_H
+#define RB_CT_ASYNC_H
+
+void init_rb_ct_async();
+
+typedef void *(*ct_async_func)(void *);
+
+/*
+ * Run a blocking c-tree call without holding the GVL.  Under a Fiber
+ * scheduler the call is handed to the native worker pool and the calling
+ * fiber yields until it completes, otherwise the calling thread releases the
+ * GVL for it.  Built against the single threaded client library every call
+ * runs on the calling thread holding the GVL.  +func+ must not touch Ruby.
+ */
+void *ct_async_call(ct_async_func func, void *arg);
+
+typedef CTDBRET (*ct_async_handle_func)(CTHANDLE);
+
+// ct_async_call for a c-tree call taking only a handle, e.g. ctdbCommit.
+CTDBRET ct_async_handle_call(ct_async_handle_func func, CTHANDLE handle);
+
+#endif
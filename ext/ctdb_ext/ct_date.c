@@ -13,13 +13,26 @@ free_rb_ct_date(void *ptr)
     xfree(date);
 }
 
+static size_t
+memsize_rb_ct_date(const void *ptr)
+{
+    return sizeof(ct_date);
+}
+
+const rb_data_type_t ct_date_type = {
+    "CT::Date",
+    { 0, free_rb_ct_date, memsize_rb_ct_date, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
 ct_date_init_with(pCTDATE dt)
 {
     ct_date *date;
     VALUE obj;
 
-    obj = Data_Make_Struct(cCTDate, ct_date, 0, free_rb_ct_date, date); 
+    obj = TypedData_Make_Struct(cCTDate, ct_date, &ct_date_type, date); 
     date->value = (CTDATE)*dt;
     date->type  = CTDATE_MDCY;
 
@@ -32,7 +45,7 @@ ct_date_init_with2(pCTDATE dt, CTDATE_TYPE type)
   ct_date *date;
   VALUE obj;
 
-  obj = Data_Make_Struct(cCTDate, ct_date, 0, free_rb_ct_date, date); 
+  obj = TypedData_Make_Struct(cCTDate, ct_date, &ct_date_type, date); 
   date->value = (CTDATE)*dt;
   date->type  = type; 
 
@@ -219,19 +232,10 @@ static VALUE
 rb_ct_date_to_date(VALUE self)
 {
     ct_date *date;
-    NINT y, m, d;
-    CTDBRET rc;
-    VALUE rb_date;
 
     GetCTDate(self, date);
 
-    if ( ( rc = ctdbDateUnpack(date->value, &y, &m, &d) ) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbDateUnpack failed.", rc);
-
-    rb_date = rb_funcall(RUBY_CLASS("Date"), rb_intern("new"), 3, 
-        INT2FIX(y), INT2FIX(m), INT2FIX(d));
-
-    return rb_date;
+    return ct_temporal_date(date->value, CT_TEMPORAL_CORE);
 }
 
 /*
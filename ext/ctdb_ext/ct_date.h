@@ -6,7 +6,10 @@ typedef struct {
     CTDATE_TYPE type; 
 } ct_date;
 
-#define GetCTDate(obj, val) ( val = (ct_date*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_date_type;
+
+#define GetCTDate(obj, val) \
+    TypedData_Get_Struct(obj, ct_date, &ct_date_type, val);
 
 void init_rb_ct_date();
 void free_rb_ct_date(void *ptr);
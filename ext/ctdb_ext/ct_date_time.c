@@ -13,14 +13,27 @@ free_rb_ct_date_time(void *ptr)
     xfree(dt);
 }
 
+static size_t
+memsize_rb_ct_date_time(const void *ptr)
+{
+    return sizeof(ct_date_time);
+}
+
+const rb_data_type_t ct_date_time_type = {
+    "CT::DateTime",
+    { 0, free_rb_ct_date_time, memsize_rb_ct_date_time, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
 ct_date_time_init_with(pCTDATETIME dttm)
 {
     ct_date_time *datetime;
     VALUE obj;
 
-    obj = Data_Make_Struct(cCTDateTime, ct_date_time, 0, free_rb_ct_date_time,
-                           datetime);
+    obj = TypedData_Make_Struct(cCTDateTime, ct_date_time, &ct_date_time_type,
+                                datetime);
     datetime->value = (CTDATETIME)*dttm;
     datetime->date_type = CTDATE_MDCY;
     datetime->time_type = CTTIME_HHMS;
@@ -35,8 +48,8 @@ ct_date_time_init_with2(pCTDATETIME dttm, CTDATE_TYPE date_type,
     ct_date_time *datetime;
     VALUE obj;
 
-    obj = Data_Make_Struct(cCTDateTime, ct_date_time, 0, free_rb_ct_date_time,
-                           datetime);
+    obj = TypedData_Make_Struct(cCTDateTime, ct_date_time, &ct_date_time_type,
+                                datetime);
     datetime->value = (CTDATETIME)*dttm;
     datetime->date_type = date_type;
     datetime->time_type = time_type;
@@ -84,19 +97,11 @@ rb_ct_date_time_get_current_date_time(VALUE klass)
 static VALUE
 rb_ct_date_time_to_datetime(VALUE self)
 {
-    VALUE parts;
-    VALUE offset = INT2NUM(0);
-
-    parts = RSEND(self, "unpack");
-
-    return rb_funcall( RUBY_CLASS("DateTime"), rb_intern("new"), 7,
-                       rb_ary_entry(parts, 0),
-                       rb_ary_entry(parts, 1),
-                       rb_ary_entry(parts, 2),
-                       rb_ary_entry(parts, 3),
-                       rb_ary_entry(parts, 4),
-                       rb_ary_entry(parts, 5),
-                       offset );
+    ct_date_time *datetime;
+
+    GetCTDateTime(self, datetime);
+
+    return ct_temporal_date_time(datetime->value, CT_TEMPORAL_CORE);
 }
 
 /*
@@ -7,7 +7,10 @@ typedef struct {
     CTTIME_TYPE time_type;
 } ct_date_time;
 
-#define GetCTDateTime(obj, val) ( val = (ct_date_time*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_date_time_type;
+
+#define GetCTDateTime(obj, val) \
+    TypedData_Get_Struct(obj, ct_date_time, &ct_date_time_type, val);
 
 void init_rb_ct_date_time();
 void free_rb_ct_date_time();
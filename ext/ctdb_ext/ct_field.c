@@ -6,21 +6,57 @@ VALUE cCTField;
 extern VALUE mCT;
 extern VALUE cCTError;
 
+static void
+mark_rb_ct_field(void *ptr)
+{
+    ct_field *field = (ct_field *)ptr;
+    CT_GC_MARK(field->parent);
+}
+
 static void
 free_rb_ct_field(void *ptr)
 {
     ct_field *field = (ct_field *)ptr;
+
+    if ( field->table != NULL )
+        ct_table_release(field->table);
     xfree(field);
 }
 
+static size_t
+memsize_rb_ct_field(const void *ptr)
+{
+    return sizeof(ct_field);
+}
+
+static void
+compact_rb_ct_field(void *ptr)
+{
+    ct_field *field = (ct_field *)ptr;
+    CT_GC_UPDATE(field->parent);
+}
+
+const rb_data_type_t ct_field_type = {
+    "CT::Field",
+    { mark_rb_ct_field, free_rb_ct_field, memsize_rb_ct_field,
+      CT_DCOMPACT(compact_rb_ct_field), },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
-rb_ct_field_new(VALUE klass, CTHANDLE field_handle)
+rb_ct_field_new(VALUE klass, VALUE parent, ct_table *table,
+        CTHANDLE field_handle)
 {
     VALUE obj;
     ct_field *field;
 
-    obj = Data_Make_Struct(klass, ct_field, 0, free_rb_ct_field, field);
+    obj = TypedData_Make_Struct(klass, ct_field, &ct_field_type, field);
     field->handle = field_handle;
+    field->table = table;
+    field->generation = table->generation;
+    ct_table_retain(table);
+    RB_OBJ_WRITE(obj, &field->parent, parent);
 
     rb_obj_call_init(obj, 0, NULL); // CT::Field.initialize
 
@@ -92,6 +128,7 @@ rb_ct_field_set_length(VALUE self, VALUE length)
 
     Check_Type(length, T_FIXNUM);
 
+    rb_check_frozen(self);
     GetCTField(self, field);
 
     if ( ctdbSetFieldLength(field->handle, FIX2INT(length)) != CTDBRET_OK )
@@ -135,6 +172,7 @@ rb_ct_field_set_name(VALUE self, VALUE name)
 
     Check_Type(name, T_STRING);
 
+    rb_check_frozen(self);
     GetCTField(self, field);
 
     if ( ctdbSetFieldName(field->handle, RSTRING_PTR(name)) != CTDBRET_OK )
@@ -190,6 +228,7 @@ rb_ct_field_set_precision(VALUE self, VALUE precision)
 
     Check_Type(precision, T_FIXNUM);
     
+    rb_check_frozen(self);
     GetCTField(self, field);
 
     if ( ctdbSetFieldPrecision(field->handle, FIX2INT(precision)) != CTDBRET_OK )
@@ -2,12 +2,21 @@
 #define RB_CT_FIELD_H
 
 void init_rb_ct_field();
-VALUE rb_ct_field_new(VALUE klass, CTHANDLE field_handle);
+VALUE rb_ct_field_new(VALUE klass, VALUE parent, ct_table *table,
+        CTHANDLE field_handle);
 
 typedef struct {
     CTHANDLE handle;
+    ct_table *table;    // Native table owning the handle, retained
+    unsigned long generation; // table->generation when the handle was read
+    VALUE parent;       // Wrapper the field was read from
 } ct_field;
 
-#define GetCTField(obj, val) ( val = (ct_field*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_field_type;
+
+// Raises CT::Error once the table has invalidated the handle.
+#define GetCTField(obj, val) \
+    TypedData_Get_Struct(obj, ct_field, &ct_field_type, val); \
+    ct_table_check_generation((val)->table, (val)->generation);
 
 #endif
@@ -0,0 +1,463 @@
+#include <ctdb_ext.h>
+#include <ct_field_io.h>
+#include <errno.h>
+
+VALUE cCTFieldIO;
+
+extern VALUE mCT;
+extern VALUE cCTError;
+
+static void
+mark_rb_ct_field_io(void *ptr)
+{
+    ct_field_io *io = (ct_field_io *)ptr;
+    CT_GC_MARK(io->record);
+    CT_GC_MARK(io->buffer);
+}
+
+static void
+free_rb_ct_field_io(void *ptr)
+{
+    xfree(ptr);
+}
+
+static size_t
+memsize_rb_ct_field_io(const void *ptr)
+{
+    return sizeof(ct_field_io);
+}
+
+static void
+compact_rb_ct_field_io(void *ptr)
+{
+    ct_field_io *io = (ct_field_io *)ptr;
+    CT_GC_UPDATE(io->record);
+    CT_GC_UPDATE(io->buffer);
+}
+
+const rb_data_type_t ct_field_io_type = {
+    "CT::FieldIO",
+    { mark_rb_ct_field_io, free_rb_ct_field_io, memsize_rb_ct_field_io,
+      CT_DCOMPACT(compact_rb_ct_field_io), },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
+VALUE
+rb_ct_field_io_new(VALUE rb_record, NINT field_number, CTDBTYPE field_type,
+        VALUE mode)
+{
+    VALUE obj;
+    ct_field_io *io;
+    const char *m;
+
+    switch ( field_type ) {
+        case CT_BINARY :
+        case CT_VARBINARY :
+        case CT_LVB :
+            break;
+        default :
+            rb_raise(rb_eTypeError, "Field %d is not a binary field.",
+                field_number);
+    }
+
+    m = StringValueCStr(mode);
+    if ( m[0] != 'r' && m[0] != 'w' )
+        rb_raise(rb_eArgError, "Unknown mode `%s'", m);
+
+    obj = TypedData_Make_Struct(cCTFieldIO, ct_field_io, &ct_field_io_type, io);
+    RB_OBJ_WRITE(obj, &io->record, rb_record);
+    RB_OBJ_WRITE(obj, &io->buffer, Qnil);
+    io->field_number = field_number;
+    io->field_type = field_type;
+    io->pos = 0;
+
+    if ( m[0] == 'w' ) {
+        io->mode = CT_FIELD_IO_WRITE;
+        RB_OBJ_WRITE(obj, &io->buffer, rb_str_buf_new(0));
+    } else {
+        io->mode = CT_FIELD_IO_READ;
+    }
+
+    return obj;
+}
+
+static void
+ct_field_io_check(ct_field_io *io, int mode)
+{
+    if ( io->mode == CT_FIELD_IO_CLOSED )
+        rb_raise(rb_eIOError, "closed stream");
+    if ( mode != CT_FIELD_IO_CLOSED && io->mode != mode )
+        rb_raise(rb_eIOError, "not opened for %s",
+            mode == CT_FIELD_IO_READ ? "reading" : "writing");
+}
+
+/*
+ * Start and length of the field data within the record buffer.  Variable
+ * length binary fields are stored behind their 2 (VARBINARY) or 4 (LVB) byte
+ * length.  Reads slice the buffer directly, so the value is never copied as
+ * a whole.
+ */
+static const char *
+ct_field_io_data(ct_field_io *io, long *len)
+{
+    ct_record *record;
+    const char *addr;
+
+    GetCTRecord(io->record, record);
+
+    *len = 0;
+    if ( ctdbIsNullField(record->handle, io->field_number) == YES )
+        return NULL;
+
+    *len = (long)ctdbGetFieldDataLength(record->handle, io->field_number);
+
+    if ( ( addr = (const char *)ctdbGetFieldAddress(record->handle,
+            io->field_number) ) == NULL )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAddress failed for field %d.",
+            ctdbGetError(record->handle), io->field_number);
+
+    switch ( io->field_type ) {
+        case CT_VARBINARY :
+            return addr + 2;
+        case CT_LVB :
+            return addr + 4;
+        default :
+            return addr;
+    }
+}
+
+static long
+ct_field_io_size(ct_field_io *io)
+{
+    long len;
+
+    if ( io->mode == CT_FIELD_IO_WRITE )
+        return RSTRING_LEN(io->buffer);
+
+    ct_field_io_data(io, &len);
+    return len;
+}
+
+static VALUE
+ct_field_io_copy(ct_field_io *io, long length, VALUE outbuf)
+{
+    const char *data;
+    long len;
+
+    data = ct_field_io_data(io, &len);
+    if ( length > len - io->pos )
+        length = len - io->pos;
+    if ( length < 0 )
+        length = 0;
+
+    if ( NIL_P(outbuf) ) {
+        outbuf = rb_str_new(NULL, length);
+    } else {
+        StringValue(outbuf);
+        rb_str_resize(outbuf, length);
+    }
+    if ( length > 0 )
+        memcpy(RSTRING_PTR(outbuf), data + io->pos, length);
+    io->pos += length;
+
+    return outbuf;
+}
+
+/*
+ * Read +length+ bytes from the current position, or the rest of the field.
+ *
+ * @param [Fixnum, nil] length
+ * @param [String, nil] outbuf Buffer to read into.
+ * @return [String, nil] nil at the end of the field when +length+ is given.
+ * @raise [IOError] Not opened for reading.
+ */
+static VALUE
+rb_ct_field_io_read(int argc, VALUE *argv, VALUE self)
+{
+    ct_field_io *io;
+    VALUE length, outbuf;
+    long n;
+
+    rb_scan_args(argc, argv, "02", &length, &outbuf);
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_READ);
+
+    if ( NIL_P(length) )
+        return ct_field_io_copy(io, LONG_MAX, outbuf);
+
+    if ( ( n = NUM2LONG(length) ) < 0 )
+        rb_raise(rb_eArgError, "negative length %ld given", n);
+    if ( n > 0 && io->pos >= ct_field_io_size(io) )
+        return Qnil;
+
+    return ct_field_io_copy(io, n, outbuf);
+}
+
+/*
+ * Read at most +maxlen+ bytes, for IO.copy_stream and friends.
+ *
+ * @param [Fixnum] maxlen
+ * @param [String, nil] outbuf Buffer to read into.
+ * @return [String]
+ * @raise [EOFError] At the end of the field.
+ */
+static VALUE
+rb_ct_field_io_readpartial(int argc, VALUE *argv, VALUE self)
+{
+    ct_field_io *io;
+    VALUE maxlen, outbuf;
+
+    rb_scan_args(argc, argv, "11", &maxlen, &outbuf);
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_READ);
+
+    if ( io->pos >= ct_field_io_size(io) )
+        rb_raise(rb_eEOFError, "end of file reached");
+
+    return ct_field_io_copy(io, NUM2LONG(maxlen), outbuf);
+}
+
+/*
+ * Write at the current position.  Writes are buffered until #flush or
+ * #close sets the field.
+ *
+ * @param [String] str
+ * @return [Fixnum] Bytes written.
+ * @raise [IOError] Not opened for writing.
+ */
+static VALUE
+rb_ct_field_io_write(VALUE self, VALUE str)
+{
+    ct_field_io *io;
+    long len, end, n;
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_WRITE);
+
+    str = rb_obj_as_string(str);
+    n   = RSTRING_LEN(str);
+    len = RSTRING_LEN(io->buffer);
+    end = io->pos + n;
+
+    if ( end > len ) {
+        // Grow geometrically so a stream of small writes stays linear.
+        if ( (long)rb_str_capacity(io->buffer) < end )
+            rb_str_modify_expand(io->buffer, ( end > 2 * len ? end : 2 * len ) - len);
+        else
+            rb_str_modify(io->buffer);
+        if ( io->pos > len )
+            memset(RSTRING_PTR(io->buffer) + len, 0, io->pos - len);
+        rb_str_set_len(io->buffer, end);
+    } else {
+        rb_str_modify(io->buffer);
+    }
+
+    memcpy(RSTRING_PTR(io->buffer) + io->pos, RSTRING_PTR(str), n);
+    io->pos = end;
+
+    return LONG2NUM(n);
+}
+
+static VALUE
+rb_ct_field_io_append(VALUE self, VALUE str)
+{
+    rb_ct_field_io_write(self, str);
+    return self;
+}
+
+/*
+ * Set the field to everything written so far.
+ *
+ * @raise [CT::Error] ctdbSetFieldAsBinary failed.
+ */
+static VALUE
+rb_ct_field_io_flush(VALUE self)
+{
+    ct_field_io *io;
+    ct_record *record;
+    CTDBRET rc;
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_CLOSED);
+
+    if ( io->mode != CT_FIELD_IO_WRITE )
+        return self;
+
+    GetCTRecord(io->record, record);
+
+    rc = ctdbSetFieldAsBinary(record->handle, io->field_number,
+            RSTRING_PTR(io->buffer), (VRLEN)RSTRING_LEN(io->buffer));
+    if ( rc != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbSetFieldAsBinary failed for field %d.",
+            rc, io->field_number);
+
+    return self;
+}
+
+/*
+ * Flush pending writes and close the stream.
+ */
+static VALUE
+rb_ct_field_io_close(VALUE self)
+{
+    ct_field_io *io;
+
+    GetCTFieldIO(self, io);
+
+    if ( io->mode == CT_FIELD_IO_CLOSED )
+        return Qnil;
+
+    if ( io->mode == CT_FIELD_IO_WRITE )
+        rb_ct_field_io_flush(self);
+
+    io->mode = CT_FIELD_IO_CLOSED;
+    RB_OBJ_WRITE(self, &io->buffer, Qnil);
+
+    return Qnil;
+}
+
+static VALUE
+rb_ct_field_io_is_closed(VALUE self)
+{
+    ct_field_io *io;
+
+    GetCTFieldIO(self, io);
+
+    return io->mode == CT_FIELD_IO_CLOSED ? Qtrue : Qfalse;
+}
+
+/*
+ * @param [Fixnum] offset
+ * @param [Fixnum] whence IO::SEEK_SET, IO::SEEK_CUR or IO::SEEK_END
+ * @return [Fixnum] 0
+ * @raise [Errno::EINVAL] The resulting position is negative.
+ */
+static VALUE
+rb_ct_field_io_seek(int argc, VALUE *argv, VALUE self)
+{
+    ct_field_io *io;
+    VALUE offset, whence;
+    long pos;
+
+    rb_scan_args(argc, argv, "11", &offset, &whence);
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_CLOSED);
+
+    pos = NUM2LONG(offset);
+    switch ( NIL_P(whence) ? SEEK_SET : NUM2INT(whence) ) {
+        case SEEK_SET :
+            break;
+        case SEEK_CUR :
+            pos += io->pos;
+            break;
+        case SEEK_END :
+            pos += ct_field_io_size(io);
+            break;
+        default :
+            rb_raise(rb_eArgError, "Unknown whence %d", NUM2INT(whence));
+    }
+
+    if ( pos < 0 )
+        rb_syserr_fail(EINVAL, "CT::FieldIO#seek");
+
+    io->pos = pos;
+
+    return INT2FIX(0);
+}
+
+static VALUE
+rb_ct_field_io_get_pos(VALUE self)
+{
+    ct_field_io *io;
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_CLOSED);
+
+    return LONG2NUM(io->pos);
+}
+
+static VALUE
+rb_ct_field_io_set_pos(VALUE self, VALUE pos)
+{
+    rb_ct_field_io_seek(1, &pos, self);
+    return pos;
+}
+
+static VALUE
+rb_ct_field_io_rewind(VALUE self)
+{
+    ct_field_io *io;
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_CLOSED);
+
+    io->pos = 0;
+
+    return INT2FIX(0);
+}
+
+static VALUE
+rb_ct_field_io_is_eof(VALUE self)
+{
+    ct_field_io *io;
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_READ);
+
+    return io->pos >= ct_field_io_size(io) ? Qtrue : Qfalse;
+}
+
+/*
+ * @return [Fixnum] The field data length, or the bytes written so far.
+ */
+static VALUE
+rb_ct_field_io_get_size(VALUE self)
+{
+    ct_field_io *io;
+
+    GetCTFieldIO(self, io);
+    ct_field_io_check(io, CT_FIELD_IO_CLOSED);
+
+    return LONG2NUM(ct_field_io_size(io));
+}
+
+static VALUE
+rb_ct_field_io_binmode(VALUE self)
+{
+    return self;
+}
+
+static VALUE
+rb_ct_field_io_is_binmode(VALUE self)
+{
+    return Qtrue;
+}
+
+void
+init_rb_ct_field_io()
+{
+    cCTFieldIO = rb_define_class_under(mCT, "FieldIO", rb_cObject);
+
+    rb_undef_method(CLASS_OF(cCTFieldIO), "new");
+    rb_define_method(cCTFieldIO, "<<", rb_ct_field_io_append, 1);
+    rb_define_method(cCTFieldIO, "binmode", rb_ct_field_io_binmode, 0);
+    rb_define_method(cCTFieldIO, "binmode?", rb_ct_field_io_is_binmode, 0);
+    rb_define_method(cCTFieldIO, "close", rb_ct_field_io_close, 0);
+    rb_define_method(cCTFieldIO, "closed?", rb_ct_field_io_is_closed, 0);
+    rb_define_method(cCTFieldIO, "eof?", rb_ct_field_io_is_eof, 0);
+    rb_define_method(cCTFieldIO, "eof", rb_ct_field_io_is_eof, 0);
+    rb_define_method(cCTFieldIO, "flush", rb_ct_field_io_flush, 0);
+    rb_define_method(cCTFieldIO, "pos", rb_ct_field_io_get_pos, 0);
+    rb_define_method(cCTFieldIO, "pos=", rb_ct_field_io_set_pos, 1);
+    rb_define_method(cCTFieldIO, "read", rb_ct_field_io_read, -1);
+    rb_define_method(cCTFieldIO, "readpartial", rb_ct_field_io_readpartial, -1);
+    rb_define_method(cCTFieldIO, "rewind", rb_ct_field_io_rewind, 0);
+    rb_define_method(cCTFieldIO, "seek", rb_ct_field_io_seek, -1);
+    rb_define_method(cCTFieldIO, "size", rb_ct_field_io_get_size, 0);
+    rb_define_method(cCTFieldIO, "tell", rb_ct_field_io_get_pos, 0);
+    rb_define_method(cCTFieldIO, "write", rb_ct_field_io_write, 1);
+}
@@ -0,0 +1,27 @@
+#ifndef RB_CT_FIELD_IO_H
+#define RB_CT_FIELD_IO_H
+
+void init_rb_ct_field_io();
+VALUE rb_ct_field_io_new(VALUE rb_record, NINT field_number,
+        CTDBTYPE field_type, VALUE mode);
+
+#define CT_FIELD_IO_CLOSED 0
+#define CT_FIELD_IO_READ   1
+#define CT_FIELD_IO_WRITE  2
+
+typedef struct {
+    VALUE record;       // CT::Record whose buffer is streamed
+    NINT field_number;
+    CTDBTYPE field_type;
+    long pos;
+    VALUE buffer;       // Pending writes, set with ctdbSetFieldAsBinary on
+                        // #flush and #close
+    int mode;
+} ct_field_io;
+
+extern const rb_data_type_t ct_field_io_type;
+
+#define GetCTFieldIO(obj, val) \
+    TypedData_Get_Struct(obj, ct_field_io, &ct_field_io_type, val);
+
+#endif
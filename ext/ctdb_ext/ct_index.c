@@ -7,27 +7,73 @@ extern VALUE mCT;
 extern VALUE cCTError;
 extern VALUE cCTSegment;
 
+static void
+mark_rb_ct_index(void *ptr)
+{
+    ct_index *index = (ct_index *)ptr;
+    CT_GC_MARK(index->parent);
+    CT_GC_MARK(index->segments);
+}
+
 static void
 free_rb_ct_index(void *ptr)
 {
-   ct_index *index = (ct_index *)ptr;
-   xfree(index);
+    ct_index *index = (ct_index *)ptr;
+
+    if ( index->table != NULL )
+        ct_table_release(index->table);
+    xfree(index);
+}
+
+static size_t
+memsize_rb_ct_index(const void *ptr)
+{
+    return sizeof(ct_index);
 }
 
+static void
+compact_rb_ct_index(void *ptr)
+{
+    ct_index *index = (ct_index *)ptr;
+    CT_GC_UPDATE(index->parent);
+    CT_GC_UPDATE(index->segments);
+}
+
+const rb_data_type_t ct_index_type = {
+    "CT::Index",
+    { mark_rb_ct_index, free_rb_ct_index, memsize_rb_ct_index,
+      CT_DCOMPACT(compact_rb_ct_index), },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
-rb_ct_index_new(VALUE klass, CTHANDLE index_handle)
+rb_ct_index_new(VALUE klass, VALUE parent, ct_table *table,
+        CTHANDLE index_handle)
 {
     VALUE obj;
     ct_index *index;
 
-    obj = Data_Make_Struct(klass, ct_index, 0, free_rb_ct_index, index);
+    obj = TypedData_Make_Struct(klass, ct_index, &ct_index_type, index);
     index->handle = index_handle;
+    index->table = table;
+    index->generation = table->generation;
+    ct_table_retain(table);
+    RB_OBJ_WRITE(obj, &index->parent, parent);
+    index->segments = Qnil;
 
     rb_obj_call_init(obj, 0, NULL); // CT::Index.initialize
 
     return obj;
 }
 
+/*
+ * Add a segment on a field to the index.
+ *
+ * @param [CT::Field] field
+ * @param [Fixnum, nil] mode One of CT::SEG_*, CT::SEG_SCHSEG when nil.
+ * @raise [CT::Error] ctdbAddSegment failed.
+ */
 static VALUE
 rb_ct_index_add_segment(VALUE self, VALUE rb_field, VALUE mode)
 {
@@ -36,14 +82,17 @@ rb_ct_index_add_segment(VALUE self, VALUE rb_field, VALUE mode)
 
     Check_Type(rb_field, T_DATA);
 
+    rb_check_frozen(self);
     GetCTIndex(self, index);
     GetCTField(rb_field, field);
 
-    // TODO: Implement segment mode
-    if ( ! ctdbAddSegment(index->handle, field->handle, CTSEG_SCHSEG) )
+    if ( ! ctdbAddSegment(index->handle, field->handle, 
+            NIL_P(mode) ? CTSEG_SCHSEG : (CTSEG_MODE)NUM2INT(mode)) )
         rb_raise(cCTError, "[%d] ctdbAddSegment failed.", 
             ctdbGetError(index->handle));
 
+    index->segments = Qnil;
+    ct_table_reset_cache(index->table);
     return self;
 }
 
@@ -60,6 +109,19 @@ rb_ct_index_get_allow_dups(VALUE self)
     return ctdbGetIndexDuplicateFlag(index->handle) == YES ? Qtrue : Qfalse;
 }
 
+/*
+ * Check if the index allows null keys.
+ */
+static VALUE
+rb_ct_index_get_allow_nil(VALUE self)
+{
+    ct_index *index;
+
+    GetCTIndex(self, index);
+
+    return ctdbGetIndexNullFlag(index->handle) == YES ? Qtrue : Qfalse;
+}
+
 /*
  * Set the allow duplicate flag for this index.
  *
@@ -76,8 +138,9 @@ rb_ct_index_set_allow_dups(VALUE self, VALUE value)
         rb_raise(rb_eArgError, "Unexpected value type `%s' for CT_BOOL", 
                  rb_obj_classname(value));
 
+    rb_check_frozen(self);
     GetCTIndex(self, index);
-    v = (value == T_TRUE ? YES : NO);
+    v = (value == Qtrue ? YES : NO);
     
     if ( ctdbSetIndexDuplicateFlag(index->handle, v) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbSetIndexDuplicateFlag failed.", 
@@ -124,28 +187,62 @@ rb_ct_index_get_name(VALUE self)
  * with the segment.
  * @return [CT::Segment]
  */
+/*
+ * The frozen CT::Segment for every index segment, built on first use and
+ * kept until a segment is added or the table definition changes.
+ */
+static VALUE
+ct_index_cached_segments(VALUE self, ct_index *index)
+{
+    int j;
+    VRLEN cnt;
+    CTHANDLE segh;
+    VALUE segments;
+
+    if ( !NIL_P(index->segments) )
+        return index->segments;
+
+    if ( ( cnt = ctdbGetIndexSegmentCount(index->handle) ) == -1 )
+        rb_raise(cCTError, "[%d] ctdbGetIndexSegmentCount failed.", 
+                ctdbGetError(index->handle));
+
+    segments = rb_ary_new2(cnt);
+    for ( j = 0; j < cnt; j++ ) {
+        if ( ( segh = ctdbGetSegment(index->handle, j) ) == NULL )
+            rb_raise(cCTError, "[%d] ctdbGetSegment failed.", 
+                ctdbGetError(index->handle));
+
+        rb_ary_push(segments, rb_obj_freeze(
+                    rb_ct_segment_new(cCTSegment, self, index->table, segh)));
+    }
+
+    RB_OBJ_WRITE(self, &index->segments, rb_obj_freeze(segments));
+    return segments;
+}
+
 static VALUE
 rb_ct_index_get_segment(VALUE self, VALUE id)
 {
     ct_index *index;
-    CTHANDLE segh;
     VALUE segments;
     VALUE segment;
-    VALUE name;
+    long i;
+
+    GetCTIndex(self, index);
 
     if ( rb_type(id) == T_FIXNUM ) {
-        GetCTIndex(self, index);
-        if ( (segh = ctdbGetSegment(index->handle, FIX2INT(id)) ) == NULL )
+        segments = ct_index_cached_segments(self, index);
+        if ( FIX2LONG(id) < 0 || FIX2LONG(id) >= RARRAY_LEN(segments) )
             rb_raise(cCTError, "[%d] ctdbGetSegment failed.", 
                 ctdbGetError(index->handle));
 
-        return rb_ct_segment_new(cCTSegment, segh);
+        return RARRAY_AREF(segments, FIX2LONG(id));
     
     } else if ( rb_type(id) == T_STRING ) {
-        segments = RSEND(self, "segments");
-        while ( (segment = rb_ary_pop(segments)) ) {
-            name = RSEND(segment, "field_name");
-            if ( rb_funcall(name, rb_intern("=="), 1, id) == Qtrue )
+        segments = ct_index_cached_segments(self, index);
+        for ( i = 0; i < RARRAY_LEN(segments); i++ ) {
+            segment = RARRAY_AREF(segments, i);
+            if ( rb_str_equal(RSEND(segment, "field_name"), id) == Qtrue )
                 return segment;
         }
     } 
@@ -154,29 +251,19 @@ rb_ct_index_get_segment(VALUE self, VALUE id)
 }
 
 /*
- * Retrieve an Array of all Index Segments.
+ * Retrieve an Array of all Index Segments.  The same frozen objects are
+ * returned until the index or table is altered.
+ *
  * @return [Array]
  */
 static VALUE
 rb_ct_index_get_segments(VALUE self)
 {
     ct_index *index;
-    int j;
-    VRLEN cnt;
-    VALUE segments;
 
     GetCTIndex(self, index);
-    segments = rb_ary_new();
 
-    if ( ( cnt = ctdbGetIndexSegmentCount(index->handle) ) == -1 )
-        rb_raise(cCTError, "[%d] ctdbGetIndexSegmentCount failed.", 
-                ctdbGetError(index->handle));
-
-    for ( j = 0; j < cnt; j++ )
-        rb_ary_push(segments, 
-                rb_ct_segment_new(cCTSegment, ctdbGetSegment(index->handle, j))); 
-    
-    return segments;
+    return ct_index_cached_segments(self, index);
 }
 
 /*
@@ -207,6 +294,7 @@ init_rb_ct_index()
     rb_define_method(cCTIndex, "add_segment", rb_ct_index_add_segment, 2);
     rb_define_method(cCTIndex, "allow_dups?", rb_ct_index_get_allow_dups, 0);
     rb_define_method(cCTIndex, "allow_dups=", rb_ct_index_set_allow_dups, 1);
+    rb_define_method(cCTIndex, "allow_nil?", rb_ct_index_get_allow_nil, 0);
     rb_define_method(cCTIndex, "get_segment", rb_ct_index_get_segment, 1);
     rb_define_method(cCTIndex, "key_length", rb_ct_index_get_key_length, 0);
     rb_define_method(cCTIndex, "key_type",   rb_ct_index_get_key_type, 0);
@@ -2,12 +2,22 @@
 #define RB_CT_INDEX_H
 
 void init_rb_ct_index();
-VALUE rb_ct_index_new(VALUE klass, CTHANDLE index_handle);
+VALUE rb_ct_index_new(VALUE klass, VALUE parent, ct_table *table,
+        CTHANDLE index_handle);
 
 typedef struct {
     CTHANDLE handle;
+    ct_table *table;    // Native table owning the handle, retained
+    unsigned long generation; // table->generation when the handle was read
+    VALUE parent;       // Wrapper the index was read from
+    VALUE segments;     // Frozen CT::Segment cache, nil until first read
 } ct_index;
 
-#define GetCTIndex(obj, val) ( val = (ct_index*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_index_type;
+
+// Raises CT::Error once the table has invalidated the handle.
+#define GetCTIndex(obj, val) \
+    TypedData_Get_Struct(obj, ct_index, &ct_index_type, val); \
+    ct_table_check_generation((val)->table, (val)->generation);
 
 #endif
@@ -0,0 +1,209 @@
+#include <ctdb_ext.h>
+#ifdef HAVE_RB_RACTOR_MAKE_SHAREABLE
+#include <ruby/ractor.h>
+#endif
+
+#define CT_NUMERIC_MAX_SCALE 32
+#define CT_BIGINT_MAX_SCALE 18  // Largest power of ten held by a CTBIGINT
+
+extern VALUE cCTError;
+
+static VALUE powers;            // Integer 10**n
+static VALUE fractions;         // BigDecimal 10**-n
+static CTBIGINT bigint_powers[CT_BIGINT_MAX_SCALE + 1];
+static ID id_float, id_decimal, id_scaled;
+static ID id_BigDecimal, id_mul, id_fdiv, id_round, id_to_s;
+
+static VALUE
+ct_numeric_decimal(VALUE value)
+{
+    return rb_funcall(rb_mKernel, id_BigDecimal, 1, value);
+}
+
+static void
+ct_numeric_check_scale(int scale)
+{
+    if ( scale < 0 || scale > CT_NUMERIC_MAX_SCALE )
+        rb_raise(rb_eRangeError, "Scale %d out of range.", scale);
+}
+
+// BigDecimal 10**-scale
+static VALUE
+ct_numeric_fraction(int scale)
+{
+    return rb_ary_entry(fractions, scale);
+}
+
+ct_numeric_mode
+ct_numeric_mode_from_sym(VALUE sym)
+{
+    ID id;
+
+    Check_Type(sym, T_SYMBOL);
+    id = SYM2ID(sym);
+
+    if ( id == id_float )
+        return CT_NUMERIC_FLOAT;
+    if ( id == id_decimal )
+        return CT_NUMERIC_DECIMAL;
+    if ( id == id_scaled )
+        return CT_NUMERIC_SCALED;
+
+    rb_raise(rb_eArgError, "Unknown numeric mode `%s'", rb_id2name(id));
+    return CT_NUMERIC_FLOAT;
+}
+
+VALUE
+ct_numeric_mode_to_sym(ct_numeric_mode mode)
+{
+    switch ( mode ) {
+        case CT_NUMERIC_DECIMAL :
+            return ID2SYM(id_decimal);
+        case CT_NUMERIC_SCALED :
+            return ID2SYM(id_scaled);
+        default :
+            return ID2SYM(id_float);
+    }
+}
+
+VALUE
+ct_numeric_value(VALUE units, int scale, ct_numeric_mode mode)
+{
+    ct_numeric_check_scale(scale);
+
+    switch ( mode ) {
+        case CT_NUMERIC_SCALED :
+            return units;
+        case CT_NUMERIC_DECIMAL :
+            if ( scale == 0 )
+                return ct_numeric_decimal(units);
+            // BigDecimal multiplication is exact.
+            return rb_funcall(ct_numeric_decimal(units), id_mul, 1,
+                              ct_numeric_fraction(scale));
+        default :
+            if ( scale == 0 )
+                return units;
+            return rb_funcall(units, id_fdiv, 1, rb_ary_entry(powers, scale));
+    }
+}
+
+/*
+ * Integers are taken as whole values, or as units in CT_NUMERIC_SCALED mode.
+ * Any other Numeric is rounded to the scale.
+ */
+VALUE
+ct_numeric_units(VALUE value, int scale, ct_numeric_mode mode)
+{
+    VALUE scaled;
+
+    ct_numeric_check_scale(scale);
+
+    if ( rb_obj_is_kind_of(value, rb_cInteger) ) {
+        if ( mode == CT_NUMERIC_SCALED || scale == 0 )
+            return value;
+        return rb_funcall(value, id_mul, 1, rb_ary_entry(powers, scale));
+    }
+
+    if ( !rb_obj_is_kind_of(value, rb_cNumeric) )
+        rb_raise(rb_eTypeError, "Expected a Numeric, got %s.",
+                 rb_obj_classname(value));
+
+    scaled = rb_funcall(value, id_mul, 1, rb_ary_entry(powers, scale));
+    return rb_funcall(scaled, id_round, 0);
+}
+
+VALUE
+ct_numeric_number_to_units(pCTNUMBER number, int scale)
+{
+    CTDBRET rc;
+    CTNUMBER factor, scaled;
+    CTBIGINT units;
+    TEXT s[64];
+
+    ct_numeric_check_scale(scale);
+
+    if ( scale <= CT_BIGINT_MAX_SCALE ) {
+        if ( ( rc = ctdbBigIntToNumber(bigint_powers[scale], &factor) ) != CTDBRET_OK ||
+             ( rc = ctdbNumberMul(number, &factor, &scaled) ) != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbNumberMul failed.", rc);
+
+        if ( ctdbNumberToBigInt(&scaled, &units) == CTDBRET_OK )
+            return LL2NUM(units);
+    }
+
+    // Wider than a CTBIGINT.
+    if ( ( rc = ctdbNumberToString(number, s, (VRLEN)sizeof(s)) ) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbNumberToString failed.", rc);
+
+    return ct_numeric_units(ct_numeric_decimal(rb_str_new_cstr(s)), scale,
+                            CT_NUMERIC_FLOAT);
+}
+
+void
+ct_numeric_units_to_number(VALUE units, int scale, pCTNUMBER number)
+{
+    CTDBRET rc;
+    CTNUMBER factor, value;
+    VALUE s;
+
+    ct_numeric_check_scale(scale);
+
+    if ( scale <= CT_BIGINT_MAX_SCALE &&
+         rb_absint_numwords(units, 63, NULL) <= 1 ) {
+        if ( ( rc = ctdbBigIntToNumber(NUM2LL(units), &value) ) != CTDBRET_OK ||
+             ( rc = ctdbBigIntToNumber(bigint_powers[scale], &factor) ) != CTDBRET_OK ||
+             ( rc = ctdbNumberDiv(&value, &factor, number) ) != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbNumberDiv failed.", rc);
+        return;
+    }
+
+    // Wider than a CTBIGINT.
+    s = rb_funcall(ct_numeric_value(units, scale, CT_NUMERIC_DECIMAL), id_to_s,
+                   1, rb_str_new_cstr("F"));
+    if ( ( rc = ctdbStringToNumber(RSTRING_PTR(s), number) ) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbStringToNumber failed.", rc);
+}
+
+void
+init_rb_ct_numeric()
+{
+    VALUE power = INT2FIX(1);
+    char s[8];
+    int i;
+
+    id_float      = rb_intern("float");
+    id_decimal    = rb_intern("decimal");
+    id_scaled     = rb_intern("scaled");
+    id_BigDecimal = rb_intern("BigDecimal");
+    id_mul        = rb_intern("*");
+    id_fdiv       = rb_intern("fdiv");
+    id_round      = rb_intern("round");
+    id_to_s       = rb_intern("to_s");
+
+    // Loaded here rather than on first use: rb_require raises outside
+    // the main Ractor, and the fractions below are built with BigDecimal().
+    rb_require("bigdecimal");
+
+    powers = rb_ary_new2(CT_NUMERIC_MAX_SCALE + 1);
+    for ( i = 0; i <= CT_NUMERIC_MAX_SCALE; i++ ) {
+        rb_ary_store(powers, i, power);
+        if ( i <= CT_BIGINT_MAX_SCALE )
+            bigint_powers[i] = (CTBIGINT)NUM2LL(power);
+        power = rb_funcall(power, id_mul, 1, INT2FIX(10));
+    }
+    rb_obj_freeze(powers);
+    rb_gc_register_mark_object(powers);
+
+    // Built up front and frozen, so every Ractor only ever reads it.
+    fractions = rb_ary_new2(CT_NUMERIC_MAX_SCALE + 1);
+    for ( i = 0; i <= CT_NUMERIC_MAX_SCALE; i++ ) {
+        snprintf(s, sizeof(s), "1e-%d", i);
+        rb_ary_store(fractions, i, 
+            rb_obj_freeze(ct_numeric_decimal(rb_str_new_cstr(s))));
+    }
+    rb_obj_freeze(fractions);
+#ifdef HAVE_RB_RACTOR_MAKE_SHAREABLE
+    rb_ractor_make_shareable(fractions);
+#endif
+    rb_gc_register_mark_object(fractions);
+}
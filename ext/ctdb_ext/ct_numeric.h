@@ -0,0 +1,32 @@
+#ifndef RB_CT_NUMERIC_H
+#define RB_CT_NUMERIC_H
+
+// How NUMBER, MONEY and CURRENCY fields are returned by a CT::Record.
+typedef enum {
+    CT_NUMERIC_FLOAT = 0, // Float, or Integer for NUMBER fields without scale
+    CT_NUMERIC_DECIMAL,   // BigDecimal
+    CT_NUMERIC_SCALED     // Integer count of the smallest unit of the field,
+                          // e.g. cents for MONEY
+} ct_numeric_mode;
+
+// Decimal places of the fixed point c-tree types.
+#define CT_MONEY_SCALE 2
+#define CT_CURRENCY_SCALE 4
+
+void init_rb_ct_numeric();
+
+ct_numeric_mode ct_numeric_mode_from_sym(VALUE sym);
+VALUE ct_numeric_mode_to_sym(ct_numeric_mode mode);
+
+/*
+ * Fixed point values are carried as an Integer count of units of
+ * 10**-scale, so they are converted and summed without going through Float
+ * or a String.
+ */
+VALUE ct_numeric_value(VALUE units, int scale, ct_numeric_mode mode);
+VALUE ct_numeric_units(VALUE value, int scale, ct_numeric_mode mode);
+
+VALUE ct_numeric_number_to_units(pCTNUMBER number, int scale);
+void ct_numeric_units_to_number(VALUE units, int scale, pCTNUMBER number);
+
+#endif
@@ -41,15 +41,58 @@ ctdb_record_is_field_null(pCTHANDLE record_ptr, NINT field_num)
     return ctdbIsNullField(record_ptr, field_num);
 }
 
+static void
+mark_rb_ct_record(void *ptr)
+{
+    ct_record *record = (ct_record *)ptr;
+    CT_GC_MARK(record->rb_table);
+}
+
+/*
+ * The record holds a reference on its table, so the table handle is still
+ * allocated when the record is freed.
+ */
 static void
 free_rb_ct_record(void *ptr)
 {
     ct_record *record = (ct_record *)ptr;
 
-    // BUG: ctdbFreeRecord(record->handle); causes segfault.
+    if ( record->table != NULL ) {
+        if ( record->handle != NULL && !CT_TABLE_INHERITED(record->table) )
+            ctdbFreeRecord(record->handle);
+        ct_table_release(record->table);
+    }
     xfree(record);
 }
 
+static size_t
+memsize_rb_ct_record(const void *ptr)
+{
+    const ct_record *record = (const ct_record *)ptr;
+    size_t size = sizeof(ct_record);
+
+    // The record buffer is allocated by c-tree alongside the handle.
+    if ( record->handle != NULL )
+        size += ctdbGetRecordLength(record->handle);
+
+    return size;
+}
+
+static void
+compact_rb_ct_record(void *ptr)
+{
+    ct_record *record = (ct_record *)ptr;
+    CT_GC_UPDATE(record->rb_table);
+}
+
+const rb_data_type_t ct_record_type = {
+    "CT::Record",
+    { mark_rb_ct_record, free_rb_ct_record, memsize_rb_ct_record,
+      CT_DCOMPACT(compact_rb_ct_record), },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
 rb_ct_record_new(VALUE klass, VALUE rb_table)
 {
@@ -62,8 +105,12 @@ rb_ct_record_new(VALUE klass, VALUE rb_table)
 
     GetCTTable(rb_table, table);
 
-    obj = Data_Make_Struct(klass, ct_record, 0, free_rb_ct_record, record);
+    obj = TypedData_Make_Struct(klass, ct_record, &ct_record_type, record);
     record->table_ptr = table->handle;
+    record->generation = &table->generation;
+    record->table = table;
+    ct_table_retain(table);
+    RB_OBJ_WRITE(obj, &record->rb_table, rb_table);
 
     if ( ( record->handle = ctdbAllocRecord(record->table_ptr)) == NULL)
         rb_raise(cCTError, "[%d] ctdbAllocRecord failed.",
@@ -178,7 +225,6 @@ rb_ct_record_get_default_index(VALUE self)
 {
     ct_record *record;
     NINT i; // Index number
-    CTHANDLE ndx;
 
     GetCTRecord(self, record);
 
@@ -186,11 +232,83 @@ rb_ct_record_get_default_index(VALUE self)
         rb_raise(cCTError, "[%d] ctdbGetDefaultIndex failed.",
                 ctdbGetError(record->handle));
 
-    if ( ( ndx = ctdbGetIndex(record->table_ptr, i) ) == NULL )
-        rb_raise(cCTError, "[%d] ctdbGetIndex failed.",
-            ctdbGetError(record->handle));
+    // Share the table's cached CT::Index objects.
+    return rb_funcall(record->rb_table, rb_intern("get_index"), 1, INT2FIX(i));
+}
+
+/*
+ * How DATE, TIME and TIMESTAMP fields are returned.
+ *
+ * @return [Symbol] :ct, :core or :epoch
+ */
+static VALUE
+rb_ct_record_get_temporal_mode(VALUE self)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_temporal_mode_to_sym(record->temporal_mode);
+}
+
+/*
+ * Set how DATE, TIME and TIMESTAMP fields are returned.  :ct (the default)
+ * returns CT::Date, CT::Time and CT::DateTime objects.  :core converts
+ * straight to ::Date, ::Time and ::DateTime.  :epoch returns Integer seconds
+ * since 1970-01-01 UTC for dates and timestamps, and since midnight for
+ * times.  Values in every mode can be written back with #set_field.
+ *
+ * @param [Symbol] mode :ct, :core or :epoch
+ * @raise [ArgumentError] Unknown mode
+ */
+static VALUE
+rb_ct_record_set_temporal_mode(VALUE self, VALUE mode)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    record->temporal_mode = ct_temporal_mode_from_sym(mode);
+
+    return mode;
+}
+
+/*
+ * How NUMBER, MONEY and CURRENCY fields are returned.
+ *
+ * @return [Symbol] :float, :decimal or :scaled
+ */
+static VALUE
+rb_ct_record_get_numeric_mode(VALUE self)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_numeric_mode_to_sym(record->numeric_mode);
+}
+
+/*
+ * Set how NUMBER, MONEY and CURRENCY fields are returned.  :float (the
+ * default) returns Float, or Integer for NUMBER fields without a scale.
+ * :decimal returns exact BigDecimal values.  :scaled returns an Integer count
+ * of the smallest unit of the field: cents for MONEY, ten-thousandths for
+ * CURRENCY and 10**-scale for NUMBER.  In :scaled mode #set_field takes
+ * Integers as units too.
+ *
+ * @param [Symbol] mode :float, :decimal or :scaled
+ * @raise [ArgumentError] Unknown mode
+ */
+static VALUE
+rb_ct_record_set_numeric_mode(VALUE self, VALUE mode)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
 
-    return rb_ct_index_new(cCTIndex, ndx);
+    record->numeric_mode = ct_numeric_mode_from_sym(mode);
+
+    return mode;
 }
 
 /*
@@ -205,7 +323,7 @@ rb_ct_record_delete_bang(VALUE self)
 
     GetCTRecord(self, record);
 
-    if ( ctdbDeleteRecord(record->handle) != CTDBRET_OK )
+    if ( ct_async_handle_call(ctdbDeleteRecord, record->handle) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbDeleteRecord failed.",
             ctdbGetError(record->handle));
 
@@ -265,6 +383,83 @@ rb_ct_record_is_filtered(VALUE self)
     return ( ctdbIsFilteredRecord(record->handle) == YES ? Qtrue : Qfalse );
 }
 
+// Arguments for a record navigation call made through ct_async_call.
+typedef struct {
+    CTHANDLE handle;
+    NINT mode;          // Find or lock mode
+    CTDBRET rc;
+} ct_record_nav;
+
+static void *
+ct_record_nav_find(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbFindRecord(nav->handle, (CTFIND_MODE)nav->mode);
+    return NULL;
+}
+
+static void *
+ct_record_nav_lock(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbLockRecord(nav->handle, (CTLOCK_MODE)nav->mode);
+    return NULL;
+}
+
+static void *
+ct_record_nav_first(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbFirstRecord(nav->handle);
+    return NULL;
+}
+
+static void *
+ct_record_nav_last(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbLastRecord(nav->handle);
+    return NULL;
+}
+
+static void *
+ct_record_nav_next(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbNextRecord(nav->handle);
+    return NULL;
+}
+
+static void *
+ct_record_nav_prev(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbPrevRecord(nav->handle);
+    return NULL;
+}
+
+static void *
+ct_record_nav_read(void *ptr)
+{
+    ct_record_nav *nav = (ct_record_nav *)ptr;
+    nav->rc = ctdbReadRecord(nav->handle);
+    return NULL;
+}
+
+// Run a blocking navigation or lock call through ct_async_call.
+static CTDBRET
+ct_record_navigate(ct_record *record, ct_async_func func, NINT mode)
+{
+    ct_record_nav nav;
+
+    nav.handle = record->handle;
+    nav.mode = mode;
+    nav.rc = CTDBRET_OK;
+    ct_async_call(func, &nav);
+
+    return nav.rc;
+}
+
 /*
  * Find a record using the find mode as the find strategy.  Before using
  * CT::Record#find:
@@ -280,7 +475,7 @@ rb_ct_record_find(VALUE self, VALUE mode)
 
     GetCTRecord(self, record);
 
-    if ( ctdbFindRecord(record->handle, FIX2INT(mode)) != CTDBRET_OK )
+    if ( ct_record_navigate(record, ct_record_nav_find, FIX2INT(mode)) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbFindRecord failed.",
             ctdbGetError(record->handle));
 
@@ -297,7 +492,7 @@ rb_ct_record_first(VALUE self)
 
     GetCTRecord(self, record);
 
-    return ctdbFirstRecord(record->handle) == CTDBRET_OK ? self : Qnil;
+    return ct_record_navigate(record, ct_record_nav_first, 0) == CTDBRET_OK ? self : Qnil;
 }
 
 /*
@@ -311,7 +506,7 @@ rb_ct_record_first_bang(VALUE self)
 
     GetCTRecord(self, record);
 
-    if ( ctdbFirstRecord(record->handle) != CTDBRET_OK )
+    if ( ct_record_navigate(record, ct_record_nav_first, 0) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbFirstRecord failed.",
             ctdbGetError(record->handle));
 
@@ -319,119 +514,44 @@ rb_ct_record_first_bang(VALUE self)
 }
 
 static VALUE
-rb_ct_record_get_field(VALUE self, VALUE field_name)
+ct_record_date_value(ct_record *record, CTDATE date)
 {
-    ct_record *record;
-    CTHANDLE field;
-    CTDBTYPE field_type;
-    VALUE rb_value = Qnil;
+    if ( date == 0 )
+        return Qnil;
 
-    Check_Type(field_name, T_STRING);
+    if ( record->temporal_mode != CT_TEMPORAL_CT )
+        return ct_temporal_date(date, record->temporal_mode);
 
-    GetCTRecord(self, record);
+    return ct_date_init_with2(&date, ctdbGetDefDateType(record->handle));
+}
 
-    if ( ( field = ctdbGetFieldByName(record->table_ptr,
-            RSTRING_PTR(field_name)) ) == NULL )
-        rb_raise(cCTError, "[%d] ctdbGetFieldByName failed for `%s'",
-            ctdbGetError(record->handle), RSTRING_PTR(field_name));
+static VALUE
+ct_record_date_time_value(ct_record *record, CTDATETIME datetime)
+{
+    if ( datetime <= 0 )
+        return Qnil;
 
-    field_type = ctdbGetFieldType(field);
+    if ( record->temporal_mode != CT_TEMPORAL_CT )
+        return ct_temporal_date_time(datetime, record->temporal_mode);
 
-    switch(field_type){
-        case CT_BOOL :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_bool"), 
-                                   1, 
-                                   field_name );
-            break;
-         case CT_TINYINT :
-         case CT_SMALLINT :
-         case CT_INTEGER :
-         case CT_BIGINT :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_signed"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_UTINYINT :
-        case CT_USMALLINT :
-        case CT_UINTEGER :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_unsigned"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_NUMBER :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_number"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_CHARS :
-        case CT_FPSTRING :
-        case CT_F2STRING :
-        case CT_F4STRING :
-        case CT_PSTRING :
-        case CT_VARBINARY :
-        case CT_LVB :
-        case CT_VARCHAR :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_string"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_DATE :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_date"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_FLOAT :
-        case CT_EFLOAT :
-        case CT_DOUBLE :
-        case CT_MONEY :
-        case CT_CURRENCY :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_float"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_TIME :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_time"), 
-                                   1, 
-                                   field_name );
-            break;
-        case CT_TIMESTAMP :
-            rb_value = rb_funcall( self, 
-                                   rb_intern("get_field_as_date_time"), 
-                                   1, 
-                                   field_name );
-            break;
-        default:
-            rb_raise(rb_eNotImpError, "Unhandled field type for `%s'",
-                     RSTRING_PTR(field_name));
-            break;
-    }
-    
-    return rb_value;
+    return ct_date_time_init_with2(&datetime, 
+                                   ctdbGetDefDateType(record->handle),
+                                   ctdbGetDefTimeType(record->handle));
 }
 
-/*
- * @param [Fixnum, String] id The field number or name.
- * @return [Boolean]
- * @raise [CT::Error] ctdbGetFieldAsBool failed.
- */
 static VALUE
-rb_ct_record_get_field_as_bool(VALUE self, VALUE id)
+ct_record_time_value(ct_record *record, CTTIME time)
 {
-    ct_record *record;
-    NINT field_number;
-    CTBOOL value;
+    if ( record->temporal_mode != CT_TEMPORAL_CT )
+        return ct_temporal_time(time, record->temporal_mode);
 
-    GetCTRecord(self, record);
+    return ct_time_init_with2(&time, ctdbGetDefTimeType(record->handle));
+}
 
-    field_number = get_field_number(record, id);
+static VALUE
+ct_record_get_bool(ct_record *record, NINT field_number)
+{
+    CTBOOL value;
 
     if ( ctdbGetFieldAsBool(record->handle, field_number, &value) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbGetFieldAsBool failed.", 
@@ -440,172 +560,758 @@ rb_ct_record_get_field_as_bool(VALUE self, VALUE id)
     return value == YES ? Qtrue : Qfalse;
 }
 
-/*
- * @param [Fixnum, String] id The field number or name.
- * @return [Date]
- */
 static VALUE
-rb_ct_record_get_field_as_date(VALUE self, VALUE id)
+ct_record_get_date(ct_record *record, NINT field_number)
 {
-    ct_record *record;
-    NINT field_number;
     CTDATE date;
 
-    GetCTRecord(self, record);
-
-    field_number = get_field_number(record, id);
-
     if ( ctdbGetFieldAsDate(record->handle, field_number, &date) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbGetFieldAsDate failed.",
             ctdbGetError(record->handle));
   
-    if ( date > 0 )
-        return ct_date_init_with2(&date, ctdbGetDefDateType(record->handle));
-    else
-        return Qnil;
+    return ct_record_date_value(record, date);
 }
 
-/*
- * @param [Fixnum, String] id The field identifier 
- * @return [DateTime]
- */
 static VALUE
-rb_ct_record_get_field_as_date_time(VALUE self, VALUE id)
+ct_record_get_date_time(ct_record *record, NINT field_number)
 {
-    ct_record *record;
-    NINT field_number;
     CTDBRET rc;
     CTDATETIME datetime;
 
-    GetCTRecord(self, record);
-
-    field_number = get_field_number(record, id);
-    
     rc = ctdbGetFieldAsDateTime(record->handle, field_number, &datetime);
     if ( rc != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbGetFieldAsDateTime failed.", rc);
 
-    if ( datetime > 0 )
-        return ct_date_time_init_with2(&datetime, 
-                                       ctdbGetDefDateType(record->handle),
-                                       ctdbGetDefTimeType(record->handle));
-    else
-        return Qnil;
+    return ct_record_date_time_value(record, datetime);
 }
 
-/*
- * @return [Time]
- */
 static VALUE
-rb_ct_record_get_field_as_time(VALUE self, VALUE id)
+ct_record_get_time(ct_record *record, NINT field_number)
 {
-    ct_record *record;
-    NINT field_number;
     CTTIME time;
     CTDBRET rc;
 
-    GetCTRecord(self, record);
-    
-    field_number = get_field_number(record, id);
-
     rc = ctdbGetFieldAsTime(record->handle, field_number, &time);
     if ( rc != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbGetFieldAsTime failed.", rc);
 
-    return ct_time_init_with2(&time, ctdbGetDefTimeType(record->handle));
+    return ct_record_time_value(record, time);
 }
 
-/*
- * Retrieve field as Float value.
- *
- * @param [Fixnum, String] id The field number or name.
- * @return [Float]
- * @raise [CT::Error] ctdbGetFieldAsFloat failed.
- */
 static VALUE
-rb_ct_record_get_field_as_float(VALUE self, VALUE id)
+ct_record_get_float(ct_record *record, NINT field_number)
 {
-    ct_record *record;
-    NINT field_number;
     CTFLOAT value;
 
-    GetCTRecord(self, record);
-
-    field_number = get_field_number(record, id);
-
     if ( ctdbGetFieldAsFloat(record->handle, field_number, &value) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbGetFieldAsFloat failed for `%s'.",
-            ctdbGetError(record->handle), RSTRING_PTR(id));
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsFloat failed for field %d.",
+            ctdbGetError(record->handle), field_number);
 
     return rb_float_new(value);
 }
 
-/*
- * Retrieve the field as a signed value.
- *
- * @param [Fixnum, String] id The field number or name.
- * @return [Fixnum]
- * @raise [CT::Error] ctdbGetFieldAsSigned failed.
- */
 static VALUE
-rb_ct_record_get_field_as_signed(VALUE self, VALUE id)
+ct_record_get_signed(ct_record *record, NINT field_number)
 {
-    ct_record *record;
-    NINT field_number;
     CTSIGNED value;
 
-    GetCTRecord(self, record);
-
-    field_number = get_field_number(record, id);
-
     if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) 
         return Qnil;
 
     if ( ctdbGetFieldAsSigned(record->handle, field_number, &value) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbGetFieldAsSigned failed for `%s'.",
-            ctdbGetError(record->handle), RSTRING_PTR(id));
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsSigned failed for field %d.",
+            ctdbGetError(record->handle), field_number);
 
-    return INT2FIX(value);
+    return LONG2NUM(value);
 }
 
-/*
- * Retrieve the field as a number value.
- *
- * @param [Fixnum, String] id The field number or name.
- * @return [Fixnum]
- * @raise [CT::Error] ctdbGetFieldAsNumber failed.
- */
 static VALUE
-rb_ct_record_get_field_as_number(VALUE self, VALUE id)
+ct_record_get_bigint(ct_record *record, NINT field_number)
 {
-    ct_record *record;
-    NINT field_number;
-    CTDBRET rc;
-    CTBIGINT i;
-    CTNUMBER value;
-
-    GetCTRecord(self, record);
-
-    field_number = get_field_number(record, id);
+    CTBIGINT value;
 
     if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) 
         return Qnil;
 
-    if ( ctdbGetFieldAsNumber(record->handle, field_number, &value) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbGetFieldAsNumber failed for `%s'.",
-            ctdbGetError(record->handle), RSTRING_PTR(id));
+    if ( ctdbGetFieldAsBigint(record->handle, field_number, &value) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsBigint failed for field %d.",
+            ctdbGetError(record->handle), field_number);
 
-    rc = ctdbNumberToBigInt(&value, &i); 
-    if ( rc != CTDBRET_OK )  
-        rb_raise(cCTError, "[%d] ctdbNumberToBigint failed.", rc);
+    return LL2NUM(value);
+}
+
+static NINT
+ct_record_get_scale(ct_record *record, NINT field_number)
+{
+    CTHANDLE field;
+
+    if ( ( field = ctdbGetField(record->table_ptr, field_number) ) == NULL )
+        rb_raise(cCTError, "[%d] ctdbGetField failed for field %d.",
+            ctdbGetError(record->table_ptr), field_number);
 
-    return INT2NUM((CTBIGINT)&i);
+    return ctdbGetFieldScale(field);
 }
 
-/*
- * Retrieve the field as a string value.
- *
- * @param [Fixnum, String] id The field number or name.
+static VALUE
+ct_record_get_number(ct_record *record, NINT field_number)
+{
+    CTNUMBER value;
+    NINT scale;
+
+    if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) 
+        return Qnil;
+
+    if ( ctdbGetFieldAsNumber(record->handle, field_number, &value) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsNumber failed for field %d.",
+            ctdbGetError(record->handle), field_number);
+
+    scale = ct_record_get_scale(record, field_number);
+
+    return ct_numeric_value(ct_numeric_number_to_units(&value, scale), scale,
+                            record->numeric_mode);
+}
+
+static VALUE
+ct_record_get_money(ct_record *record, NINT field_number)
+{
+    CTMONEY value;
+
+    if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) 
+        return Qnil;
+
+    if ( ctdbGetFieldAsMoney(record->handle, field_number, &value) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsMoney failed for field %d.",
+            ctdbGetError(record->handle), field_number);
+
+    return ct_numeric_value(LONG2NUM(value), CT_MONEY_SCALE, 
+                            record->numeric_mode);
+}
+
+static VALUE
+ct_record_get_currency(ct_record *record, NINT field_number)
+{
+    CTCURRENCY value;
+
+    if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) 
+        return Qnil;
+
+    if ( ctdbGetFieldAsCurrency(record->handle, field_number, &value) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsCurrency failed for field %d.",
+            ctdbGetError(record->handle), field_number);
+
+    return ct_numeric_value(LL2NUM(value), CT_CURRENCY_SCALE, 
+                            record->numeric_mode);
+}
+
+static VALUE
+ct_record_get_string(ct_record *record, NINT field_number)
+{
+    VRLEN len;
+    VALUE value;
+
+    len = ctdbGetFieldDataLength(record->handle, field_number);
+
+    // Read into a heap buffer, long values would overflow the stack.
+    value = rb_str_buf_new(len + 1);
+    if ( ctdbGetFieldAsString(record->handle, field_number, 
+                              RSTRING_PTR(value), len + 1) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsString failed for field %d.",
+                ctdbGetError(record->handle), field_number);
+    rb_str_set_len(value, strlen(RSTRING_PTR(value)));
+    
+    return RSEND(value, "rstrip");
+}
+
+static VALUE
+ct_record_get_binary(ct_record *record, NINT field_number)
+{
+    VRLEN len;
+    VALUE value;
+
+    if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) 
+        return Qnil;
+
+    len = ctdbGetFieldDataLength(record->handle, field_number);
+
+    value = rb_str_new(NULL, len);
+    if ( len > 0 && ctdbGetFieldAsBinary(record->handle, field_number,
+                                         RSTRING_PTR(value), len) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsBinary failed for field %d.",
+                ctdbGetError(record->handle), field_number);
+
+    return value;
+}
+
+static VALUE
+ct_record_get_unsigned(ct_record *record, NINT field_number)
+{
+    CTUNSIGNED value;
+
+    if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) return Qnil;
+
+    if ( ctdbGetFieldAsUnsigned(record->handle, field_number, &value) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbGetFieldAsUnsigned failed.",
+                ctdbGetError(record->handle));
+
+    return UINT2NUM(value);
+}
+
+/*
+ * Decode a field of the record buffer by number and type, without going 
+ * through Ruby method dispatch.  Returns Qundef for unhandled field types.
+ */
+static VALUE
+ct_record_get_value(ct_record *record, NINT field_number, CTDBTYPE field_type)
+{
+    switch ( field_type ) {
+        case CT_BOOL :
+            return ct_record_get_bool(record, field_number);
+        case CT_TINYINT :
+        case CT_SMALLINT :
+        case CT_INTEGER :
+            return ct_record_get_signed(record, field_number);
+        case CT_BIGINT :
+            return ct_record_get_bigint(record, field_number);
+        case CT_UTINYINT :
+        case CT_USMALLINT :
+        case CT_UINTEGER :
+            return ct_record_get_unsigned(record, field_number);
+        case CT_NUMBER :
+            return ct_record_get_number(record, field_number);
+        case CT_CHARS :
+        case CT_FPSTRING :
+        case CT_F2STRING :
+        case CT_F4STRING :
+        case CT_PSTRING :
+        case CT_VARCHAR :
+            return ct_record_get_string(record, field_number);
+        case CT_BINARY :
+        case CT_VARBINARY :
+        case CT_LVB :
+            return ct_record_get_binary(record, field_number);
+        case CT_DATE :
+            return ct_record_get_date(record, field_number);
+        case CT_FLOAT :
+        case CT_EFLOAT :
+        case CT_DOUBLE :
+            return ct_record_get_float(record, field_number);
+        case CT_MONEY :
+            return ct_record_get_money(record, field_number);
+        case CT_CURRENCY :
+            return ct_record_get_currency(record, field_number);
+        case CT_TIME :
+            return ct_record_get_time(record, field_number);
+        case CT_TIMESTAMP :
+            return ct_record_get_date_time(record, field_number);
+        default :
+            return Qundef;
+    }
+}
+
+/*
+ * Field values captured from the record buffer without the GVL, so a walk
+ * over many rows costs one handoff rather than one per row.  The values are
+ * converted to Ruby, as ct_record_get_value would, once the GVL is held
+ * again.  Capturing only uses malloc, never Ruby.
+ */
+typedef struct {
+    int null;
+    union {
+        CTBOOL b;
+        CTSIGNED s;
+        CTUNSIGNED u;
+        CTBIGINT big;
+        CTFLOAT f;
+        CTMONEY money;
+        CTCURRENCY currency;
+        CTNUMBER number;
+        CTDATE date;
+        CTTIME time;
+        CTDATETIME datetime;
+        struct {
+            size_t offset;      // Into ct_rows.bytes
+            size_t length;
+        } bytes;
+    } v;
+} ct_cell;
+
+typedef struct {
+    long fields;
+    NINT *numbers;
+    CTDBTYPE *types;
+    NINT *scales;       // Of NUMBER fields
+    ct_cell *cells;     // +fields+ cells per row
+    long rows;
+    long capacity;      // Rows +cells+ has room for
+    char *bytes;        // String and binary values
+    size_t used;
+    size_t size;
+    int nomem;
+    CTDBRET rc;         // Set when a ctdbGetFieldAs call failed
+    const char *call;
+    NINT field;
+} ct_rows;
+
+static void
+ct_rows_init(ct_rows *rows, ct_record *record, long fields, NINT *numbers,
+        CTDBTYPE *types, NINT *scales)
+{
+    long i;
+
+    MEMZERO(rows, ct_rows, 1);
+    rows->fields = fields;
+    rows->numbers = numbers;
+    rows->types = types;
+    rows->scales = scales;
+    for ( i = 0; i < fields; i++ )
+        scales[i] = types[i] == CT_NUMBER ? 
+            ct_record_get_scale(record, numbers[i]) : 0;
+}
+
+static VALUE
+ct_rows_free(VALUE ptr)
+{
+    ct_rows *rows = (ct_rows *)ptr;
+
+    free(rows->cells);
+    free(rows->bytes);
+    rows->cells = NULL;
+    rows->bytes = NULL;
+
+    return Qnil;
+}
+
+// Forget the captured rows, keeping the memory.
+static void
+ct_rows_clear(ct_rows *rows)
+{
+    rows->rows = 0;
+    rows->used = 0;
+}
+
+static int
+ct_rows_reserve(ct_rows *rows, size_t length)
+{
+    size_t size;
+    char *bytes;
+
+    if ( rows->used + length <= rows->size )
+        return 1;
+
+    size = rows->size ? rows->size : 4096;
+    while ( size < rows->used + length ) size *= 2;
+    if ( ( bytes = realloc(rows->bytes, size) ) == NULL ) {
+        rows->nomem = 1;
+        return 0;
+    }
+    rows->bytes = bytes;
+    rows->size = size;
+
+    return 1;
+}
+
+/*
+ * Capture the fields of the current record.  Returns 0 when a value could
+ * not be read or stored, leaving the reason in +rows+.  NULL handling
+ * follows the single field getters.
+ */
+static int
+ct_rows_capture(ct_rows *rows, CTHANDLE handle)
+{
+    ct_cell *cells, *cell;
+    long capacity, i;
+    NINT n;
+    VRLEN len;
+    CTDBRET rc = CTDBRET_OK;
+    const char *call = NULL;
+
+    if ( rows->rows == rows->capacity ) {
+        capacity = rows->capacity ? rows->capacity * 2 : 64;
+        cells = realloc(rows->cells, capacity * rows->fields * sizeof(ct_cell));
+        if ( cells == NULL ) {
+            rows->nomem = 1;
+            return 0;
+        }
+        rows->cells = cells;
+        rows->capacity = capacity;
+    }
+
+    cell = rows->cells + rows->rows * rows->fields;
+    for ( i = 0; i < rows->fields; i++, cell++ ) {
+        n = rows->numbers[i];
+        cell->null = ctdb_record_is_field_null(handle, n) == YES;
+
+        switch ( rows->types[i] ) {
+            case CT_BOOL :
+                call = "ctdbGetFieldAsBool";
+                rc = ctdbGetFieldAsBool(handle, n, &cell->v.b);
+                break;
+            case CT_DATE :
+                call = "ctdbGetFieldAsDate";
+                rc = ctdbGetFieldAsDate(handle, n, &cell->v.date);
+                break;
+            case CT_TIME :
+                call = "ctdbGetFieldAsTime";
+                rc = ctdbGetFieldAsTime(handle, n, &cell->v.time);
+                break;
+            case CT_TIMESTAMP :
+                call = "ctdbGetFieldAsDateTime";
+                rc = ctdbGetFieldAsDateTime(handle, n, &cell->v.datetime);
+                break;
+            case CT_FLOAT :
+            case CT_EFLOAT :
+            case CT_DOUBLE :
+                call = "ctdbGetFieldAsFloat";
+                rc = ctdbGetFieldAsFloat(handle, n, &cell->v.f);
+                break;
+            case CT_CHARS :
+            case CT_FPSTRING :
+            case CT_F2STRING :
+            case CT_F4STRING :
+            case CT_PSTRING :
+            case CT_VARCHAR :
+                call = "ctdbGetFieldAsString";
+                len = ctdbGetFieldDataLength(handle, n);
+                if ( !ct_rows_reserve(rows, len + 1) )
+                    return 0;
+                rc = ctdbGetFieldAsString(handle, n, rows->bytes + rows->used,
+                                          len + 1);
+                cell->v.bytes.offset = rows->used;
+                cell->v.bytes.length = rc == CTDBRET_OK ? 
+                    strlen(rows->bytes + rows->used) : 0;
+                rows->used += cell->v.bytes.length;
+                break;
+            default :
+                if ( cell->null )
+                    continue;
+                switch ( rows->types[i] ) {
+                    case CT_TINYINT :
+                    case CT_SMALLINT :
+                    case CT_INTEGER :
+                        call = "ctdbGetFieldAsSigned";
+                        rc = ctdbGetFieldAsSigned(handle, n, &cell->v.s);
+                        break;
+                    case CT_BIGINT :
+                        call = "ctdbGetFieldAsBigint";
+                        rc = ctdbGetFieldAsBigint(handle, n, &cell->v.big);
+                        break;
+                    case CT_UTINYINT :
+                    case CT_USMALLINT :
+                    case CT_UINTEGER :
+                        call = "ctdbGetFieldAsUnsigned";
+                        rc = ctdbGetFieldAsUnsigned(handle, n, &cell->v.u);
+                        break;
+                    case CT_NUMBER :
+                        call = "ctdbGetFieldAsNumber";
+                        rc = ctdbGetFieldAsNumber(handle, n, &cell->v.number);
+                        break;
+                    case CT_MONEY :
+                        call = "ctdbGetFieldAsMoney";
+                        rc = ctdbGetFieldAsMoney(handle, n, &cell->v.money);
+                        break;
+                    case CT_CURRENCY :
+                        call = "ctdbGetFieldAsCurrency";
+                        rc = ctdbGetFieldAsCurrency(handle, n, &cell->v.currency);
+                        break;
+                    case CT_BINARY :
+                    case CT_VARBINARY :
+                    case CT_LVB :
+                        call = "ctdbGetFieldAsBinary";
+                        len = ctdbGetFieldDataLength(handle, n);
+                        if ( !ct_rows_reserve(rows, len) )
+                            return 0;
+                        cell->v.bytes.offset = rows->used;
+                        cell->v.bytes.length = len;
+                        if ( len > 0 )
+                            rc = ctdbGetFieldAsBinary(handle, n, 
+                                rows->bytes + rows->used, len);
+                        rows->used += len;
+                        break;
+                    default :
+                        break;
+                }
+                break;
+        }
+
+        if ( rc != CTDBRET_OK ) {
+            rows->rc = rc;
+            rows->call = call;
+            rows->field = n;
+            return 0;
+        }
+    }
+    rows->rows++;
+
+    return 1;
+}
+
+// Raise the error that stopped a capture, if any.
+static void
+ct_rows_check(ct_rows *rows)
+{
+    if ( rows->nomem )
+        rb_memerror();
+    if ( rows->rc != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] %s failed for field %d.", 
+            rows->rc, rows->call, rows->field);
+}
+
+// Convert a captured value.  Returns Qundef for unhandled field types.
+static VALUE
+ct_rows_value(ct_record *record, ct_rows *rows, long row, long i)
+{
+    ct_cell *cell = rows->cells + row * rows->fields + i;
+    VALUE value;
+
+    switch ( rows->types[i] ) {
+        case CT_BOOL :
+            return cell->v.b == YES ? Qtrue : Qfalse;
+        case CT_DATE :
+            return ct_record_date_value(record, cell->v.date);
+        case CT_TIME :
+            return ct_record_time_value(record, cell->v.time);
+        case CT_TIMESTAMP :
+            return ct_record_date_time_value(record, cell->v.datetime);
+        case CT_FLOAT :
+        case CT_EFLOAT :
+        case CT_DOUBLE :
+            return rb_float_new(cell->v.f);
+        case CT_CHARS :
+        case CT_FPSTRING :
+        case CT_F2STRING :
+        case CT_F4STRING :
+        case CT_PSTRING :
+        case CT_VARCHAR :
+            value = rb_str_new(rows->bytes + cell->v.bytes.offset, 
+                               cell->v.bytes.length);
+            return RSEND(value, "rstrip");
+        default :
+            break;
+    }
+
+    if ( cell->null )
+        return Qnil;
+
+    switch ( rows->types[i] ) {
+        case CT_TINYINT :
+        case CT_SMALLINT :
+        case CT_INTEGER :
+            return LONG2NUM(cell->v.s);
+        case CT_BIGINT :
+            return LL2NUM(cell->v.big);
+        case CT_UTINYINT :
+        case CT_USMALLINT :
+        case CT_UINTEGER :
+            return UINT2NUM(cell->v.u);
+        case CT_NUMBER :
+            return ct_numeric_value(
+                ct_numeric_number_to_units(&cell->v.number, rows->scales[i]),
+                rows->scales[i], record->numeric_mode);
+        case CT_MONEY :
+            return ct_numeric_value(LONG2NUM(cell->v.money), CT_MONEY_SCALE,
+                                    record->numeric_mode);
+        case CT_CURRENCY :
+            return ct_numeric_value(LL2NUM(cell->v.currency), 
+                                    CT_CURRENCY_SCALE, record->numeric_mode);
+        case CT_BINARY :
+        case CT_VARBINARY :
+        case CT_LVB :
+            return rb_str_new(rows->bytes + cell->v.bytes.offset,
+                              cell->v.bytes.length);
+        default :
+            return Qundef;
+    }
+}
+
+static VALUE
+rb_ct_record_get_field(VALUE self, VALUE field_name)
+{
+    ct_record *record;
+    CTHANDLE field;
+    VALUE rb_value;
+
+    Check_Type(field_name, T_STRING);
+
+    GetCTRecord(self, record);
+
+    if ( ( field = ctdbGetFieldByName(record->table_ptr,
+            RSTRING_PTR(field_name)) ) == NULL )
+        rb_raise(cCTError, "[%d] ctdbGetFieldByName failed for `%s'",
+            ctdbGetError(record->handle), RSTRING_PTR(field_name));
+
+    rb_value = ct_record_get_value(record, ctdbGetFieldNbr(field), 
+                                   ctdbGetFieldType(field));
+    if ( rb_value == Qundef )
+        rb_raise(rb_eNotImpError, "Unhandled field type for `%s'",
+                 RSTRING_PTR(field_name));
+    
+    return rb_value;
+}
+
+/*
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Boolean]
+ * @raise [CT::Error] ctdbGetFieldAsBool failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_bool(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_bool(record, get_field_number(record, id));
+}
+
+/*
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Date]
+ */
+static VALUE
+rb_ct_record_get_field_as_date(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_date(record, get_field_number(record, id));
+}
+
+/*
+ * @param [Fixnum, String] id The field identifier 
+ * @return [DateTime]
+ */
+static VALUE
+rb_ct_record_get_field_as_date_time(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_date_time(record, get_field_number(record, id));
+}
+
+/*
+ * @return [Time]
+ */
+static VALUE
+rb_ct_record_get_field_as_time(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+    
+    return ct_record_get_time(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve field as Float value.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Float]
+ * @raise [CT::Error] ctdbGetFieldAsFloat failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_float(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_float(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve the field as a signed value.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Integer]
+ * @raise [CT::Error] ctdbGetFieldAsSigned failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_signed(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_signed(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve the field as a 64-bit signed value.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Integer]
+ * @raise [CT::Error] ctdbGetFieldAsBigint failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_bigint(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_bigint(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve the field as a number value, at the scale of the field.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Integer, Float, BigDecimal] Depending on #numeric_mode.
+ * @raise [CT::Error] ctdbGetFieldAsNumber failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_number(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_number(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve the field as a money value.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Float, BigDecimal, Integer] Depending on #numeric_mode, cents in
+ *   :scaled mode.
+ * @raise [CT::Error] ctdbGetFieldAsMoney failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_money(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_money(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve the field as a currency value.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Float, BigDecimal, Integer] Depending on #numeric_mode,
+ *   ten-thousandths in :scaled mode.
+ * @raise [CT::Error] ctdbGetFieldAsCurrency failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_currency(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_currency(record, get_field_number(record, id));
+}
+
+/*
+ * Retrieve the field as a string value.
+ *
+ * @param [Fixnum, String] id The field number or name.
  * @return [String]
  * @raise [CT::Error] ctdbGetFieldAsString failed.
  */
@@ -613,46 +1319,90 @@ static VALUE
 rb_ct_record_get_field_as_string(VALUE self, VALUE id)
 {
     ct_record *record;
-    NINT field_number;
-    VRLEN len;
 
     GetCTRecord(self, record);
 
-    field_number = get_field_number(record, id);
-    len = ctdbGetFieldDataLength(record->handle, field_number);
+    return ct_record_get_string(record, get_field_number(record, id));
+}
 
-    TEXT value[len+1];
-    if ( ctdbGetFieldAsString(record->handle, field_number, value,
-                                          (VRLEN)sizeof(value)) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbGetFieldAsString failed for `%s'.",
-                ctdbGetError(record->handle), RSTRING_PTR(id));
-    
-    return RSEND(rb_str_new_cstr(value), "rstrip");
+/*
+ * Retrieve the field as raw bytes, NUL bytes included.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [String, nil] ASCII-8BIT String.
+ * @raise [CT::Error] ctdbGetFieldAsBinary failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_binary(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_binary(record, get_field_number(record, id));
+}
+
+static VALUE
+ct_record_field_io_close(VALUE io)
+{
+    return rb_funcall(io, rb_intern("close"), 0);
 }
 
 /*
+ * Stream a BINARY, VARBINARY or LVB field.  "r" reads slices straight from
+ * the record buffer, "w" collects writes and sets the field on close.  With a
+ * block the stream is closed once the block returns.
+ *
+ * @example
+ *   record.field_io("document") { |io| IO.copy_stream(io, file) }
+ *   record.field_io("document", "w") { |io| IO.copy_stream(file, io) }
+ *   record.write!
+ *
  * @param [Fixnum, String] id The field number or name.
- * @return [Fixnum]
- * @raise [CT::Error] ctdbGetFieldAsUnsigned failed.
+ * @param [String] mode "r" or "w"
+ * @return [CT::FieldIO, Object] The stream, or the block result.
+ * @raise [TypeError] Not a binary field.
  */
 static VALUE
-rb_ct_record_get_field_as_unsigned(VALUE self, VALUE id)
+rb_ct_record_field_io(int argc, VALUE *argv, VALUE self)
 {
     ct_record *record;
+    CTHANDLE field;
+    VALUE id, mode, io;
     NINT field_number;
-    CTUNSIGNED value;
+
+    rb_scan_args(argc, argv, "11", &id, &mode);
+    if ( SYMBOL_P(id) ) id = rb_sym2str(id);
+    if ( NIL_P(mode) ) mode = rb_str_new_cstr("r");
 
     GetCTRecord(self, record);
 
     field_number = get_field_number(record, id);
+    if ( ( field = ctdbGetField(record->table_ptr, field_number) ) == NULL )
+        rb_raise(cCTError, "[%d] ctdbGetField failed for field %d.",
+            ctdbGetError(record->table_ptr), field_number);
 
-    if ( ctdb_record_is_field_null(record->handle, field_number) == YES ) return Qnil;
+    io = rb_ct_field_io_new(self, field_number, ctdbGetFieldType(field), mode);
 
-    if ( ctdbGetFieldAsUnsigned(record->handle, field_number, &value) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbGetFieldAsUnsigned failed.",
-                ctdbGetError(record->handle));
+    if ( !rb_block_given_p() )
+        return io;
 
-    return UINT2NUM(value);
+    return rb_ensure(rb_yield, io, ct_record_field_io_close, io);
+}
+
+/*
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Fixnum]
+ * @raise [CT::Error] ctdbGetFieldAsUnsigned failed.
+ */
+static VALUE
+rb_ct_record_get_field_as_unsigned(VALUE self, VALUE id)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ct_record_get_unsigned(record, get_field_number(record, id));
 }
 
 /*
@@ -682,7 +1432,7 @@ rb_ct_record_last(VALUE self)
 
     GetCTRecord(self, record);
 
-    return ctdbLastRecord(record->handle) == CTDBRET_OK ? self : Qnil;
+    return ct_record_navigate(record, ct_record_nav_last, 0) == CTDBRET_OK ? self : Qnil;
 }
 
 /*
@@ -696,7 +1446,7 @@ rb_ct_record_last_bang(VALUE self)
 
     GetCTRecord(self, record);
 
-    if ( ctdbLastRecord(record->handle) != CTDBRET_OK )
+    if ( ct_record_navigate(record, ct_record_nav_last, 0) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbLastRecord failed.",
             ctdbGetError(record->handle));
 
@@ -715,107 +1465,717 @@ rb_ct_record_lock(VALUE self, VALUE mode)
 
     GetCTRecord(self, record);
 
-    if ( ctdbLockRecord(record->handle, FIX2INT(mode)) == CTDBRET_OK )
-        return Qtrue;
-    else
-        return Qfalse;
+    if ( ct_record_navigate(record, ct_record_nav_lock, FIX2INT(mode)) == CTDBRET_OK )
+        return Qtrue;
+    else
+        return Qfalse;
+}
+
+/*
+ * @see #lock
+ * @raise [CT::Error] ctdbLockRecord failed.
+ */
+static VALUE
+rb_ct_record_lock_bang(VALUE self, VALUE mode)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    if ( ct_record_navigate(record, ct_record_nav_lock, FIX2INT(mode)) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbLockRecord failed.",
+            ctdbGetError(record->handle));
+
+    return self;
+}
+
+/*
+ * Has CT::Record#lock been executed on this resource.
+ */
+static VALUE
+rb_ct_record_is_locked(VALUE self)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+    
+    return ((ctdbGetRecordLock(record->handle) != CTLOCK_FREE) ? Qtrue : Qfalse);
+}
+
+/* 
+ * Has CT::Record#lock(CT::LOCK_WRITE) been executed
+ */
+static VALUE
+rb_ct_record_is_write_locked(VALUE self)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+  
+    return ((ctdbGetRecordLock(record->handle) == CTLOCK_WRITE) ? Qtrue : Qfalse);
+}
+
+/*  
+ *  Has CT::Record#lock(CT::LOCK_READ) been executed
+ */
+static VALUE
+rb_ct_record_is_read_locked(VALUE self)
+{
+    ct_record *record;
+
+    GetCTRecord(self, record);
+
+    return ((ctdbGetRecordLock(record->handle) == CTLOCK_READ) ? Qtrue : Qfalse);
+}
+
+/* 
+ * Get the next record on a table.
+ *
+ * @return [CT::Record, nil]
+ */
+static VALUE
+rb_ct_record_next(VALUE self)
+{
+    ct_record *record;
+    CTDBRET rc;
+
+    GetCTRecord(self, record);
+
+    rc = ct_record_navigate(record, ct_record_nav_next, 0);
+    if ( rc != CTDBRET_OK && rc != INOT_ERR )
+        rb_raise(cCTError, "[%d] ctdbNextRecord failed.", rc);
+
+    return rc == INOT_ERR ? Qnil : self;
+}
+
+/* 
+ * Retrieve the record index number in the table's active record list
+ *
+ * @return [Fixnum]
+ */
+static VALUE
+rb_ct_record_get_nbr(VALUE self)
+{
+    ct_record *record;
+    NINT n;
+
+    GetCTRecord(self, record);
+
+    if ( ( n = ctdbGetRecordNbr(record->handle) ) == -1 )
+        rb_raise(cCTError, "[%d] ctdbGetRecordNbr failed.", 
+            ctdbGetError(record->handle));
+
+    return INT2FIX(n);
+}
+
+/*
+ * Offset of a field in the record buffer.  Fields in front of the first
+ * variable length field sit at the same offset in every record.
+ *
+ * @param [Fixnum, String] id The field number or name.
+ * @return [Fixnum]
+ * @raise [CT::Error] ctdbGetFieldOffset failed.
+ */
+static VALUE
+rb_ct_record_get_field_offset(VALUE self, VALUE id)
+{
+    ct_record *record;
+    NINT field_number;
+    VRLEN offset;
+
+    GetCTRecord(self, record);
+
+    field_number = get_field_number(record, id);
+
+    if ( ( offset = ctdbGetFieldOffset(record->handle, field_number) ) == -1 )
+        rb_raise(cCTError, "[%d] ctdbGetFieldOffset failed for field %d.",
+            ctdbGetError(record->handle), field_number);
+
+    return LONG2NUM(offset);
+}
+
+// Rows captured per job by a walk, bounding the memory held off the GVL.
+#define CT_RECORD_WALK_ROWS 1000
+
+// A walk from the current record onwards, run through ct_async_call.
+typedef struct {
+    CTHANDLE handle;
+    ct_rows *rows;
+    long want;          // Rows to capture in this job
+    int advance;        // Move past the current record before capturing
+    CTDBRET rc;         // INOT_ERR at the end of the table
+} ct_record_walk;
+
+static void *
+ct_record_walk_run(void *ptr)
+{
+    ct_record_walk *walk = (ct_record_walk *)ptr;
+
+    walk->rc = CTDBRET_OK;
+    while ( walk->rows->rows < walk->want ) {
+        if ( walk->advance &&
+                ( walk->rc = ctdbNextRecord(walk->handle) ) != CTDBRET_OK )
+            break;
+        walk->advance = 1;
+        if ( !ct_rows_capture(walk->rows, walk->handle) )
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * Capture the next rows of a walk, at most +max+ in total (-1 for no
+ * limit) given +count+ already read.  Returns 0 once the walk is over.
+ */
+static int
+ct_record_walk_next(ct_record_walk *walk, long count, long max)
+{
+    if ( count == max || walk->rc == INOT_ERR )
+        return 0;
+
+    ct_rows_clear(walk->rows);
+    walk->want = max < 0 || max - count > CT_RECORD_WALK_ROWS ? 
+        CT_RECORD_WALK_ROWS : max - count;
+    ct_async_call(ct_record_walk_run, walk);
+    ct_rows_check(walk->rows);
+
+    if ( walk->rc != CTDBRET_OK && walk->rc != INOT_ERR )
+        rb_raise(cCTError, "[%d] ctdbNextRecord failed.", walk->rc);
+
+    return walk->rows->rows > 0;
+}
+
+static void
+ct_record_walk_init(ct_record_walk *walk, ct_record *record, ct_rows *rows)
+{
+    walk->handle = record->handle;
+    walk->rows = rows;
+    walk->advance = 0;
+    walk->rc = CTDBRET_OK;
+}
+
+typedef struct {
+    ct_record *record;
+    ct_rows *rows;
+    long max;
+} ct_record_pluck_args;
+
+static VALUE
+ct_record_pluck_walk(VALUE ptr)
+{
+    ct_record_pluck_args *args = (ct_record_pluck_args *)ptr;
+    ct_rows *rows = args->rows;
+    ct_record_walk walk;
+    VALUE result, row, value;
+    long i, r, count = 0;
+
+    result = rb_ary_new();
+    ct_record_walk_init(&walk, args->record, rows);
+
+    while ( ct_record_walk_next(&walk, count, args->max) ) {
+        for ( r = 0; r < rows->rows; r++ ) {
+            row = ( rows->fields == 1 ? Qnil : rb_ary_new2(rows->fields) );
+            for ( i = 0; i < rows->fields; i++ ) {
+                value = ct_rows_value(args->record, rows, r, i);
+                if ( value == Qundef )
+                    rb_raise(rb_eNotImpError, 
+                        "Unhandled field type for field %d", rows->numbers[i]);
+                if ( rows->fields == 1 )
+                    row = value;
+                else
+                    rb_ary_store(row, i, value);
+            }
+            rb_ary_push(result, row);
+        }
+        count += rows->rows;
+    }
+
+    return result;
 }
 
 /*
- * @see #lock
- * @raise [CT::Error] ctdbLockRecord failed.
+ * Read the given fields from the current record onwards, straight from the
+ * record buffer and without building a CT::Record per row.  The walk stops
+ * after +limit+ rows, leaving the record positioned on the last row read, or
+ * at the end of the table.  Rows are read in chunks without the GVL.
+ *
+ * @param [Array<String, Symbol>] fields The field names.
+ * @param [Fixnum, nil] limit The maximum number of rows to read.
+ * @return [Array] An Array of values per row, or a flat Array of values when
+ *   only one field is given.
+ * @raise [CT::Error] ctdbGetFieldByName or ctdbNextRecord failed.
  */
 static VALUE
-rb_ct_record_lock_bang(VALUE self, VALUE mode)
+rb_ct_record_pluck(int argc, VALUE *argv, VALUE self)
 {
     ct_record *record;
+    ct_rows rows;
+    ct_record_pluck_args args;
+    VALUE fields, limit, name;
+    CTHANDLE field;
+    NINT *numbers, *scales;
+    CTDBTYPE *types;
+    long i, n;
+
+    rb_scan_args(argc, argv, "11", &fields, &limit);
+    Check_Type(fields, T_ARRAY);
 
     GetCTRecord(self, record);
 
-    if ( ctdbLockRecord(record->handle, FIX2INT(mode)) != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbLockRecord failed.",
-            ctdbGetError(record->handle));
+    if ( ( n = RARRAY_LEN(fields) ) == 0 )
+        rb_raise(rb_eArgError, "No fields given.");
 
-    return self;
+    numbers = ALLOCA_N(NINT, n);
+    types   = ALLOCA_N(CTDBTYPE, n);
+    scales  = ALLOCA_N(NINT, n);
+
+    // Resolve each field once for the whole walk.
+    for ( i = 0; i < n; i++ ) {
+        name = rb_ary_entry(fields, i);
+        if ( SYMBOL_P(name) ) name = rb_sym2str(name);
+        Check_Type(name, T_STRING);
+
+        if ( ( field = ctdbGetFieldByName(record->table_ptr,
+                RSTRING_PTR(name)) ) == NULL )
+            rb_raise(cCTError, "[%d] ctdbGetFieldByName failed for `%s'",
+                ctdbGetError(record->handle), RSTRING_PTR(name));
+
+        numbers[i] = ctdbGetFieldNbr(field);
+        types[i]   = ctdbGetFieldType(field);
+    }
+
+    ct_rows_init(&rows, record, n, numbers, types, scales);
+    args.record = record;
+    args.rows = &rows;
+    args.max = NIL_P(limit) ? -1 : NUM2LONG(limit);
+
+    return rb_ensure(ct_record_pluck_walk, (VALUE)&args, 
+                     ct_rows_free, (VALUE)&rows);
 }
 
-/*
- * Has CT::Record#lock been executed on this resource.
- */
+typedef struct {
+    ct_record *record;
+    ct_rows *rows;
+    long max;
+} ct_record_sum_args;
+
 static VALUE
-rb_ct_record_is_locked(VALUE self)
+ct_record_sum_walk(VALUE ptr)
 {
-    ct_record *record;
+    ct_record_sum_args *args = (ct_record_sum_args *)ptr;
+    ct_rows *rows = args->rows;
+    ct_record_walk walk;
+    ct_cell *cell;
+    CTDBTYPE type = rows->types[0];
+    NINT scale = rows->scales[0];
+    VALUE total = INT2FIX(0), units;
+    CTBIGINT value, acc = 0;
+    CTFLOAT facc = 0.0;
+    long r, count = 0;
+
+    switch ( type ) {
+        case CT_MONEY :
+            scale = CT_MONEY_SCALE;
+            break;
+        case CT_CURRENCY :
+            scale = CT_CURRENCY_SCALE;
+            break;
+        default :
+            break;
+    }
 
-    GetCTRecord(self, record);
-    
-    return ((ctdbGetRecordLock(record->handle) != CTLOCK_FREE) ? Qtrue : Qfalse);
+    ct_record_walk_init(&walk, args->record, rows);
+
+    while ( ct_record_walk_next(&walk, count, args->max) ) {
+        for ( r = 0; r < rows->rows; r++ ) {
+            cell = rows->cells + r;
+            if ( cell->null )
+                continue;
+
+            switch ( type ) {
+                case CT_BIGINT :
+                    value = cell->v.big;
+                    break;
+                case CT_UTINYINT :
+                case CT_USMALLINT :
+                case CT_UINTEGER :
+                    value = cell->v.u;
+                    break;
+                case CT_MONEY :
+                    value = cell->v.money;
+                    break;
+                case CT_CURRENCY :
+                    value = cell->v.currency;
+                    break;
+                case CT_NUMBER :
+                    value = 0;
+                    units = ct_numeric_number_to_units(&cell->v.number, scale);
+                    if ( rb_absint_numwords(units, 63, NULL) <= 1 )
+                        value = NUM2LL(units);
+                    else
+                        total = rb_funcall(total, '+', 1, units);
+                    break;
+                case CT_FLOAT :
+                case CT_EFLOAT :
+                case CT_DOUBLE :
+                    value = 0;
+                    facc += cell->v.f;
+                    break;
+                default :
+                    value = cell->v.s;
+                    break;
+            }
+
+            if ( ( value > 0 && acc > LLONG_MAX - value ) ||
+                 ( value < 0 && acc < LLONG_MIN - value ) ) {
+                total = rb_funcall(total, '+', 1, LL2NUM(acc));
+                acc = 0;
+            }
+            acc += value;
+        }
+        count += rows->rows;
+    }
+
+    switch ( type ) {
+        case CT_FLOAT :
+        case CT_EFLOAT :
+        case CT_DOUBLE :
+            return rb_float_new(facc);
+        case CT_MONEY :
+        case CT_CURRENCY :
+        case CT_NUMBER :
+            total = rb_funcall(total, '+', 1, LL2NUM(acc));
+            return ct_numeric_value(total, scale, args->record->numeric_mode);
+        default :
+            return rb_funcall(total, '+', 1, LL2NUM(acc));
+    }
 }
 
-/* 
- * Has CT::Record#lock(CT::LOCK_WRITE) been executed
+/*
+ * Add up a field from the current record onwards, straight from the record
+ * buffer.  Integer, NUMBER, MONEY and CURRENCY fields are summed exactly in
+ * 64 bits, carrying into an Integer on overflow, and the total is converted
+ * once according to #numeric_mode.  NULL fields are skipped.  The walk stops
+ * after +limit+ rows, like #pluck, and rows are read the same way.
+ *
+ * @param [String, Symbol] name The field name.
+ * @param [Fixnum, nil] limit The maximum number of rows to read.
+ * @return [Integer, Float, BigDecimal]
+ * @raise [TypeError] The field is not numeric.
+ * @raise [CT::Error] ctdbGetFieldByName or ctdbNextRecord failed.
  */
 static VALUE
-rb_ct_record_is_write_locked(VALUE self)
+rb_ct_record_sum(int argc, VALUE *argv, VALUE self)
 {
     ct_record *record;
+    ct_rows rows;
+    ct_record_sum_args args;
+    VALUE name, limit;
+    CTHANDLE field;
+    NINT number, scale;
+    CTDBTYPE type;
+
+    rb_scan_args(argc, argv, "11", &name, &limit);
+    if ( SYMBOL_P(name) ) name = rb_sym2str(name);
+    Check_Type(name, T_STRING);
 
     GetCTRecord(self, record);
-  
-    return ((ctdbGetRecordLock(record->handle) == CTLOCK_WRITE) ? Qtrue : Qfalse);
+
+    if ( ( field = ctdbGetFieldByName(record->table_ptr,
+            RSTRING_PTR(name)) ) == NULL )
+        rb_raise(cCTError, "[%d] ctdbGetFieldByName failed for `%s'",
+            ctdbGetError(record->handle), RSTRING_PTR(name));
+
+    number = ctdbGetFieldNbr(field);
+    type   = ctdbGetFieldType(field);
+
+    switch ( type ) {
+        case CT_TINYINT :
+        case CT_SMALLINT :
+        case CT_INTEGER :
+        case CT_BIGINT :
+        case CT_UTINYINT :
+        case CT_USMALLINT :
+        case CT_UINTEGER :
+        case CT_FLOAT :
+        case CT_EFLOAT :
+        case CT_DOUBLE :
+        case CT_MONEY :
+        case CT_CURRENCY :
+        case CT_NUMBER :
+            break;
+        default :
+            rb_raise(rb_eTypeError, "Cannot sum field `%s'", RSTRING_PTR(name));
+    }
+
+    ct_rows_init(&rows, record, 1, &number, &type, &scale);
+    args.record = record;
+    args.rows = &rows;
+    args.max = NIL_P(limit) ? -1 : NUM2LONG(limit);
+
+    return rb_ensure(ct_record_sum_walk, (VALUE)&args, 
+                     ct_rows_free, (VALUE)&rows);
 }
 
-/*  
- *  Has CT::Record#lock(CT::LOCK_READ) been executed
- */
-static VALUE
-rb_ct_record_is_read_locked(VALUE self)
+// A target key built for CT::Record#find_many.
+typedef struct {
+    pVOID key;
+    VRLEN length;
+    long position;
+} ct_record_target;
+
+static int
+ct_record_target_cmp(const void *a, const void *b)
 {
-    ct_record *record;
+    const ct_record_target *x = (const ct_record_target *)a;
+    const ct_record_target *y = (const ct_record_target *)b;
+    int c = memcmp(x->key, y->key, x->length < y->length ? x->length : y->length);
+
+    if ( c != 0 )
+        return c;
+    if ( x->length != y->length )
+        return x->length < y->length ? -1 : 1;
+    return x->position < y->position ? -1 : 1;
+}
 
-    GetCTRecord(self, record);
+// The sorted probe loop of CT::Record#find_many, run as one job.
+typedef struct {
+    CTHANDLE handle;
+    ct_record_target *targets;
+    long n;
+    long *found;        // Captured row per target, -1 where none matched
+    ct_rows *rows;
+    CTDBRET rc;
+} ct_record_probe;
 
-    return ((ctdbGetRecordLock(record->handle) == CTLOCK_READ) ? Qtrue : Qfalse);
+static void *
+ct_record_probe_run(void *ptr)
+{
+    ct_record_probe *probe = (ct_record_probe *)ptr;
+    ct_record_target *t = probe->targets;
+    long i;
+
+    probe->rc = CTDBRET_OK;
+    for ( i = 0; i < probe->n; i++ ) {
+        // Duplicate keys sort next to each other and share one lookup.
+        if ( i > 0 && t[i - 1].length == t[i].length &&
+                memcmp(t[i - 1].key, t[i].key, t[i].length) == 0 ) {
+            probe->found[i] = probe->found[i - 1];
+            continue;
+        }
+
+        probe->rc = ctdbFindTarget(probe->handle, t[i].key, CTFIND_EQ);
+        if ( probe->rc == INOT_ERR ) {
+            probe->found[i] = -1;
+            probe->rc = CTDBRET_OK;
+            continue;
+        }
+        if ( probe->rc != CTDBRET_OK )
+            break;
+
+        probe->found[i] = probe->rows->rows;
+        if ( !ct_rows_capture(probe->rows, probe->handle) )
+            break;
+    }
+
+    return NULL;
 }
 
-/* 
- * Get the next record on a table.
- *
- * @return [CT::Record, nil]
- */
-static VALUE
-rb_ct_record_next(VALUE self)
-{
+typedef struct {
     ct_record *record;
-    CTDBRET rc;
+    ct_record_probe *probe;
+    VALUE *names;
+    VALUE rows;
+} ct_record_find_many_args;
 
-    GetCTRecord(self, record);
+static VALUE
+ct_record_find_many_probe(VALUE ptr)
+{
+    ct_record_find_many_args *args = (ct_record_find_many_args *)ptr;
+    ct_record_probe *probe = args->probe;
+    ct_rows *rows = probe->rows;
+    VALUE row, value;
+    long i, j;
+
+    ct_async_call(ct_record_probe_run, probe);
+    ct_rows_check(rows);
+    if ( probe->rc != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbFindTarget failed.", probe->rc);
+
+    row = Qnil;
+    for ( i = 0; i < probe->n; i++ ) {
+        if ( probe->found[i] < 0 )
+            continue;
+        if ( i > 0 && probe->found[i] == probe->found[i - 1] ) {
+            rb_ary_store(args->rows, probe->targets[i].position, 
+                rb_hash_dup(row));
+            continue;
+        }
+
+        row = rb_hash_new();
+        for ( j = 0; j < rows->fields; j++ ) {
+            value = ct_rows_value(args->record, rows, probe->found[i], j);
+            if ( value == Qundef )
+                rb_raise(rb_eNotImpError, "Unhandled field type for field %d",
+                    rows->numbers[j]);
+            rb_hash_aset(row, args->names[j], value);
+        }
+        rb_ary_store(args->rows, probe->targets[i].position, row);
+    }
 
-    rc = ctdbNextRecord(record->handle);
-    if ( rc != CTDBRET_OK && rc != INOT_ERR )
-        rb_raise(cCTError, "[%d] ctdbNextRecord failed.", rc);
+    return args->rows;
+}
 
-    return rc == INOT_ERR ? Qnil : self;
+static int
+ct_record_set_target_field(VALUE name, VALUE value, VALUE self)
+{
+    if ( SYMBOL_P(name) ) name = rb_sym2str(name);
+    rb_funcall(self, rb_intern("set_field"), 2, name, value);
+    return ST_CONTINUE;
 }
 
-/* 
- * Retrieve the record index number in the table's active record list
+/*
+ * Look up many keys on one index in a single call.  Target keys are built
+ * up front and probed in index order, which keeps the server's index cache
+ * warm and skips the Ruby level clear/set_field/find sequence per key.  The
+ * whole probe loop runs as one call without the GVL, capturing the rows it
+ * finds, and they are converted to Hashes afterwards.  The record is left on
+ * the last key probed and +index+ becomes its default index.
  *
- * @return [Fixnum]
+ * @example
+ *   record.find_many([{ id: 3 }, { id: 1 }], index: 'id_ndx')
+ *   # => [{ "id" => 3, ... }, { "id" => 1, ... }]
+ *
+ * @param [Array<Hash, Object>] keys Index segment values per key.  A bare
+ *   value is taken as the value of the first index segment.
+ * @param [Hash] options
+ * @option options [String, Symbol, Fixnum] :index Index name or number,
+ *   defaults to the current default index.
+ * @return [Array<Hash, nil>] A Hash of field name => value per key, or nil
+ *   where no record matched, in the order the keys were given.
+ * @raise [CT::Error] ctdbBuildTargetKey or ctdbFindTarget failed.
  */
 static VALUE
-rb_ct_record_get_nbr(VALUE self)
+rb_ct_record_find_many(int argc, VALUE *argv, VALUE self)
 {
     ct_record *record;
-    NINT n;
+    ct_record_target *targets;
+    ct_record_probe probe;
+    ct_record_find_many_args args;
+    ct_rows rows;
+    VALUE keys, options, index, key, first_field, result;
+    VALUE *names, vtargets, vbuf, vfound;
+    CTHANDLE index_handle, field;
+    NINT index_number, *numbers, *scales;
+    CTDBTYPE *types;
+    VRLEN key_length;
+    pTEXT buf;
+    long i, j, n, field_count;
+
+    rb_scan_args(argc, argv, "11", &keys, &options);
+    Check_Type(keys, T_ARRAY);
 
     GetCTRecord(self, record);
 
-    if ( ( n = ctdbGetRecordNbr(record->handle) ) == -1 )
-        rb_raise(cCTError, "[%d] ctdbGetRecordNbr failed.", 
+    index = NIL_P(options) ? Qnil : 
+        rb_hash_aref(options, ID2SYM(rb_intern("index")));
+    if ( SYMBOL_P(index) ) index = rb_sym2str(index);
+
+    switch ( rb_type(index) ) {
+        case T_STRING :
+            index_handle = ctdbGetIndexByName(record->table_ptr, 
+                RSTRING_PTR(index));
+            break;
+        case T_FIXNUM :
+            index_handle = ctdbGetIndex(record->table_ptr, FIX2INT(index));
+            break;
+        case T_NIL :
+            index_handle = ctdbGetIndex(record->table_ptr, 
+                ctdbGetDefaultIndex(record->handle));
+            break;
+        default :
+            rb_raise(rb_eArgError, "Unexpected value type `%s'", 
+                rb_obj_classname(index));
+            break;
+    }
+    if ( index_handle == NULL )
+        rb_raise(cCTError, "[%d] ctdbGetIndex failed.", 
+            ctdbGetError(record->table_ptr));
+
+    index_number = ctdbGetIndexNbr(index_handle);
+    if ( ctdbSetDefaultIndex(record->handle, index_number) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbSetDefaultIndex failed.", 
             ctdbGetError(record->handle));
 
-    return INT2FIX(n);
+    n = RARRAY_LEN(keys);
+    result = rb_ary_new2(n);
+    for ( i = 0; i < n; i++ ) rb_ary_store(result, i, Qnil);
+    if ( n == 0 ) return result;
+
+    first_field = rb_str_new_cstr(ctdbGetFieldName(
+        ctdbGetSegmentField(ctdbGetSegment(index_handle, 0))));
+
+    // Room for the key plus the record offset appended to duplicate keys.
+    key_length = ctdbGetIndexKeyLength(index_handle) + 8;
+
+    targets = ALLOCV_N(ct_record_target, vtargets, n);
+    buf     = ALLOCV_N(TEXT, vbuf, n * key_length);
+
+    // Build every target key with the GVL held.
+    for ( i = 0; i < n; i++ ) {
+        key = rb_ary_entry(keys, i);
+
+        ctdbClearRecord(record->handle);
+        if ( RB_TYPE_P(key, T_HASH) )
+            rb_hash_foreach(key, ct_record_set_target_field, self);
+        else
+            ct_record_set_target_field(first_field, key, self);
+
+        targets[i].key = buf + i * key_length;
+        targets[i].length = key_length;
+        targets[i].position = i;
+        if ( ctdbBuildTargetKey(record->handle, CTFIND_EQ, targets[i].key,
+                &targets[i].length) != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbBuildTargetKey failed.", 
+                ctdbGetError(record->handle));
+    }
+
+    qsort(targets, n, sizeof(ct_record_target), ct_record_target_cmp);
+
+    // Resolve the fields decoded for each row once.
+    field_count = ctdbGetTableFieldCount(record->table_ptr);
+    names   = ALLOCA_N(VALUE, field_count);
+    numbers = ALLOCA_N(NINT, field_count);
+    types   = ALLOCA_N(CTDBTYPE, field_count);
+    scales  = ALLOCA_N(NINT, field_count);
+    for ( j = 0; j < field_count; j++ ) {
+        field = ctdbGetField(record->table_ptr, j);
+        names[j]   = rb_str_new_cstr(ctdbGetFieldName(field));
+        numbers[j] = ctdbGetFieldNbr(field);
+        types[j]   = ctdbGetFieldType(field);
+        rb_obj_freeze(names[j]);
+    }
+
+    ct_rows_init(&rows, record, field_count, numbers, types, scales);
+    probe.handle  = record->handle;
+    probe.targets = targets;
+    probe.n       = n;
+    probe.found   = ALLOCV_N(long, vfound, n);
+    probe.rows    = &rows;
+
+    args.record = record;
+    args.probe  = &probe;
+    args.names  = names;
+    args.rows   = result;
+    rb_ensure(ct_record_find_many_probe, (VALUE)&args, 
+              ct_rows_free, (VALUE)&rows);
+
+    ALLOCV_END(vfound);
+    ALLOCV_END(vbuf);
+    ALLOCV_END(vtargets);
+
+    return result;
 }
 
 /* 
@@ -851,7 +2211,7 @@ rb_ct_record_prev(VALUE self)
     
     GetCTRecord(self, record);
     
-    rc = ctdbPrevRecord(record->handle);
+    rc = ct_record_navigate(record, ct_record_nav_prev, 0);
     if ( rc != CTDBRET_OK && rc != INOT_ERR )
         rb_raise(cCTError, "[%d] ctdbPrevRecord failed.",
                  ctdbGetError(record->handle));
@@ -870,7 +2230,7 @@ rb_ct_record_read(VALUE self)
 
     GetCTRecord(self, record);
 
-    rc = ctdbReadRecord(record->handle);
+    rc = ct_record_navigate(record, ct_record_nav_read, 0);
     if ( rc != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbReadRecord failed.", 
                  ctdbGetError(record->handle));
@@ -954,9 +2314,15 @@ rb_ct_record_duplicate(VALUE self)
         rb_raise(cCTError, "[%d] ctdbDuplicateRecord failed.",
             ctdbGetError(record->handle));
    
-    obj = Data_Make_Struct(cCTRecord, ct_record, 0, free_rb_ct_record, record_copy);
+    obj = TypedData_Make_Struct(cCTRecord, ct_record, &ct_record_type, record_copy);
     record_copy->handle = handle;
-    record_copy->table_ptr = &(*record->table_ptr);
+    record_copy->table_ptr = record->table_ptr;
+    record_copy->generation = record->generation;
+    record_copy->table = record->table;
+    record_copy->temporal_mode = record->temporal_mode;
+    record_copy->numeric_mode = record->numeric_mode;
+    ct_table_retain(record->table);
+    RB_OBJ_WRITE(obj, &record_copy->rb_table, record->rb_table);
 
     return obj;
 }
@@ -994,13 +2360,19 @@ rb_ct_record_set_field(VALUE self, VALUE field_name, VALUE value)
         case CT_TINYINT :
         case CT_SMALLINT :
         case CT_INTEGER :
-        case CT_BIGINT :
             rb_funcall( self, 
                         rb_intern("set_field_as_signed"), 
                         2, 
                         field_name, 
                         value );
             break;
+        case CT_BIGINT :
+            rb_funcall( self, 
+                        rb_intern("set_field_as_bigint"), 
+                        2, 
+                        field_name, 
+                        value );
+            break;
         case CT_UTINYINT :
         case CT_USMALLINT :
         case CT_UINTEGER :
@@ -1015,8 +2387,6 @@ rb_ct_record_set_field(VALUE self, VALUE field_name, VALUE value)
         case CT_F2STRING :
         case CT_F4STRING :
         case CT_PSTRING :
-        case CT_VARBINARY :
-        case CT_LVB :
         case CT_VARCHAR :
             rb_funcall( self, 
                         rb_intern("set_field_as_string"), 
@@ -1024,6 +2394,15 @@ rb_ct_record_set_field(VALUE self, VALUE field_name, VALUE value)
                         field_name, 
                         value );
             break;
+        case CT_BINARY :
+        case CT_VARBINARY :
+        case CT_LVB :
+            rb_funcall( self, 
+                        rb_intern("set_field_as_binary"), 
+                        2, 
+                        field_name, 
+                        value );
+            break;
         case CT_DATE :
             rb_funcall( self, 
                         rb_intern("set_field_as_date"), 
@@ -1047,7 +2426,6 @@ rb_ct_record_set_field(VALUE self, VALUE field_name, VALUE value)
             break;
         case CT_FLOAT :
         case CT_EFLOAT :
-        case CT_MONEY :
         case CT_DOUBLE :
             rb_funcall( self, 
                         rb_intern("set_field_as_float"), 
@@ -1055,6 +2433,13 @@ rb_ct_record_set_field(VALUE self, VALUE field_name, VALUE value)
                         field_name, 
                         value );
             break;
+        case CT_MONEY :
+            rb_funcall( self, 
+                        rb_intern("set_field_as_money"), 
+                        2, 
+                        field_name, 
+                        value );
+            break;
         case CT_TIME :
             rb_funcall( self, 
                         rb_intern("set_field_as_time"), 
@@ -1079,9 +2464,37 @@ rb_ct_record_set_field(VALUE self, VALUE field_name, VALUE value)
 }
 
 /*
- *static VALUE
- *rb_ct_record_set_field_as_binary(VALUE self, VALUE num, VALUE value){}
+ * Set the field to the bytes of +value+, NUL bytes included.
+ *
+ * @param [Fixnum, String] id Field number or name.
+ * @param [String, nil] value
+ * @raise [CT::Error] ctdbSetFieldAsBinary failed.
  */
+static VALUE
+rb_ct_record_set_field_as_binary(VALUE self, VALUE id, VALUE value)
+{
+    ct_record *record;
+    NINT field_number;
+    CTDBRET rc;
+
+    GetCTRecord(self, record);
+
+    field_number = get_field_number(record, id);
+
+    if ( NIL_P(value) ) {
+        rc = ctdbClearField(record->handle, field_number);
+    } else {
+        StringValue(value);
+        rc = ctdbSetFieldAsBinary(record->handle, field_number,
+                RSTRING_PTR(value), (VRLEN)RSTRING_LEN(value));
+    }
+
+    if ( rc != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbSetFieldAsBinary failed for field %d.",
+            rc, field_number);
+
+    return self;
+}
 
 /*
  *static VALUE
@@ -1112,6 +2525,12 @@ rb_ct_record_set_field_as_bool(VALUE self, VALUE id, VALUE value)
     return self;
 }
 
+/*
+ * @param [Fixnum, String] id Field number or name.
+ * @param [Numeric] value Rounded to four decimal places.  Integers are
+ *   ten-thousandths in :scaled #numeric_mode.
+ * @raise [CT::Error] ctdbSetFieldAsCurrency failed.
+ */
 static VALUE
 rb_ct_record_set_field_as_currency(VALUE self, VALUE id, VALUE value)
 {
@@ -1120,21 +2539,23 @@ rb_ct_record_set_field_as_currency(VALUE self, VALUE id, VALUE value)
     CTDBRET rc;
     CTCURRENCY currency;
 
-    Check_Type(value, T_FLOAT);
-
     GetCTRecord(self, record);
 
-    rc = ctdbFloatToCurrency((CTFLOAT)(RFLOAT_VALUE(value)), &currency);
-    if ( rc != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbFloatToCurrency failed.", rc);
+    if ( RB_FLOAT_TYPE_P(value) ) {
+        rc = ctdbFloatToCurrency((CTFLOAT)(RFLOAT_VALUE(value)), &currency);
+        if ( rc != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbFloatToCurrency failed.", rc);
+    } else {
+        currency = (CTCURRENCY)NUM2LL(ct_numeric_units(value, 
+                        CT_CURRENCY_SCALE, record->numeric_mode));
+    }
 
     field_number = get_field_number(record, id);
 
-
     rc = ctdbSetFieldAsCurrency(record->handle, field_number, currency);
     if ( rc != CTDBRET_OK )  
-        rb_raise(cCTError, "[%d] ctdbSetFieldAsCurrency failed for `%s'.",
-                 rc, RSTRING_PTR(id));
+        rb_raise(cCTError, "[%d] ctdbSetFieldAsCurrency failed for field %d.",
+                 rc, field_number);
 
     return self;
 }
@@ -1155,6 +2576,12 @@ rb_ct_record_set_field_as_date(VALUE self, VALUE id, VALUE value)
         if ( ctdbSetFieldAsUnsigned(record->handle, field_number, 0) != CTDBRET_OK )
             rb_raise(cCTError, "[%d] ctdbSetFieldAsUnsigned failed for `%s'.",
                 ctdbGetError(record->handle), RSTRING_PTR(id));
+    } else if ( rb_obj_is_kind_of(value, rb_cInteger) ) {
+        // Seconds since 1970-01-01 UTC, as read in :epoch mode.
+        ctdate = ct_temporal_epoch_to_date(value);
+        if ( ctdbSetFieldAsDate(record->handle, field_number, ctdate) != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbSetFieldAsDate failed for `%s'.",
+                ctdbGetError(record->handle), RSTRING_PTR(id));
     } else {
         y = FIX2INT(RSEND(value, "year"));
         m = FIX2INT(RSEND(value, "mon"));
@@ -1179,15 +2606,33 @@ rb_ct_record_set_field_as_date_time(VALUE self, VALUE id, VALUE value)
 {
     ct_record *record;
     ct_date_time *datetime;
+    CTDATETIME dt;
     NINT field_number;
     CTDBRET rc;
 
     GetCTRecord(self, record);
-    GetCTDateTime(value, datetime);
+
+    if ( rb_typeddata_is_kind_of(value, &ct_date_time_type) ) {
+        GetCTDateTime(value, datetime);
+        dt = datetime->value;
+    } else if ( rb_obj_is_kind_of(value, rb_cInteger) ) {
+        // Seconds since 1970-01-01 UTC, as read in :epoch mode.
+        dt = ct_temporal_epoch_to_date_time(value);
+    } else {
+        // ::DateTime or ::Time, as read in :core mode.
+        rc = ctdbDateTimePack(&dt, NUM2INT(RSEND(value, "year")),
+                                   NUM2INT(RSEND(value, "mon")),
+                                   NUM2INT(RSEND(value, "day")),
+                                   NUM2INT(RSEND(value, "hour")),
+                                   NUM2INT(RSEND(value, "min")),
+                                   NUM2INT(RSEND(value, "sec")));
+        if ( rc != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbDateTimePack failed.", rc);
+    }
 
     field_number = get_field_number(record, id);
 
-    rc = ctdbSetFieldAsDateTime(record->handle, field_number, datetime->value); 
+    rc = ctdbSetFieldAsDateTime(record->handle, field_number, dt); 
     if ( rc != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbSetFieldAsDateTime failed for `%s'.", 
                  rc, RSTRING_PTR(id));
@@ -1216,28 +2661,91 @@ rb_ct_record_set_field_as_float(VALUE self, VALUE id, VALUE value)
 }
 
 /*
- *static VALUE
- *rb_ct_record_set_field_as_money(VALUE self, VALUE num, VALUE value){}
+ * @param [Fixnum, String] id Field number or name.
+ * @param [Numeric] value Rounded to two decimal places.  Integers are cents
+ *   in :scaled #numeric_mode.
+ * @raise [RangeError] value does not fit the 32 bit money field.
+ * @raise [CT::Error] ctdbSetFieldAsMoney failed.
  */
+static VALUE
+rb_ct_record_set_field_as_money(VALUE self, VALUE id, VALUE value)
+{
+    ct_record *record;
+    NINT field_number;
+    CTDBRET rc;
+    CTMONEY money;
+    LONG_LONG units;
+
+    GetCTRecord(self, record);
+
+    units = NUM2LL(ct_numeric_units(value, CT_MONEY_SCALE, 
+                                    record->numeric_mode));
+    money = (CTMONEY)units;
+    if ( money != units )
+        rb_raise(rb_eRangeError, "%lld cents out of range for a money field.",
+                 units);
 
+    field_number = get_field_number(record, id);
+
+    rc = ctdbSetFieldAsMoney(record->handle, field_number, money);
+    if ( rc != CTDBRET_OK )  
+        rb_raise(cCTError, "[%d] ctdbSetFieldAsMoney failed for field %d.",
+                 rc, field_number);
+
+    return self;
+}
+
+/*
+ * @param [Fixnum, String] id Field number or name.
+ * @param [Numeric] value Rounded to the scale of the field.  Integers are
+ *   units of 10**-scale in :scaled #numeric_mode.
+ * @raise [CT::Error] ctdbSetFieldAsNumber failed.
+ */
 static VALUE
 rb_ct_record_set_field_as_number(VALUE self, VALUE id, VALUE value)
 {
     ct_record *record;
-    NINT field_number;
-    VALUE s;
+    NINT field_number, scale;
+    CTNUMBER number;
     CTDBRET rc;
 
-    Check_Type(value, T_BIGNUM);
+    GetCTRecord(self, record);
+
+    field_number = get_field_number(record, id);
+    scale = ct_record_get_scale(record, field_number);
+
+    ct_numeric_units_to_number(ct_numeric_units(value, scale, 
+                               record->numeric_mode), scale, &number);
+
+    rc = ctdbSetFieldAsNumber(record->handle, field_number, &number);
+    if ( rc != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbSetFieldAsNumber failed for field %d.",
+                 rc, field_number);
+
+    return self;
+}
+
+/*
+ * @param [Fixnum, String] id Field number or name.
+ * @param [Integer] value
+ * @raise [CT::Error] ctdbSetFieldAsBigint failed.
+ */
+static VALUE
+rb_ct_record_set_field_as_bigint(VALUE self, VALUE id, VALUE value)
+{
+    ct_record *record;
+    NINT field_number;
+    CTDBRET rc;
 
     GetCTRecord(self, record);
 
     field_number = get_field_number(record, id);
-    s = rb_funcall(value, rb_intern("to_s"), 1, INT2FIX((int)2));
 
-    rc = ctdbSetFieldAsString(record->handle, field_number, RSTRING_PTR(s));
+    rc = ctdbSetFieldAsBigint(record->handle, field_number, 
+                              (CTBIGINT)NUM2LL(value));
     if ( rc != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbSetFieldAsString failed.", rc); 
+        rb_raise(cCTError, "[%d] ctdbSetFieldAsBigint failed for field %d.",
+                 rc, field_number);
 
     return self;
 }
@@ -1253,7 +2761,7 @@ rb_ct_record_set_field_as_signed(VALUE self, VALUE id, VALUE value)
     field_number = get_field_number(record, id);
 
     if ( ctdbSetFieldAsSigned(record->handle, field_number, 
-                                                FIX2INT(value)) != CTDBRET_OK )
+                                      (CTSIGNED)NUM2LONG(value)) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbSetFieldAsSigned failed for `%s'",
             ctdbGetError(record->handle), RSTRING_PTR(id));
 
@@ -1261,9 +2769,12 @@ rb_ct_record_set_field_as_signed(VALUE self, VALUE id, VALUE value)
 }
 
 /* 
+ * Fixed length fields are padded with the table pad character.  Values
+ * containing NUL bytes are set with ctdbSetFieldAsBinary.
+ *
  * @param [Fixnum, String] id Field number or name.
- * @param [String] value
- * @raise [CT::Error] ctdbSetFieldAsString failed.
+ * @param [String] value Not modified.
+ * @raise [CT::Error] ctdbSetFieldAsString or ctdbSetFieldAsBinary failed.
  */
 static VALUE
 rb_ct_record_set_field_as_string(VALUE self, VALUE id, VALUE value)
@@ -1271,8 +2782,12 @@ rb_ct_record_set_field_as_string(VALUE self, VALUE id, VALUE value)
     ct_record *record;
     NINT field_number;
     CTHANDLE f;
-    VRLEN len;
+    VRLEN size;
     CTDBRET rc;
+    VALUE tmp = 0;
+    char *ptr, *buf;
+    const char *call;
+    long len, n;
 
     Check_Type(value, T_STRING);
 
@@ -1281,27 +2796,42 @@ rb_ct_record_set_field_as_string(VALUE self, VALUE id, VALUE value)
     field_number = get_field_number(record, id);
 
     if ( !( f = ctdbGetField(record->table_ptr, field_number)) )
-        rb_raise(cCTError, "[%d] ctdbGetField failed for `%s'.",
-            ctdbGetError(record->handle), RSTRING_PTR(id));
-
-    if ( NIL_P(value) && ctdbGetFieldNullFlag(f) == NO )
-        rb_raise(cCTError, "`%s' cannot be NULL.", ctdbGetFieldName(f));
+        rb_raise(cCTError, "[%d] ctdbGetField failed for field %d.",
+            ctdbGetError(record->handle), field_number);
+
+    ptr = RSTRING_PTR(value);
+    len = n = RSTRING_LEN(value);
+    buf = ptr;
+
+    // Fixed length fields are padded with the table pad character.
+    if ( ctdbIsVariableField(record->handle, field_number) == NO &&
+         ( size = ctdbGetFieldLength(f) ) > 0 && len < (long)size - 1 )
+        n = (long)size - 1;
+
+    // Pad into a scratch copy, the caller's String is left untouched.  Small
+    // values stay on the stack.
+    if ( n != len || ptr[len] != '\0' ) {
+        buf = ALLOCV(tmp, n + 1);
+        memcpy(buf, ptr, len);
+        if ( n > len )
+            memset(buf + len, ct_table_pad_char(record->table), n - len);
+        buf[n] = '\0';
+    }
 
-    if ( ctdbIsVariableField(record->handle, field_number) == NO ) {
-        // Pad string to the fixed length.
-        len = ctdbGetFieldLength(f);
-        // TODO: Implement dynamic field padding with ctdbGetPadChar(*ct->table_ptr, &padc, &delimc);
-        while(RSTRING_LEN(value) < len-1)
-            rb_str_cat2(value, " ");
+    if ( memchr(ptr, '\0', len) != NULL ) {
+        call = "ctdbSetFieldAsBinary";
+        rc = ctdbSetFieldAsBinary(record->handle, field_number, buf, (VRLEN)n);
+    } else {
+        call = "ctdbSetFieldAsString";
+        rc = ctdbSetFieldAsString(record->handle, field_number, buf);
+    }
 
-    } 
-    
-    rc = ctdbSetFieldAsString(record->handle, field_number,
-                      (value == Qnil ? '\0' : StringValueCStr(value)));
+    if ( tmp )
+        ALLOCV_END(tmp);
     
     if ( rc != CTDBRET_OK )
-        rb_raise(cCTError, "[%d] ctdbSetFieldAsString failed for `%s'.",
-            ctdbGetError(record->handle), RSTRING_PTR(id));
+        rb_raise(cCTError, "[%d] %s failed for field %d.", rc, call,
+                 field_number);
 
     return self;
 }
@@ -1321,10 +2851,14 @@ rb_ct_record_set_field_as_time(VALUE self, VALUE id, VALUE value)
 
     field_number = get_field_number(record, id);
 
-    ctdbTimePack( &cttime,
-                  FIX2INT(RSEND(value, "hour")),
-                  FIX2INT(RSEND(value, "min")),
-                  FIX2INT(RSEND(value, "sec")) );
+    if ( rb_obj_is_kind_of(value, rb_cInteger) )
+        // Seconds since midnight, as read in :epoch mode.
+        cttime = ct_temporal_epoch_to_time(value);
+    else
+        ctdbTimePack( &cttime,
+                      FIX2INT(RSEND(value, "hour")),
+                      FIX2INT(RSEND(value, "min")),
+                      FIX2INT(RSEND(value, "sec")) );
 
     if ( ctdbSetFieldAsTime(record->handle, field_number, cttime) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbSetFieldAsTime failed for `%s'.",
@@ -1417,7 +2951,8 @@ rb_ct_record_unlock(VALUE self)
 
     GetCTRecord(self, record);
 
-    return ( (ctdbUnlockRecord(record->handle) == CTDBRET_OK) ? Qtrue : Qfalse );
+    return ct_async_handle_call(ctdbUnlockRecord, record->handle) == CTDBRET_OK ?
+        Qtrue : Qfalse;
 }
 
 static VALUE
@@ -1427,7 +2962,7 @@ rb_ct_record_unlock_bang(VALUE self)
 
     GetCTRecord(self, record);
 
-    if ( ctdbUnlockRecord(record->handle) != CTDBRET_OK )
+    if ( ct_async_handle_call(ctdbUnlockRecord, record->handle) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbUnlockRecord failed.",
             ctdbGetError(record->handle));
 
@@ -1440,7 +2975,8 @@ rb_ct_record_write(VALUE self)
     ct_record *record;
 
     GetCTRecord(self, record);
-    return ctdbWriteRecord(record->handle) == CTDBRET_OK ? Qtrue : Qfalse;
+    return ct_async_handle_call(ctdbWriteRecord, record->handle) == CTDBRET_OK ?
+        Qtrue : Qfalse;
 }
 /*
  * Create or update an existing record.
@@ -1454,7 +2990,7 @@ rb_ct_record_write_bang(VALUE self)
 
     GetCTRecord(self, record);
 
-    if ( ctdbWriteRecord(record->handle) != CTDBRET_OK )
+    if ( ct_async_handle_call(ctdbWriteRecord, record->handle) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbWriteRecord failed.",
             ctdbGetError(record->handle));
 
@@ -1482,13 +3018,20 @@ init_rb_ct_record()
     rb_define_method(cCTRecord, "filter=", rb_ct_record_set_filter, 1);
     rb_define_method(cCTRecord, "filtered?", rb_ct_record_is_filtered, 0);
     rb_define_method(cCTRecord, "find", rb_ct_record_find, 1);
+    rb_define_method(cCTRecord, "field_io", rb_ct_record_field_io, -1);
+    rb_define_method(cCTRecord, "field_offset", rb_ct_record_get_field_offset, 1);
+    rb_define_method(cCTRecord, "find_many", rb_ct_record_find_many, -1);
     rb_define_method(cCTRecord, "first", rb_ct_record_first, 0);
     rb_define_method(cCTRecord, "first!", rb_ct_record_first_bang, 0);
     rb_define_method(cCTRecord, "get_field", rb_ct_record_get_field, 1);
+    rb_define_method(cCTRecord, "get_field_as_bigint", rb_ct_record_get_field_as_bigint, 1);
+    rb_define_method(cCTRecord, "get_field_as_binary", rb_ct_record_get_field_as_binary, 1);
     rb_define_method(cCTRecord, "get_field_as_bool", rb_ct_record_get_field_as_bool, 1);
+    rb_define_method(cCTRecord, "get_field_as_currency", rb_ct_record_get_field_as_currency, 1);
     rb_define_method(cCTRecord, "get_field_as_date", rb_ct_record_get_field_as_date, 1);
     rb_define_method(cCTRecord, "get_field_as_date_time", rb_ct_record_get_field_as_date_time, 1);
     rb_define_method(cCTRecord, "get_field_as_float", rb_ct_record_get_field_as_float, 1);
+    rb_define_method(cCTRecord, "get_field_as_money", rb_ct_record_get_field_as_money, 1);
     rb_define_method(cCTRecord, "get_field_as_number", rb_ct_record_get_field_as_number, 1);
     rb_define_method(cCTRecord, "get_field_as_signed", rb_ct_record_get_field_as_signed, 1);
     rb_define_method(cCTRecord, "get_field_as_string", rb_ct_record_get_field_as_string, 1);
@@ -1503,23 +3046,32 @@ init_rb_ct_record()
     rb_define_method(cCTRecord, "write_locked?", rb_ct_record_is_write_locked, 0);
     rb_define_method(cCTRecord, "read_locked?", rb_ct_record_is_read_locked, 0);
     rb_define_method(cCTRecord, "next", rb_ct_record_next, 0);
+    rb_define_method(cCTRecord, "numeric_mode", rb_ct_record_get_numeric_mode, 0);
+    rb_define_method(cCTRecord, "numeric_mode=", rb_ct_record_set_numeric_mode, 1);
     rb_define_method(cCTRecord, "nbr", rb_ct_record_get_nbr, 0);
+    rb_define_method(cCTRecord, "pluck", rb_ct_record_pluck, -1);
     rb_define_method(cCTRecord, "position", rb_ct_record_position, 0);
     rb_define_method(cCTRecord, "prev", rb_ct_record_prev, 0);
     rb_define_method(cCTRecord, "read", rb_ct_record_read, 0);
     rb_define_method(cCTRecord, "seek", rb_ct_record_seek, 1);
     rb_define_method(cCTRecord, "set_field", rb_ct_record_set_field, 2);
+    rb_define_method(cCTRecord, "set_field_as_bigint", rb_ct_record_set_field_as_bigint, 2);
+    rb_define_method(cCTRecord, "set_field_as_binary", rb_ct_record_set_field_as_binary, 2);
     rb_define_method(cCTRecord, "set_field_as_bool", rb_ct_record_set_field_as_bool, 2);
     rb_define_method(cCTRecord, "set_field_as_currency", rb_ct_record_set_field_as_currency, 2);
     rb_define_method(cCTRecord, "set_field_as_date", rb_ct_record_set_field_as_date, 2);
     rb_define_method(cCTRecord, "set_field_as_date_time", rb_ct_record_set_field_as_date_time, 2);
     rb_define_method(cCTRecord, "set_field_as_float", rb_ct_record_set_field_as_float, 2);
+    rb_define_method(cCTRecord, "set_field_as_money", rb_ct_record_set_field_as_money, 2);
     rb_define_method(cCTRecord, "set_field_as_number", rb_ct_record_set_field_as_number, 2);
     rb_define_method(cCTRecord, "set_field_as_signed", rb_ct_record_set_field_as_signed, 2);
     rb_define_method(cCTRecord, "set_field_as_string", rb_ct_record_set_field_as_string, 2);
     rb_define_method(cCTRecord, "set_field_as_time", rb_ct_record_set_field_as_time, 2);
     rb_define_method(cCTRecord, "set_field_as_unsigned", rb_ct_record_set_field_as_unsigned, 2);
     rb_define_method(cCTRecord, "set?", rb_ct_record_is_set, 0);
+    rb_define_method(cCTRecord, "sum", rb_ct_record_sum, -1);
+    rb_define_method(cCTRecord, "temporal_mode", rb_ct_record_get_temporal_mode, 0);
+    rb_define_method(cCTRecord, "temporal_mode=", rb_ct_record_set_temporal_mode, 1);
     rb_define_method(cCTRecord, "set_on", rb_ct_record_set_on, 1);
     rb_define_method(cCTRecord, "set_off", rb_ct_record_set_off, 0);
     rb_define_method(cCTRecord, "unlock", rb_ct_record_unlock, 0);
@@ -1529,8 +3081,6 @@ init_rb_ct_record()
     
     rb_define_alias(cCTRecord, "[]", "get_field");
     rb_define_alias(cCTRecord, "[]=", "set_field");
-    rb_define_alias(cCTRecord, "get_field_as_money", "get_field_as_float");
-    rb_define_alias(cCTRecord, "get_field_as_currency", "get_field_as_float");
     rb_define_alias(cCTRecord, "number", "nbr");
     rb_define_alias(cCTRecord, "offset", "position");
 }
@@ -3,11 +3,23 @@
 
 void init_rb_ct_record();
 
+// Extensions generated by `ctdb generate_model` read handle, table_ptr and
+// generation straight from the wrapped struct, so they stay the first three
+// members.
 typedef struct {
     CTHANDLE handle;
-    pCTHANDLE table_ptr;
+    CTHANDLE table_ptr;  // The table's own handle, not a pointer to it
+    const unsigned long *generation; // The table's, bumped whenever its
+                                     // layout may have changed
+    ct_table *table;    // Native table, retained by the record
+    VALUE rb_table;     // CT::Table the record was allocated from
+    ct_temporal_mode temporal_mode;
+    ct_numeric_mode numeric_mode;
 } ct_record;
 
-#define GetCTRecord(obj, val) ( val = (ct_record*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_record_type;
+
+#define GetCTRecord(obj, val) \
+    TypedData_Get_Struct(obj, ct_record, &ct_record_type, val);
 
 #endif
@@ -7,21 +7,60 @@ extern VALUE mCT;
 extern VALUE cCTError;
 extern VALUE cCTField;
 
+static void
+mark_rb_ct_segment(void *ptr)
+{
+    ct_segment *segment = (ct_segment *)ptr;
+    CT_GC_MARK(segment->parent);
+    CT_GC_MARK(segment->field);
+}
+
 void
 free_rb_ct_segment(void *ptr)
 {
     ct_segment *segment = (ct_segment *)ptr;
+
+    if ( segment->table != NULL )
+        ct_table_release(segment->table);
     xfree(segment);
 }
 
+static size_t
+memsize_rb_ct_segment(const void *ptr)
+{
+    return sizeof(ct_segment);
+}
+
+static void
+compact_rb_ct_segment(void *ptr)
+{
+    ct_segment *segment = (ct_segment *)ptr;
+    CT_GC_UPDATE(segment->parent);
+    CT_GC_UPDATE(segment->field);
+}
+
+const rb_data_type_t ct_segment_type = {
+    "CT::Segment",
+    { mark_rb_ct_segment, free_rb_ct_segment, memsize_rb_ct_segment,
+      CT_DCOMPACT(compact_rb_ct_segment), },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
-rb_ct_segment_new(VALUE klass, CTHANDLE segment_handle)
+rb_ct_segment_new(VALUE klass, VALUE parent, ct_table *table,
+        CTHANDLE segment_handle)
 {
     ct_segment *segment;
     VALUE obj;
     
-    obj = Data_Make_Struct(klass, ct_segment, 0, free_rb_ct_segment, segment);
+    obj = TypedData_Make_Struct(klass, ct_segment, &ct_segment_type, segment);
     segment->handle = segment_handle;
+    segment->table = table;
+    segment->generation = table->generation;
+    ct_table_retain(table);
+    RB_OBJ_WRITE(obj, &segment->parent, parent);
+    segment->field = Qnil;
 
     rb_obj_call_init(obj, 0, NULL); // CT::Segment.initialize
 
@@ -42,6 +81,9 @@ rb_ct_segment_get_field(VALUE self)
     
     GetCTSegment(self, segment);
 
+    if ( !NIL_P(segment->field) )
+        return segment->field;
+
     mode = ctdbGetSegmentMode(segment->handle);
     if ( mode == CTSEG_REGSEG || mode == CTSEG_UREGSEG )
         field = ctdbGetSegmentPartialField(segment->handle);
@@ -52,7 +94,9 @@ rb_ct_segment_get_field(VALUE self)
         rb_raise(cCTError, "[%d] ctdbGetSegmentField failed.", 
             ctdbGetError(segment->handle));
 
-    return rb_ct_field_new(cCTField, field);
+    RB_OBJ_WRITE(self, &segment->field, 
+        rb_obj_freeze(rb_ct_field_new(cCTField, self, segment->table, field)));
+    return segment->field;
 }
 
 // TODO:
@@ -161,7 +205,7 @@ init_rb_ct_segment()
 {
     cCTSegment = rb_define_class_under(mCT, "Segment", rb_cObject);
 
-    rb_define_singleton_method(cCTSegment, "new", rb_ct_segment_new, 1);
+    rb_undef_method(CLASS_OF(cCTSegment), "new");
     rb_define_method(cCTSegment, "field_name", rb_ct_segment_get_field_name, 0);
     rb_define_method(cCTSegment, "field", rb_ct_segment_get_field, 0);
     rb_define_method(cCTSegment, "field=", rb_ct_segment_set_field, 1);
@@ -2,12 +2,22 @@
 #define RB_CT_SEGMENT_H
 
 void init_rb_ct_segment();
-VALUE rb_ct_segment_new(VALUE klass, CTHANDLE segment_handle);
+VALUE rb_ct_segment_new(VALUE klass, VALUE parent, ct_table *table,
+        CTHANDLE segment_handle);
 
 typedef struct {
     CTHANDLE handle;
+    ct_table *table;    // Native table owning the handle, retained
+    unsigned long generation; // table->generation when the handle was read
+    VALUE parent;       // Wrapper the segment was read from
+    VALUE field;        // Frozen CT::Field cache, nil until first read
 } ct_segment;
 
-#define GetCTSegment(obj, val) ( val = (ct_segment*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_segment_type;
+
+// Raises CT::Error once the table has invalidated the handle.
+#define GetCTSegment(obj, val) \
+    TypedData_Get_Struct(obj, ct_segment, &ct_segment_type, val); \
+    ct_table_check_generation((val)->table, (val)->generation);
 
 #endif
@@ -6,17 +6,51 @@ VALUE cCTSession;
 extern VALUE mCT;
 extern VALUE cCTError;
 
-static void 
-free_rb_ct_session(void *ptr) {
-    ct_session *session = (ct_session *)ptr;
+void
+ct_session_retain(ct_session *session)
+{
+    session->refs++;
+}
+
+/*
+ * Drop a reference to the native session.  The session is logged out and
+ * freed once the wrapper and every table allocated from it are gone, so
+ * ctdbFreeSession never runs under a live table handle.
+ */
+void
+ct_session_release(ct_session *session)
+{
+    if ( --session->refs > 0 )
+        return;
 
-    if ( ctdbIsActiveSession(session->handle) )
-        ctdbLogout(session->handle);
+    // Never log out a session the parent process still uses.
+    if ( session->handle != NULL && !CT_SESSION_INHERITED(session) ) {
+        if ( ctdbIsActiveSession(session->handle) )
+            ctdbLogout(session->handle);
 
-    ctdbFreeSession(session->handle);
+        ctdbFreeSession(session->handle);
+    }
     xfree(session);
 }
 
+static void 
+free_rb_ct_session(void *ptr) {
+    ct_session_release((ct_session *)ptr);
+}
+
+static size_t
+memsize_rb_ct_session(const void *ptr)
+{
+    return sizeof(ct_session);
+}
+
+const rb_data_type_t ct_session_type = {
+    "CT::Session",
+    { 0, free_rb_ct_session, memsize_rb_ct_session, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 static VALUE
 rb_ct_session_new(VALUE klass, VALUE mode)
 {
@@ -25,8 +59,10 @@ rb_ct_session_new(VALUE klass, VALUE mode)
 
     Check_Type(mode, T_FIXNUM);
     
-    obj = Data_Make_Struct(klass, ct_session, 0, free_rb_ct_session, session);
+    obj = TypedData_Make_Struct(klass, ct_session, &ct_session_type, session);
 
+    session->pid = getpid();
+    session->refs = 1;
     if ( ( session->handle = ctdbAllocSession(FIX2INT(mode)) ) == NULL )
         rb_raise(cCTError, "ctdbAllocSession failed.");
 
@@ -36,7 +72,79 @@ rb_ct_session_new(VALUE klass, VALUE mode)
 }
 
 /*
- * Retrieve the active state of a table.  A table is active if it is open.
+ * Start a new transaction.
+ *
+ * @raise [CT::Error] ctdbBegin failed.
+ */
+static VALUE
+rb_ct_session_begin_transaction(VALUE self)
+{
+    ct_session *session;
+
+    GetCTSession(self, session);
+
+    if ( ct_async_handle_call(ctdbBegin, session->handle) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbBegin failed.", 
+            ctdbGetError(session->handle));
+
+    return self;
+}
+
+/*
+ * Commit the active transaction.
+ *
+ * @raise [CT::Error] ctdbCommit failed.
+ */
+static VALUE
+rb_ct_session_commit_transaction(VALUE self)
+{
+    ct_session *session;
+
+    GetCTSession(self, session);
+
+    if ( ct_async_handle_call(ctdbCommit, session->handle) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbCommit failed.", 
+            ctdbGetError(session->handle));
+
+    return self;
+}
+
+/*
+ * Abort the active transaction, discarding every change made since the
+ * transaction began.
+ *
+ * @raise [CT::Error] ctdbAbort failed.
+ */
+static VALUE
+rb_ct_session_abort_transaction(VALUE self)
+{
+    ct_session *session;
+
+    GetCTSession(self, session);
+
+    if ( ct_async_handle_call(ctdbAbort, session->handle) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbAbort failed.", 
+            ctdbGetError(session->handle));
+
+    return self;
+}
+
+/*
+ * Check to see if a transaction is active.
+ */
+static VALUE
+rb_ct_session_is_transaction_active(VALUE self)
+{
+    ct_session *session;
+
+    GetCTSession(self, session);
+
+    return ctdbIsTransActive(session->handle) ? Qtrue : Qfalse;
+}
+
+/*
+ * Retrieve the active state of a session.  Sessions inherited from a parent
+ * process are never active.
  */
 static VALUE 
 rb_ct_session_is_active(VALUE self)
@@ -45,9 +153,27 @@ rb_ct_session_is_active(VALUE self)
 
     GetCTSession(self, session);
 
+    if ( CT_SESSION_INHERITED(session) )
+        return Qfalse;
+
     return ctdbIsActiveSession(session->handle) ? Qtrue : Qfalse;
 }
 
+/*
+ * Check to see if the session was created by a parent process before
+ * fork(2).  Inherited sessions share the parent's connection and can not be
+ * used by the child.
+ */
+static VALUE
+rb_ct_session_is_inherited(VALUE self)
+{
+    ct_session *session;
+
+    GetCTSession(self, session);
+
+    return CT_SESSION_INHERITED(session) ? Qtrue : Qfalse;
+}
+
 /*
  * Perform a session-wide lock.
  *
@@ -101,6 +227,23 @@ rb_ct_session_is_locked(VALUE self)
     return ctdbIsLockActive(session->handle) == YES ? Qtrue : Qfalse;
 }
 
+typedef struct {
+    CTHANDLE handle;
+    pTEXT engine;
+    pTEXT user;
+    pTEXT password;
+    CTDBRET rc;
+} ct_session_logon_args;
+
+static void *
+ct_session_logon(void *ptr)
+{
+    ct_session_logon_args *args = (ct_session_logon_args *)ptr;
+    args->rc = ctdbLogon(args->handle, args->engine, args->user, 
+                         args->password);
+    return NULL;
+}
+
 /*
  * Logon to c-tree Server or c-treeACE instance session.
  *
@@ -112,27 +255,39 @@ rb_ct_session_is_locked(VALUE self)
 static VALUE 
 rb_ct_session_logon(VALUE self, VALUE engine, VALUE user, VALUE password)
 {
-    pTEXT e, u, p;
+    ct_session_logon_args args;
     ct_session *session;
 
     Check_Type(engine, T_STRING);
     Check_Type(user, T_STRING);
-    Check_Type(user, T_STRING);
-    
+    Check_Type(password, T_STRING);
+
     GetCTSession(self, session);
 
-    e = RSTRING_PTR(engine);
-    u = RSTRING_PTR(user);
-    p = RSTRING_PTR(password);
+    // Copies, so the strings cannot change while the GVL is released.
+    engine   = rb_str_new_frozen(engine);
+    user     = rb_str_new_frozen(user);
+    password = rb_str_new_frozen(password);
+
+    args.handle   = session->handle;
+    args.engine   = StringValueCStr(engine);
+    args.user     = StringValueCStr(user);
+    args.password = StringValueCStr(password);
+    ct_async_call(ct_session_logon, &args);
 
-    if ( ctdbLogon(session->handle, e, u, p) != CTDBRET_OK)
+    RB_GC_GUARD(engine);
+    RB_GC_GUARD(user);
+    RB_GC_GUARD(password);
+
+    if ( args.rc != CTDBRET_OK)
         rb_raise(cCTError, "[%d] ctdbLogon failed.", 
             ctdbGetError(session->handle));
 
     return self;
 }
 
-/* Logout from a c-tree Server session or from a c-treeACE instance.
+/* Logout from a c-tree Server session or from a c-treeACE instance.  This is
+ * a no-op for sessions inherited from a parent process.
  */
 static VALUE 
 rb_ct_session_logout(VALUE self)
@@ -141,7 +296,10 @@ rb_ct_session_logout(VALUE self)
     
     GetCTSession(self, session);
 
-    if ( ctdbLogout(session->handle) != CTDBRET_OK )
+    if ( CT_SESSION_INHERITED(session) )
+        return self;
+
+    if ( ct_async_handle_call(ctdbLogout, session->handle) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbLogout failed.", 
             ctdbGetError(session->handle));
   
@@ -229,7 +387,8 @@ rb_ct_session_unlock(VALUE self)
     
     GetCTSession(self, session);
     
-    return ctdbUnlock(session->handle) == CTDBRET_OK ? Qtrue : Qfalse;
+    return ct_async_handle_call(ctdbUnlock, session->handle) == CTDBRET_OK ?
+        Qtrue : Qfalse;
 }
 
 /* 
@@ -244,7 +403,7 @@ rb_ct_session_unlock_bang(VALUE self)
     
     GetCTSession(self, session);
 
-    if ( ctdbUnlock(session->handle) != CTDBRET_OK )
+    if ( ct_async_handle_call(ctdbUnlock, session->handle) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbUnlock failed.", 
             ctdbGetError(session->handle));
 
@@ -300,10 +459,14 @@ void init_rb_ct_session()
     rb_define_singleton_method(cCTSession, "new", rb_ct_session_new, 1);
     
     rb_define_method(cCTSession, "active?", rb_ct_session_is_active, 0);
+    rb_define_method(cCTSession, "abort_transaction", rb_ct_session_abort_transaction, 0);
+    rb_define_method(cCTSession, "begin_transaction", rb_ct_session_begin_transaction, 0);
+    rb_define_method(cCTSession, "commit_transaction", rb_ct_session_commit_transaction, 0);
     /*
      *rb_define_method(cCTSession, "default_date_type", rb_ct_get_defualt_date_type, 0);
      *rb_define_method(cCTSession, "default_date_type=", rb_ct_set_defualt_date_type, 1);
      */
+    rb_define_method(cCTSession, "inherited?", rb_ct_session_is_inherited, 0);
     rb_define_method(cCTSession, "lock", rb_ct_session_lock, 1);
     rb_define_method(cCTSession, "lock!", rb_ct_session_lock_bang, 1);
     rb_define_method(cCTSession, "locked?", rb_ct_session_is_locked, 0);
@@ -316,4 +479,5 @@ void init_rb_ct_session()
     rb_define_method(cCTSession, "unlock!", rb_ct_session_unlock_bang, 0);
     rb_define_method(cCTSession, "username", rb_ct_session_get_username, 0);
     rb_define_method(cCTSession, "server_name", rb_ct_session_get_server_name, 0);
+    rb_define_method(cCTSession, "transaction_active?", rb_ct_session_is_transaction_active, 0);
 }
@@ -5,8 +5,19 @@ void init_rb_ct_session();
 
 typedef struct {
     CTHANDLE handle;
+    pid_t pid;      // Process that allocated the handle
+    int refs;       // The wrapper plus every table allocated from the session
 } ct_session;
 
-#define GetCTSession(obj, val) ( val = (ct_session*)DATA_PTR(obj) );
+void ct_session_retain(ct_session *session);
+void ct_session_release(ct_session *session);
+
+// A handle inherited across fork(2) shares the parent's connection.
+#define CT_SESSION_INHERITED(s) ( (s)->pid != getpid() )
+
+extern const rb_data_type_t ct_session_type;
+
+#define GetCTSession(obj, val) \
+    TypedData_Get_Struct(obj, ct_session, &ct_session_type, val);
 
 #endif
@@ -9,17 +9,125 @@ extern VALUE cCTIndex;
 extern VALUE cCTField;
 
 void
-free_rb_ct_table(void *ptr)
+ct_table_retain(ct_table *table)
 {
-    ct_table *table = (ct_table *)ptr;
+    table->refs++;
+}
 
-    if ( ctdbIsActiveTable(table->handle) )
-        ctdbCloseTable(table->handle);
+/*
+ * Drop a reference to the native table.  The table is closed and freed once
+ * the wrapper and every record and metadata object using it are gone, then
+ * the reference it holds on its session is dropped.
+ */
+void
+ct_table_release(ct_table *table)
+{
+    if ( --table->refs > 0 )
+        return;
+
+    // Never close a table the parent process still uses.
+    if ( table->handle != NULL && !CT_TABLE_INHERITED(table) ) {
+        if ( ctdbIsActiveTable(table->handle) )
+            ctdbCloseTable(table->handle);
 
-    ctdbFreeTable(table->handle);
+        ctdbFreeTable(table->handle);
+    }
+    if ( table->session != NULL )
+        ct_session_release(table->session);
     xfree(table);
 }
 
+/*
+ * Forget the cached metadata wrappers.  Called whenever fields, indexes or
+ * segments are added; the handles of wrappers already handed out stay
+ * valid.
+ */
+void
+ct_table_reset_cache(ct_table *table)
+{
+    table->fields = Qnil;
+    table->indexes = Qnil;
+    table->pad_char = -1;
+}
+
+/*
+ * Forget the cached metadata wrappers and mark every CT::Field, CT::Index
+ * and CT::Segment handed out so far as stale.  Called when c-tree may free
+ * their handles: on open, close, alter, rebuild and index deletion.
+ */
+void
+ct_table_invalidate(ct_table *table)
+{
+    table->generation++;
+    ct_table_reset_cache(table);
+}
+
+// Raise if a metadata wrapper was read before the table last invalidated it.
+void
+ct_table_check_generation(ct_table *table, unsigned long generation)
+{
+    if ( table->generation != generation )
+        rb_raise(cCTError, "[0] Stale metadata handle, read again from the "
+            "table after open, close, alter, rebuild or delete_index.");
+}
+
+/*
+ * The character fixed length string fields are padded with, read once per
+ * table definition.
+ */
+TEXT
+ct_table_pad_char(ct_table *table)
+{
+    TEXT pchar;
+
+    if ( table->pad_char < 0 ) {
+        if ( ctdbGetPadChar(table->handle, &pchar, NULL) != CTDBRET_OK )
+            rb_raise(cCTError, "[%d] ctdbGetPadChar failed.", 
+                ctdbGetError(table->handle));
+        table->pad_char = (unsigned char)pchar;
+    }
+
+    return (TEXT)table->pad_char;
+}
+
+static void
+mark_rb_ct_table(void *ptr)
+{
+    ct_table *table = (ct_table *)ptr;
+    CT_GC_MARK(table->rb_session);
+    CT_GC_MARK(table->fields);
+    CT_GC_MARK(table->indexes);
+}
+
+void
+free_rb_ct_table(void *ptr)
+{
+    ct_table_release((ct_table *)ptr);
+}
+
+static size_t
+memsize_rb_ct_table(const void *ptr)
+{
+    return sizeof(ct_table);
+}
+
+static void
+compact_rb_ct_table(void *ptr)
+{
+    ct_table *table = (ct_table *)ptr;
+    CT_GC_UPDATE(table->rb_session);
+    CT_GC_UPDATE(table->fields);
+    CT_GC_UPDATE(table->indexes);
+}
+
+const rb_data_type_t ct_table_type = {
+    "CT::Table",
+    { mark_rb_ct_table, free_rb_ct_table, memsize_rb_ct_table,
+      CT_DCOMPACT(compact_rb_ct_table), },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 /*
  * @param [CT::Session]
  */
@@ -34,7 +142,13 @@ rb_ct_table_new(VALUE klass, VALUE rb_session)
 
     GetCTSession(rb_session, session);
 
-    obj = Data_Make_Struct(klass, ct_table, 0, free_rb_ct_table, table);
+    obj = TypedData_Make_Struct(klass, ct_table, &ct_table_type, table);
+    table->pid = getpid();
+    table->refs = 1;
+    table->session = session;
+    ct_session_retain(session);
+    RB_OBJ_WRITE(obj, &table->rb_session, rb_session);
+    ct_table_reset_cache(table);
     if ( ( table->handle = ctdbAllocTable(session->handle) ) == NULL )
         rb_raise(cCTError, "[%d] ctdbAllocTable failed", 
             ctdbGetError(session->handle));
@@ -51,6 +165,68 @@ rb_ct_table_init(VALUE klass, VALUE rb_session)
     return klass;
 }
 
+/*
+ * The frozen CT::Field for every field in the table, built on first use and
+ * kept until the table definition changes.
+ */
+static VALUE
+ct_table_cached_fields(VALUE self, ct_table *table)
+{
+    int i, n;
+    CTHANDLE field;
+    VALUE fields;
+
+    if ( !NIL_P(table->fields) )
+        return table->fields;
+
+    if ( ( n = ctdbGetTableFieldCount(table->handle) ) == -1 )
+        rb_raise(cCTError, "[%d] ctdbGetTableFieldCount failed.", 
+            ctdbGetError(table->handle));
+
+    fields = rb_ary_new2(n);
+    for ( i = 0; i < n; i++ ) {
+        if ( ( field = ctdbGetField(table->handle, i) ) == NULL )
+            rb_raise(cCTError, "[%d] ctdbGetField failed.", 
+                ctdbGetError(table->handle));
+
+        rb_ary_push(fields, 
+                rb_obj_freeze(rb_ct_field_new(cCTField, self, table, field)));
+    }
+
+    RB_OBJ_WRITE(self, &table->fields, rb_obj_freeze(fields));
+    return fields;
+}
+
+/*
+ * The frozen CT::Index for every index in the table, built on first use and
+ * kept until the table definition changes.
+ */
+static VALUE
+ct_table_cached_indexes(VALUE self, ct_table *table)
+{
+    int j;
+    VRLEN count;
+    CTHANDLE index;
+    VALUE indexes;
+
+    if ( !NIL_P(table->indexes) )
+        return table->indexes;
+
+    count = ctdbGetTableIndexCount(table->handle);
+    indexes = rb_ary_new2(count);
+    for ( j = 0; j < count; j++ ) {
+        if ( ( index = ctdbGetIndex(table->handle, j) ) == NULL )
+            rb_raise(cCTError, "[%d] ctdbGetIndex failed.", 
+                ctdbGetError(table->handle));
+
+        rb_ary_push(indexes, 
+                rb_obj_freeze(rb_ct_index_new(cCTIndex, self, table, index)));
+    }
+
+    RB_OBJ_WRITE(self, &table->indexes, rb_obj_freeze(indexes));
+    return indexes;
+}
+
 /*
  * Add a new field to the table.
  *
@@ -85,7 +261,8 @@ rb_ct_table_add_field(VALUE self, VALUE name, VALUE type, VALUE length)
         rb_raise(cCTError, "[%d] ctdbAddField failed.", 
             ctdbGetError(table->handle));
 
-    return rb_ct_field_new(cCTField, field);
+    ct_table_reset_cache(table);
+    return rb_ct_field_new(cCTField, self, table, field);
 }
 
 /*
@@ -99,16 +276,29 @@ rb_ct_table_add_field(VALUE self, VALUE name, VALUE type, VALUE length)
  * @raise [CT::Error] ctdbAddIndex failed.
  */
 static VALUE
-rb_ct_table_add_index(VALUE self, VALUE name, VALUE type)/*, VALUE opts)*/
+rb_ct_table_add_index(int argc, VALUE *argv, VALUE self)
 {
     ct_table *table;
     CTHANDLE index;
+    VALUE name, type, opts, value;
     CTBOOL allow_dups_flag = NO;
     CTBOOL allow_null_flag = YES;
 
+    rb_scan_args(argc, argv, "21", &name, &type, &opts);
+
     Check_Type(name, T_STRING);
     GetCTTable(self, table);
 
+    if ( !NIL_P(opts) ) {
+        Check_Type(opts, T_HASH);
+        value = rb_hash_aref(opts, ID2SYM(rb_intern("allow_dups")));
+        if ( !NIL_P(value) )
+            allow_dups_flag = RTEST(value) ? YES : NO;
+        value = rb_hash_aref(opts, ID2SYM(rb_intern("allow_nil")));
+        if ( !NIL_P(value) )
+            allow_null_flag = RTEST(value) ? YES : NO;
+    }
+
     index = ctdbAddIndex(table->handle, RSTRING_PTR(name), 
                                         FIX2INT(type), 
                                         allow_dups_flag, 
@@ -118,7 +308,48 @@ rb_ct_table_add_index(VALUE self, VALUE name, VALUE type)/*, VALUE opts)*/
         rb_raise(cCTError, "[%d] ctdbAddIndex failed.", 
             ctdbGetError(table->handle));
 
-    return rb_ct_index_new(cCTIndex, index);
+    ct_table_reset_cache(table);
+    return rb_ct_index_new(cCTIndex, self, table, index);
+}
+
+/*
+ * Delete an index from the table definition.  Like #add_index, the change
+ * takes effect with #alter.
+ *
+ * @param [Fixnum, String] value Index name or number
+ * @raise [CT::Error] ctdbGetIndex or ctdbDelIndex failed.
+ */
+static VALUE
+rb_ct_table_delete_index(VALUE self, VALUE value)
+{
+    ct_table *table;
+    CTHANDLE index;
+
+    GetCTTable(self, table);
+
+    switch ( rb_type(value) ) {
+        case T_STRING :
+            index = ctdbGetIndexByName(table->handle, RSTRING_PTR(value));
+            break;
+        case T_FIXNUM :
+            index = ctdbGetIndex(table->handle, FIX2INT(value));
+            break;
+        default :
+            rb_raise(rb_eArgError, "Unexpected value type `%s'",
+                rb_obj_classname(value));
+            break;
+    }
+
+    if ( ! index )
+        rb_raise(cCTError, "[%d] ctdbGetIndex failed.", 
+            ctdbGetError(table->handle));
+
+    ct_table_invalidate(table);
+    if ( ctdbDelIndex(table->handle, ctdbGetIndexNbr(index)) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbDelIndex failed.", 
+            ctdbGetError(table->handle));
+
+    return self;
 }
 
 /*
@@ -152,36 +383,24 @@ rb_ct_table_get_index(VALUE self, VALUE value)
         rb_raise(cCTError, "[%d] ctdbGetIndex failed.", 
             ctdbGetError(table->handle));
 
-    return rb_ct_index_new(cCTIndex, index);
+    return rb_ary_entry(ct_table_cached_indexes(self, table), 
+            ctdbGetIndexNbr(index));
 }
 
 /*
- * Retstatic rieve a collection of all indecies associated with a table.
+ * Retrieve a collection of all indecies associated with a table.  The same
+ * frozen objects are returned until the table is altered.
+ *
  * @return [Array]
  */
 static VALUE
 rb_ct_table_get_indecies(VALUE self)
 {
     ct_table *table;
-    int j;          // Random ass counter
-    VRLEN count;    // Number of indecies associated with the table
-    VALUE indecies; // Ruby Array of CT::Index objects
-    CTHANDLE index; // Index handle
 
     GetCTTable(self, table);
     
-    indecies = rb_ary_new();
-    
-    count = ctdbGetTableIndexCount(table->handle);
-    for ( j = 0; j < count; j++ ) {
-        if ( ( index = ctdbGetIndex(table->handle, j) ) == NULL )
-            rb_raise(cCTError, "[%d] ctdbGetIndex failed.", 
-                ctdbGetError(table->handle));
-
-        rb_ary_push(indecies, rb_ct_index_new(cCTIndex, index));  
-    }
-
-    return indecies;
+    return ct_table_cached_indexes(self, table);
 }
 
 /*
@@ -199,6 +418,7 @@ rb_ct_table_alter(VALUE self, VALUE mode)
 
     GetCTTable(self, table);
 
+    ct_table_invalidate(table);
     if ( ctdbAlterTable(table->handle, FIX2INT(mode)) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbAlterTable failed.", 
             ctdbGetError(table->handle));
@@ -207,7 +427,8 @@ rb_ct_table_alter(VALUE self, VALUE mode)
 }
 
 /*
- * Close the table.
+ * Close the table.  This is a no-op for tables inherited from a parent
+ * process.
  *
  * @raise [CT::Error] ctdbCloseTable failed.
  */
@@ -218,6 +439,10 @@ rb_ct_table_close(VALUE self)
 
     GetCTTable(self, table);
 
+    if ( CT_TABLE_INHERITED(table) )
+        return self;
+
+    ct_table_invalidate(table);
     if ( ctdbCloseTable(table->handle) != CTDBRET_OK )
         rb_raise(cCTError, "[%d] ctdbCloseTable failed.", 
             ctdbGetError(table->handle));
@@ -324,7 +549,7 @@ rb_ct_table_get_delim_char(VALUE self)
         rb_raise(cCTError, "[%d] ctdbGetPadChar failed.", 
             ctdbGetError(table->handle));
 
-    return rb_str_new_cstr(&dchar);
+    return rb_str_new((char *)&dchar, 1);
 }
 
 /*
@@ -359,11 +584,13 @@ rb_ct_table_get_field(VALUE self, VALUE value)
         rb_raise(cCTError, "[%d] ctdbGetField failed.", 
             ctdbGetError(table->handle));
 
-    return rb_ct_field_new(cCTField, field);
+    return rb_ary_entry(ct_table_cached_fields(self, table), 
+            ctdbGetFieldNbr(field));
 }
 
 /*
- * Retrieve all fields in a table.
+ * Retrieve all fields in a table.  The same frozen objects are returned until
+ * the table is altered.
  *
  * @yield [field] Each field as a CT::Field object.
  * @return [Array] Collection of CT::Field objects.
@@ -372,31 +599,17 @@ rb_ct_table_get_field(VALUE self, VALUE value)
 static VALUE
 rb_ct_table_get_fields(VALUE self)
 {
-    int i, n;
+    long i;
     ct_table *table;
-    CTHANDLE field;
-    VALUE fields, rb_field;
+    VALUE fields;
 
     GetCTTable(self, table);
 
-    if ( ( n = ctdbGetTableFieldCount(table->handle) ) == -1 )
-        rb_raise(cCTError, "[%d] ctdbGetTableFieldCount failed.", 
-            ctdbGetError(table->handle));
-
-    fields = rb_ary_new2(n);
-
-    for(i = 0; i < n; i++){
-        // Get the field handle.
-        if ( ( field = ctdbGetField(table->handle, i) ) == NULL )
-            rb_raise(cCTError, "[%d] ctdbGetField failed.", 
-                ctdbGetError(table->handle));
+    fields = ct_table_cached_fields(self, table);
 
-        rb_field = rb_ct_field_new(cCTField, field);
-        
-        if(rb_block_given_p()) rb_yield(rb_field);
-        
-        rb_ary_store(fields, i, rb_field);
-    }
+    if ( rb_block_given_p() )
+        for ( i = 0; i < RARRAY_LEN(fields); i++ )
+            rb_yield(RARRAY_AREF(fields, i));
 
     return fields;
 }
@@ -422,7 +635,8 @@ rb_ct_table_get_field_by_name(VALUE self, VALUE name)
         rb_raise(cCTError, "[%d] ctdbGetFieldByName failed.", 
             ctdbGetError(table->handle));
  
-    return rb_ct_field_new(cCTField, field);
+    return rb_ary_entry(ct_table_cached_fields(self, table), 
+            ctdbGetFieldNbr(field));
 }
 
 /*
@@ -528,23 +742,48 @@ rb_ct_table_get_name(VALUE self)
     return RSTRING_LEN(name) == 0 ? Qnil : name;
 }
 
+typedef struct {
+    CTHANDLE handle;
+    pTEXT name;
+    CTOPEN_MODE mode;
+    CTDBRET rc;
+} ct_table_open_args;
+
+static void *
+ct_table_open(void *ptr)
+{
+    ct_table_open_args *args = (ct_table_open_args *)ptr;
+    args->rc = ctdbOpenTable(args->handle, args->name, args->mode);
+    return NULL;
+}
+
 /*
  * Open the table.
  *
  * @param [String] name Name of the table to open
+ * @param [Fixnum] mode Open mode, e.g. CT::OPEN_NORMAL or CT::OPEN_EXCLUSIVE
  * @raise [CT::Error] ctdbOpenTable failed.
  */
 static VALUE
 rb_ct_table_open(VALUE self, VALUE name, VALUE mode)
 {
     ct_table *table;
+    ct_table_open_args args;
 
     Check_Type(name, T_STRING);
+    Check_Type(mode, T_FIXNUM);
 
     GetCTTable(self, table);
 
-    if ( ctdbOpenTable(table->handle, RSTRING_PTR(name), 
-                                                CTOPEN_NORMAL) !=  CTDBRET_OK )
+    ct_table_invalidate(table);
+    name = rb_str_new_frozen(name);
+    args.handle = table->handle;
+    args.name = StringValueCStr(name);
+    args.mode = FIX2INT(mode);
+    ct_async_call(ct_table_open, &args);
+    RB_GC_GUARD(name);
+
+    if ( args.rc != CTDBRET_OK )
         rb_raise(cCTError, "[%d][%d] ctdbOpenTable failed.", 
                 ctdbGetError(table->handle), sysiocod);
 
@@ -553,6 +792,7 @@ rb_ct_table_open(VALUE self, VALUE name, VALUE mode)
 
 /*
  * Retrieve the active state of a table.  A table is active if it is open.
+ * Tables inherited from a parent process are never active.
  */
 static VALUE
 rb_ct_table_is_active(VALUE self)
@@ -561,6 +801,9 @@ rb_ct_table_is_active(VALUE self)
     
     GetCTTable(self, table);
 
+    if ( CT_TABLE_INHERITED(table) )
+        return Qfalse;
+
     return ctdbIsActiveTable(table->handle) == YES ? Qtrue : Qfalse;
 }
 
@@ -582,7 +825,7 @@ rb_ct_table_get_pad_char(VALUE self)
         rb_raise(cCTError, "[%d] ctdbGetPadChar failed.", 
             ctdbGetError(table->handle));
 
-    return rb_str_new_cstr(&pchar);
+    return rb_str_new((char *)&pchar, 1);
 }
 
 /* TODO:
@@ -657,13 +900,26 @@ rb_ct_table_set_permission(VALUE self, VALUE pmask)
 }
 
 /*
- * TODO:
+ * Rebuild the table's data and index files.  The table must be open
+ * exclusively.
  *
- * @param [Fixnum] mode The rebuild mode.
+ * @param [Fixnum] mode The rebuild mode, one of CT::DB_REBUILD_*.
+ * @raise [CT::Error] ctdbRebuildTable failed.
  */
 static VALUE
 rb_ct_table_rebuild(VALUE self, VALUE mode)
 {
+    ct_table *table;
+
+    Check_Type(mode, T_FIXNUM);
+
+    GetCTTable(self, table);
+
+    ct_table_invalidate(table);
+    if ( ctdbRebuildTable(table->handle, FIX2INT(mode)) != CTDBRET_OK )
+        rb_raise(cCTError, "[%d] ctdbRebuildTable failed.", 
+            ctdbGetError(table->handle));
+
     return self;
 }
 
@@ -690,7 +946,8 @@ init_rb_ct_table(void)
     rb_define_singleton_method(cCTTable, "new", rb_ct_table_new, 1);
     rb_define_method(cCTTable, "initialize", rb_ct_table_init, 1);
     rb_define_method(cCTTable, "add_field", rb_ct_table_add_field, 3);
-    rb_define_method(cCTTable, "add_index", rb_ct_table_add_index, 2);
+    rb_define_method(cCTTable, "add_index", rb_ct_table_add_index, -1);
+    rb_define_method(cCTTable, "delete_index", rb_ct_table_delete_index, 1);
     rb_define_method(cCTTable, "get_index", rb_ct_table_get_index, 1);
     rb_define_method(cCTTable, "indecies", rb_ct_table_get_indecies, 0); 
     rb_define_method(cCTTable, "alter", rb_ct_table_alter, 1);
@@ -5,8 +5,30 @@ void init_rb_ct_table();
 
 typedef struct {
     CTHANDLE handle;  
+    pid_t pid;              // Process that allocated the handle
+    int refs;               // The wrapper plus every record, field, index
+                            // and segment wrapper allocated from the table
+    ct_session *session;    // Native session, retained by the table
+    VALUE rb_session;       // CT::Session the table was allocated from
+    VALUE fields;           // Frozen CT::Field cache, nil until first read
+    VALUE indexes;          // Frozen CT::Index cache, nil until first read
+    int pad_char;           // Fixed length field padding, -1 until first read
+    unsigned long generation; // Bumped whenever metadata handles may be freed
 } ct_table;
 
-#define GetCTTable(obj, val) ( val = (ct_table*)DATA_PTR(obj));
+void ct_table_retain(ct_table *table);
+void ct_table_release(ct_table *table);
+void ct_table_reset_cache(ct_table *table);
+void ct_table_invalidate(ct_table *table);
+void ct_table_check_generation(ct_table *table, unsigned long generation);
+TEXT ct_table_pad_char(ct_table *table);
+
+// A handle inherited across fork(2) shares the parent's connection.
+#define CT_TABLE_INHERITED(t) ( (t)->pid != getpid() )
+
+extern const rb_data_type_t ct_table_type;
+
+#define GetCTTable(obj, val) \
+    TypedData_Get_Struct(obj, ct_table, &ct_table_type, val);
 
 #endif
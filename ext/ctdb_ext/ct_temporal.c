@@ -0,0 +1,161 @@
+#include <ctdb_ext.h>
+#include <time.h>
+#include <math.h>
+
+#define CT_UNIX_EPOCH_JD 2440588    // Julian day number of 1970-01-01
+#define CT_SECONDS_PER_DAY 86400L
+
+static VALUE cDate = Qnil;
+static VALUE cDateTime = Qnil;
+static ID id_jd;
+static ID id_ct, id_core, id_epoch;
+
+// c-tree packed values of 1970-01-01, read once from the c-tree API so the
+// arithmetic matches ctdbDateUnpack and friends.
+static CTDATE date_epoch;
+static CTTIME time_midnight;
+static CTTIME time_second;
+static CTDATETIME date_time_epoch;
+static double date_time_day;
+
+ct_temporal_mode
+ct_temporal_mode_from_sym(VALUE sym)
+{
+    ID id;
+
+    Check_Type(sym, T_SYMBOL);
+    id = SYM2ID(sym);
+
+    if ( id == id_ct )
+        return CT_TEMPORAL_CT;
+    if ( id == id_core )
+        return CT_TEMPORAL_CORE;
+    if ( id == id_epoch )
+        return CT_TEMPORAL_EPOCH;
+
+    rb_raise(rb_eArgError, "Unknown temporal mode `%s'", rb_id2name(id));
+    return CT_TEMPORAL_CT;
+}
+
+VALUE
+ct_temporal_mode_to_sym(ct_temporal_mode mode)
+{
+    switch ( mode ) {
+        case CT_TEMPORAL_CORE :
+            return ID2SYM(id_core);
+        case CT_TEMPORAL_EPOCH :
+            return ID2SYM(id_epoch);
+        default :
+            return ID2SYM(id_ct);
+    }
+}
+
+VALUE
+ct_temporal_date(CTDATE date, ct_temporal_mode mode)
+{
+    long days = (long)date - (long)date_epoch;
+
+    if ( mode == CT_TEMPORAL_EPOCH )
+        return LONG2NUM(days * CT_SECONDS_PER_DAY);
+
+    return rb_funcall(cDate, id_jd, 1, LONG2NUM(days + CT_UNIX_EPOCH_JD));
+}
+
+VALUE
+ct_temporal_time(CTTIME time, ct_temporal_mode mode)
+{
+    long secs = ( (long)time - (long)time_midnight ) / (long)time_second;
+    struct tm tm;
+
+    if ( mode == CT_TEMPORAL_EPOCH )
+        return LONG2NUM(secs);
+
+    // Same as ::Time.new(1970, 1, 1, h, m, s) in local time.
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year  = 70;
+    tm.tm_mday  = 1;
+    tm.tm_hour  = (int)( secs / 3600 );
+    tm.tm_min   = (int)( secs / 60 % 60 );
+    tm.tm_sec   = (int)( secs % 60 );
+    tm.tm_isdst = -1;
+
+    return rb_time_new(mktime(&tm), 0);
+}
+
+VALUE
+ct_temporal_date_time(CTDATETIME datetime, ct_temporal_mode mode)
+{
+    LONG_LONG secs, days, rem;
+
+    secs = (LONG_LONG)floor( ( datetime - date_time_epoch ) / date_time_day * 
+                             CT_SECONDS_PER_DAY + 0.5 );
+
+    if ( mode == CT_TEMPORAL_EPOCH )
+        return LL2NUM(secs);
+
+    days = secs / CT_SECONDS_PER_DAY;
+    rem  = secs % CT_SECONDS_PER_DAY;
+    if ( rem < 0 ) {
+        days -= 1;
+        rem += CT_SECONDS_PER_DAY;
+    }
+
+    return rb_funcall(cDateTime, id_jd, 4, LL2NUM(days + CT_UNIX_EPOCH_JD),
+                      INT2FIX(rem / 3600), INT2FIX(rem / 60 % 60), 
+                      INT2FIX(rem % 60));
+}
+
+CTDATE
+ct_temporal_epoch_to_date(VALUE secs)
+{
+    LONG_LONG s = NUM2LL(secs);
+    LONG_LONG days = s / CT_SECONDS_PER_DAY;
+
+    if ( s % CT_SECONDS_PER_DAY < 0 )
+        days -= 1;
+
+    return (CTDATE)( (LONG_LONG)date_epoch + days );
+}
+
+CTTIME
+ct_temporal_epoch_to_time(VALUE secs)
+{
+    return time_midnight + (CTTIME)NUM2LONG(secs) * time_second;
+}
+
+CTDATETIME
+ct_temporal_epoch_to_date_time(VALUE secs)
+{
+    return date_time_epoch + 
+        (CTDATETIME)NUM2LL(secs) / CT_SECONDS_PER_DAY * date_time_day;
+}
+
+void
+init_rb_ct_temporal()
+{
+    CTDATETIME next_day;
+
+    id_jd    = rb_intern("jd");
+    id_ct    = rb_intern("ct");
+    id_core  = rb_intern("core");
+    id_epoch = rb_intern("epoch");
+
+    // Only the main Ractor may require, so load date now.
+    rb_require("date");
+    cDate = rb_const_get(rb_cObject, rb_intern("Date"));
+    cDateTime = rb_const_get(rb_cObject, rb_intern("DateTime"));
+    rb_global_variable(&cDate);
+    rb_global_variable(&cDateTime);
+
+    ctdbDatePack(&date_epoch, 1970, 1, 1);
+    ctdbTimePack(&time_midnight, 0, 0, 0);
+    ctdbTimePack(&time_second, 0, 0, 1);
+    time_second -= time_midnight;
+    if ( time_second == 0 )
+        time_second = 1;
+    ctdbDateTimePack(&date_time_epoch, 1970, 1, 1, 0, 0, 0);
+    ctdbDateTimePack(&next_day, 1970, 1, 2, 0, 0, 0);
+    date_time_day = next_day - date_time_epoch;
+    if ( date_time_day <= 0 )
+        date_time_day = 1.0;
+}
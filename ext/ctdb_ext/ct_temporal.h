@@ -0,0 +1,31 @@
+#ifndef RB_CT_TEMPORAL_H
+#define RB_CT_TEMPORAL_H
+
+// How DATE, TIME and TIMESTAMP fields are returned by a CT::Record.
+typedef enum {
+    CT_TEMPORAL_CT = 0, // CT::Date, CT::Time and CT::DateTime wrappers
+    CT_TEMPORAL_CORE,   // ::Date, ::Time and ::DateTime
+    CT_TEMPORAL_EPOCH   // Integer seconds, since 1970-01-01 UTC for dates
+                        // and timestamps, since midnight for times
+} ct_temporal_mode;
+
+void init_rb_ct_temporal();
+
+ct_temporal_mode ct_temporal_mode_from_sym(VALUE sym);
+VALUE ct_temporal_mode_to_sym(ct_temporal_mode mode);
+
+/*
+ * Convert c-tree temporal values arithmetically, without unpacking them into
+ * their components first.  Only CT_TEMPORAL_CORE and CT_TEMPORAL_EPOCH are
+ * handled here.
+ */
+VALUE ct_temporal_date(CTDATE date, ct_temporal_mode mode);
+VALUE ct_temporal_time(CTTIME time, ct_temporal_mode mode);
+VALUE ct_temporal_date_time(CTDATETIME datetime, ct_temporal_mode mode);
+
+// The reverse of CT_TEMPORAL_EPOCH.
+CTDATE ct_temporal_epoch_to_date(VALUE secs);
+CTTIME ct_temporal_epoch_to_time(VALUE secs);
+CTDATETIME ct_temporal_epoch_to_date_time(VALUE secs);
+
+#endif
@@ -13,13 +13,26 @@ free_rb_ct_time(void *ptr)
     xfree(time);
 }
 
+static size_t
+memsize_rb_ct_time(const void *ptr)
+{
+    return sizeof(ct_time);
+}
+
+const rb_data_type_t ct_time_type = {
+    "CT::Time",
+    { 0, free_rb_ct_time, memsize_rb_ct_time, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED
+};
+
 VALUE
 ct_time_init_with(pCTTIME tm)
 {
     ct_time *time;
     VALUE obj;
 
-    obj = Data_Make_Struct(cCTTime, ct_time, 0, free_rb_ct_time, time);
+    obj = TypedData_Make_Struct(cCTTime, ct_time, &ct_time_type, time);
     time->value = (CTTIME)*tm;
     time->type = CTTIME_HHMS;
     
@@ -32,7 +45,7 @@ ct_time_init_with2(pCTTIME tm, CTTIME_TYPE type)
     ct_time *time;
     VALUE obj;
 
-    obj = Data_Make_Struct(cCTTime, ct_time, 0, free_rb_ct_time, time);
+    obj = TypedData_Make_Struct(cCTTime, ct_time, &ct_time_type, time);
     time->value = (CTTIME)*tm;
     time->type  = type;
     
@@ -146,17 +159,11 @@ rb_ct_time_to_string(VALUE self)
 static VALUE
 rb_ct_time_to_time(VALUE self)
 {
-    VALUE parts;
+    ct_time *time;
 
-    parts = RSEND(self, "unpack");
+    GetCTTime(self, time);
 
-    return rb_funcall( RUBY_CLASS("Time"), rb_intern("new"), 6,
-                       INT2FIX(1970),
-                       INT2FIX(1),
-                       INT2FIX(1),
-                       rb_ary_entry(parts, 0),
-                       rb_ary_entry(parts, 1),
-                       rb_ary_entry(parts, 2) );
+    return ct_temporal_time(time->value, CT_TEMPORAL_CORE);
 }
 
 /*
@@ -6,7 +6,10 @@ typedef struct {
     CTTIME_TYPE type;
 } ct_time;
 
-#define GetCTTime(obj, val) ( val = (ct_time*)DATA_PTR(obj) );
+extern const rb_data_type_t ct_time_type;
+
+#define GetCTTime(obj, val) \
+    TypedData_Get_Struct(obj, ct_time, &ct_time_type, val);
 
 void init_rb_ct_time();
 void free_rb_ct_time(void *ptr);
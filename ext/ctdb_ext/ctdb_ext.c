@@ -6,6 +6,12 @@ VALUE cCTError;
 void 
 Init_ctdb_ext(void) 
 {
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+    // Handles are created and used within a single Ractor, classes and
+    // constants are set once at load time.
+    rb_ext_ractor_safe(true);
+#endif
+
     mCT      = rb_define_module("CT");
     cCTError = rb_define_class_under(mCT, "Error", rb_eStandardError);
    
@@ -18,6 +24,8 @@ Init_ctdb_ext(void)
     rb_define_const(mCT, "FIND_LE", INT2NUM(CTFIND_LE));
     rb_define_const(mCT, "FIND_GT", INT2NUM(CTFIND_GT));
     rb_define_const(mCT, "FIND_GE", INT2NUM(CTFIND_GE));
+    // c-tree error codes, see CT::Error#errno
+    rb_define_const(mCT, "INOT_ERR", INT2NUM(INOT_ERR)); // Key not found
     // c-treeDB Lock Modes
     rb_define_const(mCT, "LOCK_FREE",       INT2NUM(CTLOCK_FREE));
     rb_define_const(mCT, "LOCK_READ",       INT2NUM(CTLOCK_READ));
@@ -72,7 +80,8 @@ Init_ctdb_ext(void)
     rb_define_const(mCT, "INDEX_ERROR",   INT2NUM(CTINDEX_ERROR));
     // c-treeDB Segment modes
     rb_define_const(mCT, "SEG_SCHSEG",     INT2NUM(CTSEG_SCHSEG));
-    rb_define_const(mCT, "SET_USCHSEG",    INT2NUM(CTSEG_USCHSEG));
+    rb_define_const(mCT, "SEG_USCHSEG",    INT2NUM(CTSEG_USCHSEG));
+    rb_define_const(mCT, "SET_USCHSEG",    INT2NUM(CTSEG_USCHSEG)); // Misspelt, kept for old code
     rb_define_const(mCT, "SEG_VSCHSEG",    INT2NUM(CTSEG_VSCHSEG));
     rb_define_const(mCT, "SEG_UVSCHSEG",   INT2NUM(CTSEG_UVSCHSEG));
     rb_define_const(mCT, "SEG_SCHSRL",     INT2NUM(CTSEG_SCHSRL));
@@ -151,7 +160,11 @@ Init_ctdb_ext(void)
     init_rb_ct_index();
     init_rb_ct_segment();
     init_rb_ct_record();
+    init_rb_ct_field_io();
     init_rb_ct_date();
     init_rb_ct_time();
     init_rb_ct_date_time();
+    init_rb_ct_temporal();
+    init_rb_ct_numeric();
+    init_rb_ct_async();
 }
@@ -5,17 +5,41 @@
 #ifdef HAVE_RUBY_ENCODING_H
 #include <ruby/encoding.h>
 #endif
+#ifdef HAVE_RUBY_THREAD_H
+#include <ruby/thread.h>
+#endif
+#ifdef HAVE_RUBY_FIBER_SCHEDULER_H
+#include <ruby/fiber/scheduler.h>
+#endif
 #include <ctdbsdk.h>
+#include <sys/types.h>
+#include <unistd.h>
 
 #include <ct_date.h>
 #include <ct_time.h>
 #include <ct_date_time.h>
+#include <ct_temporal.h>
+#include <ct_numeric.h>
 #include <ct_session.h>
 #include <ct_table.h>
 #include <ct_field.h>
 #include <ct_index.h>
 #include <ct_segment.h>
 #include <ct_record.h>
+#include <ct_field_io.h>
+#include <ct_async.h>
+
+// Wrappers mark the VALUEs of their owners.  Rubies with compaction let the
+// owners move and the dcompact callback picks up the new address.
+#ifdef HAVE_RB_GC_MARK_MOVABLE
+#define CT_GC_MARK(v) rb_gc_mark_movable(v)
+#define CT_GC_UPDATE(v) ( (v) = rb_gc_location(v) )
+#define CT_DCOMPACT(func) func
+#else
+#define CT_GC_MARK(v) rb_gc_mark(v)
+#define CT_GC_UPDATE(v) ( (void)(v) )
+#define CT_DCOMPACT(func) 0
+#endif
 
 #define RUBY_CLASS(name) rb_const_get(rb_cObject, rb_intern(name))
 #define RSEND(obj, meth) rb_funcall(obj, rb_intern(meth), 0)
@@ -6,11 +6,27 @@ end
 
 errors = []
 errors << "'ctdbsdk.h'" unless find_header('ctdbsdk.h')
-errors << "'ctclient'"  unless find_library('ctclient', 'ctdbAllocSession')
+# The multithreaded client lets c-tree calls run without the GVL.
+if find_library('mtclient', 'ctdbAllocSession')
+  $defs.push("-DHAVE_CT_MTCLIENT")
+elsif !find_library('ctclient', 'ctdbAllocSession')
+  errors << "'mtclient' or 'ctclient'"
+end
 
 unless errors.empty?
   puts "Error: missing dependencies: #{errors.join(',')}"
   exit
 end
 
+have_func('rb_ext_ractor_safe', 'ruby.h')
+have_func('rb_ractor_make_shareable', 'ruby/ractor.h')
+have_func('rb_gc_mark_movable', 'ruby.h')
+have_header('ruby/thread.h')
+have_func('rb_thread_call_without_gvl', 'ruby/thread.h')
+have_header('ruby/fiber/scheduler.h')
+have_func('rb_fiber_scheduler_current', 'ruby/fiber/scheduler.h')
+have_func('rb_wait_for_single_fd', 'ruby/io.h')
+have_header('pthread.h')
+have_header('sys/eventfd.h')
+
 create_makefile("ctdb_ext")
@@ -9,6 +9,8 @@ module CT
   class RecordNotUnique < StandardError; end
   class UnknownAttribute < StandardError; end
   class InvalidQuery < StandardError; end
+  class CheckoutTimeout < StandardError; end
+  class SchemaMismatch < StandardError; end
 end
 
 require 'ctdb/version'
@@ -21,12 +23,19 @@ require 'ctdb/date'
 require 'ctdb/time'
 require 'ctdb/date_time'
 require 'ctdb/error'
+require 'ctdb/ractor_local'
 require 'ctdb/session'
 require 'ctdb/table'
 require 'ctdb/field'
 require 'ctdb/index'
 require 'ctdb/segment'
+require 'ctdb/schema'
 require 'ctdb/record'
 require 'ctdb/session_handler'
+require 'ctdb/session_pool'
+require 'ctdb/release_session'
 require 'ctdb/query'
+require 'ctdb/identity_map'
 require 'ctdb/model'
+require 'ctdb/write_buffer'
+require 'ctdb/fork_safety'
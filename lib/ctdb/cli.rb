@@ -1,5 +1,11 @@
 require 'thor'
 require 'yaml'
+require 'ctdb/cli/progress'
+require 'ctdb/cli/model_generator'
+require 'ctdb/cli/exporter'
+require 'ctdb/cli/importer'
+require 'ctdb/cli/bench'
+require 'ctdb/cli/stats'
 
 module CT
   class CLI < Thor
@@ -72,17 +78,28 @@ module CT
       schema_file.puts "name: #{table.name}"
       schema_file.puts "path: '#{table.path}'"
 
+      # Offsets are only fixed up to the first variable length field.
+      record = CT::Record.new(table).clear
+      static = true
+
       schema_file.puts "fields:"
       table.fields.each do |field|
         schema_file.puts "  - name: #{field.name}"
+        schema_file.puts "    number: #{field.number}"
         schema_file.puts "    type: '#{field.human_type.sub(/_/, '::')}'"
         schema_file.puts "    length: #{field.length}"
+        schema_file.puts "    scale: #{field.scale}"
+        schema_file.puts "    precision: #{field.precision}"
+        schema_file.puts "    allow_nil: #{field.allow_nil?}"
+        schema_file.puts "    offset: #{record.field_offset(field.number)}" if static
+        static &&= !field.variable_length?
       end
 
       schema_file.puts "indexes:"
       table.indecies.each do |index|
         schema_file.puts "  - name: #{index.name}"
         schema_file.puts "    allow_dups: '#{index.allow_dups?}'"
+        schema_file.puts "    key_length: #{index.key_length}"
         schema_file.puts "    segments:"
         index.segments.each do |segment|
           length = segment.field.length
@@ -90,15 +107,172 @@ module CT
 
           schema_file.puts "      - field_name: #{segment.field_name}"
           schema_file.puts "        length: #{segment.field.length}"
-          schema_file.puts "        mode: #{segment.human_mode}"
+          mode = segment.human_mode
+          schema_file.puts "        mode: #{mode.start_with?('CTSEG_') ? mode : segment.mode}"
         end
       end
 
       table.close
     ensure
+      schema_file.close if schema_file
       logout
     end
 
+    method_option :force, :type => :boolean, :default => false
+
+    desc "generate_model SCHEMA_FILE [OUT_DIR]",
+         "Generate a C extension with fixed layout accessors for a dumped schema"
+    def generate_model(schema_path, out_dir = ".")
+      generator = ModelGenerator.new(schema_path)
+      extension = File.join(out_dir, generator.extension_name)
+
+      if File.exist?(extension) && !options['force']
+        request_file_overwrite_permission(extension)
+      end
+
+      generator.write(out_dir).each { |file| puts "  create  #{file}" }
+      puts
+      puts "Build with `ruby extconf.rb && make` in #{extension} and require"
+      puts "'#{generator.extension_name}' to define CT::Layout::#{generator.module_name}."
+    end
+
+    desc "compile_schema OUTPUT SCHEMA_FILE...",
+         "Compile dumped schemas into a snapshot CT::Model loads at boot"
+    def compile_schema(output, *schema_paths)
+      raise Thor::Error, "No schema files given." if schema_paths.empty?
+
+      schemas = schema_paths.flat_map { |path| CT::Schema.load(path) }
+      CT::Schema.compile(schemas, output)
+      schemas.each { |schema| puts "  schema  #{schema.table_name}" }
+      puts "Wrote #{schemas.size} schema(s) to #{output}"
+    rescue ArgumentError, KeyError => e
+      raise Thor::Error, e.message
+    end
+
+    method_option :server,     :type => :string,  :default => "FAIRCOMS"
+    method_option :username,   :type => :string,  :default => ""
+    method_option :password,   :type => :string,  :default => ""
+    method_option :format,     :type => :string,  :default => "csv",
+                               :enum => Exporter::FORMATS
+    method_option :fields,     :type => :array
+    method_option :index,      :type => :string
+    method_option :from,       :type => :string,
+                               :desc => "First key, comma separated segment values"
+    method_option :to,         :type => :string,
+                               :desc => "Last key, comma separated segment values"
+    method_option :output,     :type => :string,  :aliases => "-o"
+    method_option :batch_size, :type => :numeric, :default => 1000
+    method_option :parallel,   :type => :numeric, :default => 1
+    method_option :progress,   :type => :boolean, :default => true
+
+    desc "export TABLE", "Stream a table to csv, jsonl or msgpack"
+    def export(table_path)
+      exporter = Exporter.new(
+        format:     options['format'],
+        fields:     options['fields'],
+        index:      options['index'],
+        from:       options['from'] && options['from'].split(','),
+        to:         options['to'] && options['to'].split(','),
+        batch_size: options['batch_size'].to_i,
+        parallel:   options['parallel'].to_i,
+        progress:   options['progress'] ? $stderr : nil
+      )
+
+      output(options['output']) do |io|
+        exporter.run(io) { |&block| with_table(table_path, &block) }
+      end
+    rescue ArgumentError => e
+      raise Thor::Error, e.message
+    end
+
+    method_option :server,        :type => :string,  :default => "FAIRCOMS"
+    method_option :username,      :type => :string,  :default => ""
+    method_option :password,      :type => :string,  :default => ""
+    method_option :format,        :type => :string,  :enum => Importer::FORMATS
+    method_option :commit_every,  :type => :numeric, :default => 1000
+    method_option :defer_indexes, :type => :boolean, :default => false,
+                                  :desc => "Drop trailing indexes that allow duplicates for the load and build them after"
+    method_option :rebuild,       :type => :boolean, :default => false,
+                                  :desc => "Rebuild the indexes after the load"
+    method_option :checkpoint,    :type => :string
+    method_option :reject,        :type => :string
+    method_option :progress,      :type => :boolean, :default => true
+
+    desc "import TABLE FILE", "Load a csv or jsonl file into a table"
+    def import(table_path, file_path)
+      importer = Importer.new(file_path,
+        format:        options['format'],
+        commit_every:  options['commit_every'].to_i,
+        defer_indexes: options['defer_indexes'],
+        rebuild:       options['rebuild'],
+        checkpoint:    options['checkpoint'],
+        reject:        options['reject'],
+        progress:      options['progress'] ? $stderr : nil
+      )
+
+      exclusive = options['defer_indexes'] || options['rebuild']
+      mode = exclusive ? CT::OPEN_EXCLUSIVE : CT::OPEN_NORMAL
+
+      with_table(table_path, mode) do |table, session|
+        importer.run(session, table)
+      end
+      puts "%d rows inserted, %d rejected" % [ importer.inserted, importer.rejected ]
+    rescue ArgumentError => e
+      raise Thor::Error, e.message
+    end
+
+    method_option :server,     :type => :string,  :default => "FAIRCOMS"
+    method_option :username,   :type => :string,  :default => ""
+    method_option :password,   :type => :string,  :default => ""
+    method_option :workload,   :type => :string,  :default => "point",
+                               :enum => Bench::WORKLOADS
+    method_option :threads,    :type => :numeric, :default => 1
+    method_option :duration,   :type => :string,  :default => "60s"
+    method_option :index,      :type => :string
+    method_option :sample,     :type => :numeric, :default => 10_000,
+                               :desc => "Index keys to sample"
+    method_option :range_size, :type => :numeric, :default => 100
+    method_option :mix,        :type => :hash,
+                               :desc => "Weights for the mixed workload, e.g. point:70 range:20"
+    method_option :json,       :type => :boolean, :default => false
+
+    desc "bench TABLE", "Run a workload against a table and report latency percentiles"
+    def bench(table_path)
+      mix = options['mix'] &&
+            Hash[options['mix'].collect { |op, weight| [ op, Integer(weight, 10) ] }]
+
+      bench = Bench.new(
+        workload:   options['workload'],
+        threads:    options['threads'].to_i,
+        duration:   Bench.parse_duration(options['duration']),
+        index:      options['index'],
+        sample:     options['sample'].to_i,
+        range_size: options['range_size'].to_i,
+        mix:        mix,
+        progress:   $stderr
+      )
+
+      report = bench.run { |&block| with_table(table_path, CT::OPEN_NORMAL, &block) }
+      puts options['json'] ? JSON.pretty_generate(report.to_h) : report.to_s
+    rescue ArgumentError => e
+      raise Thor::Error, e.message
+    end
+
+    method_option :server,   :type => :string,  :default => "FAIRCOMS"
+    method_option :username, :type => :string,  :default => ""
+    method_option :password, :type => :string,  :default => ""
+    method_option :sample,   :type => :numeric, :desc => "Rows to read, all by default"
+    method_option :json,     :type => :boolean, :default => false
+
+    desc "stats TABLE", "Profile record lengths, key cardinality, nulls and common values"
+    def stats(table_path)
+      stats = Stats.new(sample: options['sample'] && options['sample'].to_i,
+                        progress: $stderr)
+
+      report = with_table(table_path) { |table| stats.run(table) }
+      puts options['json'] ? JSON.pretty_generate(report) : Stats.format(report)
+    end
+
     private
 
       def logon(server, username, password)
@@ -110,6 +284,28 @@ module CT
         @session.logout
       end
 
+      # Open a table, read only by default, on a session of its own.
+      def with_table(table_path, mode = CT::OPEN_READONLY)
+        session = CT::Session.new(CT::SESSION_CTREE)
+        session.logon(options['server'], options['username'], options['password'])
+
+        table      = CT::Table.new(session)
+        table.path = File.dirname(table_path)
+        table.open(File.basename(table_path), mode)
+
+        yield table, session
+      ensure
+        table.close if table && table.open?
+        session.logout if session
+      end
+
+      def output(file_path)
+        return yield($stdout) if file_path.nil? || file_path == '-'
+
+        request_file_overwrite_permission(file_path) if File.exist?(file_path)
+        File.open(file_path, 'wb') { |io| yield io }
+      end
+
       def request_file_overwrite_permission(file_path)
         puts "A file already exists at #{file_path}."
         permission =  ask "Are you sure you want to overwrite it? y/n"
@@ -0,0 +1,437 @@
+require 'thor'
+require 'ctdb/cli/progress'
+require 'json'
+
+module CT
+  class CLI < Thor
+    # Drives a workload against a real table from +threads+ sessions for a
+    # fixed time and reports throughput and latency percentiles per
+    # operation.  Keys come from a random sample of the index being
+    # exercised, so lookups hit the table's actual key distribution.
+    #
+    # Workloads:
+    # point::  find(CT::FIND_EQ) on a sampled key
+    # range::  find(CT::FIND_GE) on a sampled key, then read +range_size+ rows
+    # update:: find a sampled key and write the row back unchanged
+    # insert:: write a copy of a sampled row under a new key, above the
+    #          largest Integer leading segment.  The rows are deleted again
+    #          when the run ends.
+    # mixed::  all of the above, weighted by +mix+
+    #
+    # @example
+    #   bench = CT::CLI::Bench.new(workload: 'mixed', threads: 8, duration: 60)
+    #   report = bench.run { |&block| with_table(path, CT::OPEN_NORMAL, &block) }
+    #   puts report.to_s
+    class Bench
+
+      WORKLOADS  = %w[ point range update insert mixed ].freeze
+      OPERATIONS = %w[ point range update insert ].freeze
+
+      DEFAULT_MIX = { 'point' => 70, 'range' => 20, 'update' => 5, 'insert' => 5 }.freeze
+
+      # Latency histogram with buckets 2% wide, so percentiles are within 2%
+      # of the recorded value whatever the spread.
+      class Histogram
+
+        GROWTH = Math.log(1.02)
+        MIN    = 1e-7   # 100ns, everything below lands in the first bucket
+
+        # @!attribute [r] count
+        #   @return [Fixnum]
+        attr_reader :count
+        # @!attribute [r] max
+        #   @return [Float] Seconds
+        attr_reader :max
+
+        def initialize
+          @buckets = Hash.new(0)
+          @count   = 0
+          @sum     = 0.0
+          @max     = 0.0
+        end
+
+        # @param [Float] seconds
+        def record(seconds)
+          @buckets[bucket(seconds)] += 1
+          @count += 1
+          @sum   += seconds
+          @max    = seconds if seconds > @max
+        end
+
+        # @param [CT::CLI::Bench::Histogram] other
+        # @return [CT::CLI::Bench::Histogram] self
+        def merge!(other)
+          other.buckets.each { |b, n| @buckets[b] += n }
+          @count += other.count
+          @sum   += other.sum
+          @max    = other.max if other.max > @max
+          self
+        end
+
+        # @return [Float] Seconds
+        def mean
+          @count.zero? ? 0.0 : @sum / @count
+        end
+
+        # @param [Float] p Percentile, 0 to 100
+        # @return [Float] Seconds
+        def percentile(p)
+          return 0.0 if @count.zero?
+
+          rank = ( p / 100.0 * @count ).ceil.clamp(1, @count)
+          seen = 0
+          @buckets.keys.sort.each do |b|
+            seen += @buckets[b]
+            return [ value(b), @max ].min if seen >= rank
+          end
+          @max
+        end
+
+        protected
+
+          attr_reader :buckets, :sum
+
+        private
+
+          def bucket(seconds)
+            seconds <= MIN ? 0 : ( Math.log(seconds / MIN) / GROWTH ).ceil
+          end
+
+          # Upper bound of a bucket.
+          def value(b)
+            MIN * Math.exp(b * GROWTH)
+          end
+
+      end
+
+      # Results of a run.
+      class Report
+
+        PERCENTILES = [ 50, 90, 99, 99.9 ].freeze
+
+        # @param [String] workload
+        # @param [Fixnum] threads
+        # @param [Float] elapsed Seconds
+        # @param [Hash] histograms Operation => Histogram
+        # @param [Hash] errors Operation => count
+        # @param [Boolean] serialized The threads ran one c-tree call at a
+        #   time, see CT::THREADED
+        def initialize(workload, threads, elapsed, histograms, errors, serialized=false)
+          @workload   = workload
+          @threads    = threads
+          @elapsed    = elapsed
+          @histograms = histograms
+          @errors     = errors
+          @serialized = serialized && threads > 1
+        end
+
+        # @return [Hash]
+        def to_h
+          operations = @histograms.each_with_object({}) do |(op, h), ops|
+            ops[op] = {
+              count:      h.count,
+              errors:     @errors[op],
+              throughput: h.count / @elapsed,
+              latency_ms: {
+                mean: h.mean * 1000,
+                max:  h.max * 1000
+              }.merge(Hash[PERCENTILES.collect { |p| [ "p#{label(p)}", h.percentile(p) * 1000 ] }])
+            }
+          end
+
+          total = @histograms.values.sum(&:count)
+          { workload: @workload, threads: @threads, serialized: @serialized,
+            elapsed: @elapsed, throughput: total / @elapsed,
+            operations: operations }
+        end
+
+        def to_json(*args)
+          to_h.to_json(*args)
+        end
+
+        # @return [String] A table of the results, latencies in ms.
+        def to_s
+          h = to_h
+          lines = []
+          lines << "%s workload, %d thread(s), %.1fs, %.0f ops/s" %
+              [ @workload, @threads, @elapsed, h[:throughput] ]
+          if @serialized
+            lines << "Threads were serialized: this build holds the GVL for " +
+                     "every c-tree call, so throughput cannot scale and " +
+                     "latencies include waiting for other threads."
+          end
+          lines << ""
+          lines << "%-8s %10s %8s %10s %9s %9s %9s %9s %9s" %
+              ([ "op", "count", "errors", "ops/s" ] +
+               PERCENTILES.collect { |p| "p#{label(p)}" } + [ "max" ])
+          h[:operations].each do |op, r|
+            lat = r[:latency_ms]
+            lines << "%-8s %10d %8d %10.0f %9.3f %9.3f %9.3f %9.3f %9.3f" %
+                ([ op, r[:count], r[:errors], r[:throughput] ] +
+                 PERCENTILES.collect { |p| lat["p#{label(p)}"] } + [ lat[:max] ])
+          end
+          lines.join("\n")
+        end
+
+        private
+
+          # 99.9 => "999", 50 => "50"
+          def label(p)
+            p.to_s.sub(/\.0\z/, '').delete('.')
+          end
+
+      end
+
+      # @param [Hash] opts
+      # @option opts [String] :workload One of WORKLOADS
+      # @option opts [Fixnum] :threads (1) Sessions driving the workload
+      # @option opts [Numeric] :duration (60) Seconds
+      # @option opts [String] :index Index to draw keys from, the first by
+      #   default
+      # @option opts [Fixnum] :sample (10000) Keys to sample
+      # @option opts [Fixnum] :range_size (100) Rows read per range operation
+      # @option opts [Hash] :mix Operation => weight for the mixed workload
+      # @option opts [IO] :progress Where progress is reported, if anywhere
+      def initialize(opts={})
+        @workload   = opts[:workload].to_s
+        @threads    = opts[:threads] || 1
+        @duration   = opts[:duration] || 60
+        @index      = opts[:index]
+        @sample     = opts[:sample] || 10_000
+        @range_size = opts[:range_size] || 100
+        @mix        = opts[:mix] || DEFAULT_MIX
+        @progress   = Progress.new(opts[:progress])
+
+        unless WORKLOADS.include?(@workload)
+          raise ArgumentError, "Unknown workload `#{@workload}', expected " +
+                               "one of #{WORKLOADS.join(', ')}."
+        end
+        unknown = @mix.keys - OPERATIONS
+        unless unknown.empty?
+          raise ArgumentError, "Unknown operation(s) in mix: #{unknown.join(', ')}."
+        end
+      end
+
+      # Parse "60", "60s", "500ms", "2m" or "1h" into seconds.
+      #
+      # @param [String] value
+      # @return [Float]
+      def self.parse_duration(value)
+        unless value.to_s =~ /\A(\d+(?:\.\d+)?)(ms|s|m|h)?\z/
+          raise ArgumentError, "Invalid duration `#{value}'."
+        end
+        $1.to_f * { 'ms' => 0.001, 's' => 1, 'm' => 60, 'h' => 3600 }.fetch($2 || 's')
+      end
+
+      # Run the workload.  +connect+ is called once to sample keys and once
+      # per thread, and must yield an open CT::Table on its own session.
+      #
+      # @yield [&block] Open the table and yield it to +block+.
+      # @return [CT::CLI::Bench::Report]
+      def run(&connect)
+        operations = @workload == 'mixed' ? @mix.select { |_, w| w > 0 }.keys : [ @workload ]
+        @schedule  = schedule(operations)
+
+        connect.call { |table| prepare(table, operations) }
+
+        @inserted = Queue.new
+        @next_key = @max_key
+        @keys     = Mutex.new
+
+        results = []
+        started = Progress.clock
+        stop_at = started + @duration
+
+        threads = []
+        begin
+          @threads.times do |i|
+            threads << Thread.new do
+              connect.call { |table| results << drive(table, i, stop_at) }
+            end
+          end
+          monitor(threads, started, stop_at)
+          threads.each(&:join)
+          elapsed = Progress.clock - started
+        ensure
+          # Also on Ctrl-C or an exception in a thread, so inserted rows
+          # never stay behind.  The threads stop first.
+          threads.each(&:kill).each { |t| t.join rescue nil }
+          cleanup(connect)
+        end
+
+        histograms = Hash[operations.collect { |op| [ op, Histogram.new ] }]
+        errors     = Hash[operations.collect { |op| [ op, 0 ] }]
+        results.each do |hists, errs|
+          hists.each { |op, h| histograms[op].merge!(h) }
+          errs.each { |op, n| errors[op] += n }
+        end
+
+        Report.new(@workload, @threads, elapsed, histograms, errors, !CT::THREADED)
+      end
+
+      private
+
+        # 100 slots filled in proportion to the weights, picked from at
+        # random.
+        def schedule(operations)
+          return operations if operations.size == 1
+
+          total = operations.sum { |op| @mix[op] }
+          operations.flat_map { |op| [ op ] * [ ( @mix[op] * 100.0 / total ).round, 1 ].max }
+        end
+
+        # Sample keys, and for inserts a template row and the largest key.
+        def prepare(table, operations)
+          index = @index ? table.get_index(@index.to_s) : table.indecies.first
+          raise ArgumentError, "#{table.name} has no index." unless index
+
+          @index_name = index.name
+          @key_fields = index.segments.collect(&:field_name)
+          @keys_found = sample_keys(table)
+          raise ArgumentError, "#{table.name} is empty." if @keys_found.empty?
+
+          return unless operations.include?('insert')
+
+          lead = index.segments.first.field
+          unless lead.integer? && !index.allow_dups?
+            raise ArgumentError, "The insert workload needs a unique index " +
+                                 "with an Integer leading segment."
+          end
+
+          # Inserts copy a row under a new key, so any other unique index
+          # without the key field would reject every one of them.
+          conflicts = table.indecies.select do |other|
+            other.name != @index_name && !other.allow_dups? &&
+              other.segments.none? { |s| s.field_name == @key_fields.first }
+          end
+          unless conflicts.empty?
+            raise ArgumentError, "The insert workload cannot copy rows: " +
+                                 "unique index(es) #{conflicts.collect(&:name).join(', ')} " +
+                                 "would reject them."
+          end
+
+          record = CT::Record.new(table).clear
+          record.default_index = @index_name
+          record.last
+          @max_key  = record.get_field(@key_fields.first)
+          @template = Hash[table.field_names.collect { |n| [ n, record.get_field(n) ] }]
+        end
+
+        # Reservoir sample of the index keys, read in batches with #pluck.
+        def sample_keys(table)
+          @progress.puts "Sampling #{@index_name}"
+
+          record = CT::Record.new(table).clear
+          record.default_index = @index_name
+          return [] if record.first.nil?
+
+          random = Random.new
+          sample = []
+          seen   = 0
+          loop do
+            batch = record.pluck(@key_fields, 10_000)
+            batch.each do |key|
+              key = [ key ] unless key.is_a?(Array) && @key_fields.size > 1
+              seen += 1
+              if sample.size < @sample
+                sample << key
+              elsif ( j = random.rand(seen) ) < @sample
+                sample[j] = key
+              end
+            end
+            break if batch.size < 10_000 || record.next.nil?
+          end
+
+          @progress.puts "Sampled #{sample.size} of #{seen} keys"
+          sample
+        end
+
+        # One thread's share of the run.
+        # @return [Array] Histograms and error counts per operation.
+        def drive(table, seed, stop_at)
+          random = Random.new(seed)
+          record = CT::Record.new(table).clear
+          record.default_index = @index_name
+
+          histograms = Hash.new { |h, op| h[op] = Histogram.new }
+          errors     = Hash.new(0)
+
+          while ( now = Progress.clock ) < stop_at
+            op = @schedule[random.rand(@schedule.size)]
+            begin
+              send(op, record, @keys_found[random.rand(@keys_found.size)])
+              histograms[op].record(Progress.clock - now)
+            rescue CT::Error
+              errors[op] += 1
+            end
+          end
+
+          [ histograms, errors ]
+        end
+
+        def seek(record, key, mode)
+          record.clear
+          @key_fields.each_with_index { |name, i| record.set_field(name, key[i]) }
+          record.find(mode)
+        end
+
+        def point(record, key)
+          seek(record, key, CT::FIND_EQ)
+        end
+
+        def range(record, key)
+          seek(record, key, CT::FIND_GE)
+          record.pluck(@key_fields, @range_size)
+        end
+
+        def update(record, key)
+          seek(record, key, CT::FIND_EQ)
+          name = @key_fields.first
+          record.set_field(name, record.get_field(name))
+          record.write!
+        end
+
+        def insert(record, key)
+          new_key = @keys.synchronize { @next_key += 1 }
+
+          record.clear
+          @template.each { |name, value| record.set_field(name, value) }
+          record.set_field(@key_fields.first, new_key)
+          record.write!
+          @inserted << new_key
+        end
+
+        # Delete the rows the insert workload added.
+        def cleanup(connect)
+          return if @inserted.empty?
+
+          @progress.puts "Deleting #{@inserted.size} inserted row(s)"
+          connect.call do |table|
+            record = CT::Record.new(table).clear
+            record.default_index = @index_name
+            until @inserted.empty?
+              key = @inserted.pop
+              begin
+                record.clear
+                record.set_field(@key_fields.first, key)
+                record.find(CT::FIND_GE)
+                record.delete! if record.get_field(@key_fields.first) == key
+              rescue CT::Error
+              end
+            end
+          end
+        end
+
+        # Print the time run so far until the threads stop.  Never sleeps
+        # past +stop_at+, which would count towards the elapsed time.
+        def monitor(threads, started, stop_at)
+          while threads.any?(&:alive?) && ( left = stop_at - Progress.clock ) > 0
+            sleep [ left, Progress::INTERVAL ].min
+            @progress.update { "%6.0fs / %.0fs" % [ Progress.clock - started, @duration ] }
+          end
+          @progress.update(true) { "%6.0fs / %.0fs" % [ Progress.clock - started, @duration ] }
+        end
+
+    end
+  end
+end
@@ -0,0 +1,406 @@
+require 'thor'
+require 'ctdb/cli/progress'
+require 'bigdecimal'
+require 'date'
+
+module CT
+  class CLI < Thor
+    # Streams a table, or a key range of one of its indexes, to CSV, JSON
+    # Lines or MessagePack.  Rows are read in batches with CT::Record#pluck,
+    # encoded and written before the next batch is read, so memory is bounded
+    # by the batch size.  With +parallel+ above one, the range is split on the
+    # leading index segment and each part is read on its own session; batches
+    # are then written in the order they complete.
+    #
+    # @example
+    #   exporter = CT::CLI::Exporter.new(format: 'jsonl', index: 'id_ndx',
+    #                                    from: ['1000'], to: ['1999'])
+    #   exporter.run($stdout) { |&block| with_table(path, &block) }
+    class Exporter
+
+      FORMATS = %w[ csv jsonl msgpack ].freeze
+
+      # @!attribute [r] format
+      #   @return [String]
+      attr_reader :format
+      # @!attribute [r] rows
+      #   @return [Fixnum] Rows written by #run
+      attr_reader :rows
+
+      # @param [Hash] opts
+      # @option opts [String] :format One of FORMATS
+      # @option opts [Array<String>] :fields Fields to export, all by default
+      # @option opts [String] :index Index to walk, the table order by default
+      # @option opts [Array<String>] :from Segment values of the first key
+      # @option opts [Array<String>] :to Segment values of the last key.  A
+      #   partial key ends the walk after every key it prefixes.
+      # @option opts [Fixnum] :batch_size (1000) Rows per read
+      # @option opts [Fixnum] :parallel (1) Key ranges read at once
+      # @option opts [IO] :progress Where rows/sec are reported, if anywhere
+      def initialize(opts={})
+        @format     = opts[:format].to_s
+        @fields     = opts[:fields]
+        @index      = opts[:index]
+        @from       = Array(opts[:from])
+        @to         = Array(opts[:to])
+        @batch_size = opts[:batch_size] || 1000
+        @parallel   = opts[:parallel] || 1
+        @progress   = opts[:progress]
+        @rows       = 0
+
+        unless FORMATS.include?(@format)
+          raise ArgumentError, "Unknown format `#{@format}', expected one " +
+                               "of #{FORMATS.join(', ')}."
+        end
+        if ( @index.nil? || @index.to_s.empty? ) && ( @from.any? || @to.any? )
+          raise ArgumentError, "--from and --to need an --index."
+        end
+      end
+
+      # Export the rows.  +connect+ is called once per key range being read
+      # and must yield an open CT::Table, on its own session when parallel.
+      #
+      # @param [IO] io
+      # @yield [&block] Open the table and yield it to +block+.
+      # @return [Fixnum] Rows written
+      def run(io, &connect)
+        @reporter = Progress.new(@progress)
+        @encoder  = encoder_for(io)
+        @writes   = Mutex.new
+
+        ranges = @parallel > 1 ? split(connect) : [ [ @from, @to ] ]
+
+        if ranges.size == 1
+          connect.call { |table| export(table, *ranges.first) }
+        else
+          ranges.collect do |from, to|
+            Thread.new { connect.call { |table| export(table, from, to) } }
+          end.each(&:join)
+        end
+
+        @encoder.finish
+        report(true)
+        @rows
+      end
+
+      private
+
+        # Walk one key range, writing each batch as it is read.
+        def export(table, from, to)
+          record = CT::Record.new(table).clear
+          record.temporal_mode = :core
+          record.numeric_mode  = :decimal
+
+          fields = @fields || table.field_names
+          keys   = key_segments(table)
+          names  = fields + ( keys.collect(&:first) - fields )
+          limit  = to.empty? ? nil : bound(keys, to)
+
+          @writes.synchronize { @encoder.header(fields) }
+
+          return unless start(record, keys, from)
+
+          loop do
+            batch = record.pluck(names, @batch_size)
+            batch = batch.collect { |value| [ value ] } if names.size == 1
+            full  = batch.size == @batch_size
+
+            done = limit && truncate(batch, names, limit)
+            write(fields, batch)
+
+            break if done || !full || record.next.nil?
+          end
+        end
+
+        # Index segment [name, field, direction, mode] tuples.
+        def key_segments(table)
+          return [] unless @index
+
+          table.get_index(@index.to_s).segments.collect do |segment|
+            descending = ( segment.mode & CT::SEG_DESCENDING ) != 0
+            [ segment.field_name, segment.field, descending ? -1 : 1,
+              segment.mode ]
+          end
+        end
+
+        # Position +record+ on the first row of the range.
+        # @return [Boolean] false if the range is empty.
+        # @raise [CT::Error] Any error but a key not found.
+        def start(record, keys, from)
+          record.default_index = @index.to_s if @index
+          return !record.first.nil? if from.empty?
+
+          from.each_with_index do |value, i|
+            record.set_field(keys[i][0], key_value(keys[i][1], value))
+          end
+          record.find(CT::FIND_GE)
+          true
+        rescue CT::Error => e
+          raise unless e.errno == CT::INOT_ERR
+          false
+        end
+
+        # [name, value, direction, upcase] per segment of +to+.  The index
+        # stores uppercase segments upcased, so they compare upcased.
+        # @raise [ArgumentError] A segment's order cannot be reproduced.
+        def bound(keys, to)
+          to.each_with_index.collect do |value, i|
+            name, field, direction, mode = keys[i]
+            if ( mode & CT::SEG_ALTSEG ) != 0
+              raise ArgumentError, "--to cannot bound `#{name}', which " +
+                                   "uses an alternate collating sequence."
+            end
+
+            upcase = uppercase?(mode)
+            value  = key_value(field, value)
+            value  = value.upcase(:ascii) if upcase && value.is_a?(String)
+            [ name, value, direction, upcase ]
+          end
+        end
+
+        def uppercase?(mode)
+          [ CT::SEG_USCHSEG, CT::SEG_UVSCHSEG, CT::SEG_UVARSEG,
+            CT::SEG_UREGSEG ].include?(mode & ~( CT::SEG_DESCENDING | CT::SEG_ALTSEG ))
+        end
+
+        # Drop the rows of +batch+ past +limit+.
+        # @return [Boolean] true if any were dropped.
+        def truncate(batch, names, limit)
+          index = batch.index { |row| past?(row, names, limit) }
+          return false if index.nil?
+
+          batch.slice!(index..-1)
+          true
+        end
+
+        # Compare the key of +row+ with +limit+ in index order.  Only the
+        # segments in +limit+ take part.
+        # @raise [ArgumentError] A key value cannot be compared with the bound.
+        def past?(row, names, limit)
+          limit.each do |name, value, direction, upcase|
+            key = row[names.index(name)]
+            key = key.upcase(:ascii) if upcase && key.is_a?(String)
+            cmp = compare(name, key, value) * direction
+            return cmp > 0 unless cmp == 0
+          end
+          false
+        end
+
+        # Null keys sort first, booleans as 0 and 1.
+        def compare(name, key, value)
+          return value.nil? ? 0 : -1 if key.nil?
+          return 1 if value.nil?
+
+          key, value = [ key, value ].collect do |v|
+            v == true ? 1 : v == false ? 0 : v
+          end
+          cmp = key <=> value
+          if cmp.nil?
+            raise ArgumentError, "Cannot compare `#{name}' value " +
+                                 "#{key.inspect} with #{value.inspect}."
+          end
+          cmp
+        end
+
+        # Convert a --from or --to String to what the record reads for
+        # +field+ in :core and :decimal modes.
+        # @raise [ArgumentError] The String is not a valid value.
+        def key_value(field, value)
+          return value unless value.is_a?(String)
+
+          case field.type
+          when CT::NUMBER, CT::MONEY, CT::CURRENCY then BigDecimal(value)
+          when CT::FLOAT, CT::DOUBLE, CT::EFLOAT    then Float(value)
+          when CT::DATE      then ::Date.iso8601(value)
+          when CT::TIMESTAMP then ::DateTime.iso8601(value)
+          when CT::TIME
+            h, m, s = value.split(':', 3).collect { |v| Integer(v, 10) }
+            ::Time.new(1970, 1, 1, h, m || 0, s || 0)
+          when CT::BOOL
+            case value.downcase
+            when 'true', '1'  then true
+            when 'false', '0' then false
+            else raise ArgumentError, "Invalid boolean `#{value}'."
+            end
+          else
+            field.integer? ? Integer(value, 10) : value
+          end
+        end
+
+        def write(fields, batch)
+          return if batch.empty?
+
+          @writes.synchronize do
+            @encoder.rows(fields, batch)
+            @rows += batch.size
+            report
+          end
+        end
+
+        def report(final=false)
+          @reporter.update(final) do |elapsed|
+            "%12d rows %10.0f rows/s %8.1fs" % [ @rows, @rows / elapsed, elapsed ]
+          end
+        end
+
+        # Split the range on the leading index segment.  Only ascending
+        # Integer keys can be split; anything else, NUMBER included as it is
+        # read as a BigDecimal, is read as one range.
+        def split(connect)
+          lo = @from.first
+          hi = @to.first
+
+          connect.call do |table|
+            keys = key_segments(table)
+            if keys.empty? || !keys[0][1].integer? ||
+               keys[0][1].type == CT::NUMBER || keys[0][2] < 0
+              return [ [ @from, @to ] ]
+            end
+
+            record = CT::Record.new(table).clear
+            record.default_index = @index.to_s
+            return [ [ @from, @to ] ] if record.first.nil?
+            lo ||= record.get_field(keys[0][0])
+            record.last
+            hi ||= record.get_field(keys[0][0])
+
+            lo, hi = key_value(keys[0][1], lo), key_value(keys[0][1], hi)
+          end
+          split_range(lo, hi)
+        end
+
+        # Cut lo..hi into at most +parallel+ ranges of whole keys.  The first
+        # and last keep the full --from and --to keys.
+        def split_range(lo, hi)
+          return [ [ @from, @to ] ] if hi < lo
+
+          step = ( ( hi - lo + 1 ) / @parallel.to_f ).ceil
+          ( lo..hi ).step(step).collect do |first|
+            last = [ first + step - 1, hi ].min
+            from = first == lo ? @from : [ first.to_s ]
+            to   = last == hi ? @to : [ last.to_s ]
+            [ from, to ]
+          end
+        end
+
+        def encoder_for(io)
+          case @format
+          when 'csv'     then CSVEncoder.new(io)
+          when 'jsonl'   then JSONLinesEncoder.new(io)
+          when 'msgpack' then MessagePackEncoder.new(io)
+          end
+        end
+
+      # Writes a header once, then rows.
+      class Encoder
+
+        def initialize(io)
+          @io = io
+          @header = false
+        end
+
+        def header(fields)
+          return if @header
+          @header = true
+          write_header(fields)
+        end
+
+        def rows(fields, batch)
+          @io.write(encode(fields, batch))
+        end
+
+        def finish
+          @io.flush
+        end
+
+        private
+
+          def write_header(fields)
+          end
+
+          # Values every format can hold: Strings, numbers, booleans and nil.
+          def plain(value)
+            case value
+            when nil, true, false, Integer, Float, String then value
+            when BigDecimal then value.to_s('F')
+            when ::Time     then value.strftime('%H:%M:%S')
+            else value.to_s
+            end
+          end
+
+      end
+
+      class CSVEncoder < Encoder
+
+        def initialize(io)
+          require 'csv'
+          super
+        end
+
+        private
+
+          def write_header(fields)
+            @io.write(CSV.generate_line(fields))
+          end
+
+          def encode(fields, batch)
+            batch.each_with_object(String.new) do |row, out|
+              out << CSV.generate_line(row.first(fields.size).collect { |v| plain(v) })
+            end
+          end
+
+      end
+
+      class JSONLinesEncoder < Encoder
+
+        def initialize(io)
+          require 'json'
+          require 'base64'
+          super
+        end
+
+        private
+
+          def encode(fields, batch)
+            batch.each_with_object(String.new) do |row, out|
+              out << JSON.generate(hash(fields, row)) << "\n"
+            end
+          end
+
+          def hash(fields, row)
+            fields.each_with_index.each_with_object({}) do |(name, i), h|
+              value = plain(row[i])
+              # Binary fields that are not valid UTF-8.
+              if value.is_a?(String) && !value.dup.force_encoding(Encoding::UTF_8).valid_encoding?
+                value = Base64.strict_encode64(value)
+              end
+              h[name] = value
+            end
+          end
+
+      end
+
+      class MessagePackEncoder < Encoder
+
+        def initialize(io)
+          begin
+            require 'msgpack'
+          rescue LoadError
+            raise Thor::Error, "The msgpack format needs the msgpack gem."
+          end
+          super
+        end
+
+        private
+
+          def encode(fields, batch)
+            batch.each_with_object(String.new) do |row, out|
+              out << MessagePack.pack(Hash[fields.zip(row.collect { |v| plain(v) })])
+            end
+          end
+
+      end
+
+    end
+  end
+end
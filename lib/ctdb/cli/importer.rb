@@ -0,0 +1,300 @@
+require 'thor'
+require 'ctdb/cli/progress'
+require 'json'
+require 'bigdecimal'
+require 'date'
+
+module CT
+  class CLI < Thor
+    # Loads CSV (with a header row) or JSON Lines into a table.  Input is
+    # parsed a row at a time and written in transactions of +commit_every+
+    # rows.  After each commit the number of input rows done is saved to a
+    # checkpoint file, so an interrupted load started again with the same
+    # arguments skips what was already committed.  Rows that cannot be
+    # converted or written are copied, unchanged, to a reject file.
+    #
+    # With +defer_indexes+ the indexes that allow duplicates and follow the
+    # last unique index are deleted for the load and added back, and built
+    # in one pass, at the end.  Unique indexes stay in place, so a duplicate
+    # key still rejects just its row, and so do the indexes before them:
+    # added back indexes go to the end, and the first index is the default.
+    # The definitions are kept in the checkpoint until then.
+    #
+    # @example
+    #   importer = CT::CLI::Importer.new("orders.csv", defer_indexes: true)
+    #   importer.run(session, table)
+    class Importer
+
+      FORMATS = %w[ csv jsonl ].freeze
+
+      TRUE_VALUES = %w[ 1 t true y yes ].freeze
+
+      # @!attribute [r] format
+      #   @return [String]
+      attr_reader :format
+      # @!attribute [r] inserted
+      #   @return [Fixnum] Rows written, including earlier runs
+      attr_reader :inserted
+      # @!attribute [r] rejected
+      #   @return [Fixnum] Rows copied to the reject file, including earlier
+      #     runs
+      attr_reader :rejected
+
+      # @param [String] path Input file
+      # @param [Hash] opts
+      # @option opts [String] :format One of FORMATS, from the extension by
+      #   default
+      # @option opts [Fixnum] :commit_every (1000) Rows per transaction
+      # @option opts [Boolean] :defer_indexes Build secondary indexes after
+      #   the load
+      # @option opts [Boolean] :rebuild Rebuild the indexes after the load
+      # @option opts [String] :checkpoint (path + ".checkpoint")
+      # @option opts [String] :reject (path + ".rejects")
+      # @option opts [IO] :progress Where progress is reported, if anywhere
+      def initialize(path, opts={})
+        @path          = path
+        @format        = ( opts[:format] || File.extname(path).delete('.') ).to_s
+        @format        = 'jsonl' if @format == 'json' || @format == 'ndjson'
+        @commit_every  = opts[:commit_every] || 1000
+        @defer_indexes = opts[:defer_indexes]
+        @rebuild       = opts[:rebuild]
+        @checkpoint    = opts[:checkpoint] || "#{path}.checkpoint"
+        @reject_path   = opts[:reject] || "#{path}.rejects"
+        @progress      = Progress.new(opts[:progress])
+
+        unless FORMATS.include?(@format)
+          raise ArgumentError, "Unknown format `#{@format}', expected one " +
+                               "of #{FORMATS.join(', ')}."
+        end
+      end
+
+      # Load the file.  With deferred indexes +table+ must be open
+      # exclusively.
+      #
+      # @param [CT::Session] session
+      # @param [CT::Table] table
+      # @return [Fixnum] Rows inserted
+      def run(session, table)
+        state      = load_checkpoint
+        @done      = state['rows']
+        @inserted  = state['inserted']
+        @rejected  = state['rejected']
+        @indexes   = state['indexes'] || ( @defer_indexes ? drop_indexes(table) : [] )
+        @resumed   = @done
+
+        record = CT::Record.new(table)
+        record.temporal_mode = :core
+        record.numeric_mode  = :decimal
+        converters = converters_for(table)
+
+        save_checkpoint
+        rows = 0
+        batch = []
+        each_row do |raw, row, line|
+          batch << [ raw, row, line ]
+          next if batch.size < @commit_every
+
+          rows += write(session, record, converters, batch)
+          batch = []
+        end
+        rows += write(session, record, converters, batch)
+
+        restore_indexes(table)
+        table.rebuild(CT::DB_REBUILD_INDEX) if @rebuild
+        report(true)
+
+        File.delete(@checkpoint) if File.exist?(@checkpoint)
+        rows
+      ensure
+        @rejects.close if @rejects
+      end
+
+      private
+
+        def load_checkpoint
+          if File.exist?(@checkpoint)
+            state = JSON.parse(File.read(@checkpoint))
+            if state['path'] == File.expand_path(@path)
+              @progress.puts "Resuming after row #{state['rows']}"
+              return state
+            end
+          end
+          { 'rows' => 0, 'inserted' => 0, 'rejected' => 0 }
+        end
+
+        # Written to a temporary file and renamed, so a crash never leaves a
+        # partial checkpoint.
+        def save_checkpoint
+          state = { 'path' => File.expand_path(@path), 'rows' => @done,
+                    'inserted' => @inserted, 'rejected' => @rejected,
+                    'indexes' => @indexes }
+          File.write("#{@checkpoint}.tmp", JSON.generate(state))
+          File.rename("#{@checkpoint}.tmp", @checkpoint)
+        end
+
+        # Yield each input row after the checkpoint as the raw text, a Hash
+        # of field name => value and its row number.
+        def each_row
+          File.open(@path, 'r') do |io|
+            if @format == 'csv'
+              require 'csv'
+              csv = CSV.new(io, headers: true, return_headers: false)
+              csv.each.with_index(1) do |row, line|
+                @headers ||= row.headers
+                next if line <= @done
+                yield row.to_s, row.to_h, line
+              end
+            else
+              io.each_line.with_index(1) do |raw, line|
+                next if line <= @done || raw.strip.empty?
+                row = begin
+                  JSON.parse(raw)
+                rescue JSON::ParserError => e
+                  e
+                end
+                yield raw, row, line
+              end
+            end
+          end
+        end
+
+        # Write one transaction, then move the checkpoint past it.
+        def write(session, record, converters, batch)
+          return 0 if batch.empty?
+
+          rejects = []
+          session.transaction do
+            batch.each do |raw, row, line|
+              begin
+                raise row if row.is_a?(Exception)
+                raise ArgumentError, "Expected an object" unless row.is_a?(Hash)
+
+                record.clear
+                row.each do |name, value|
+                  convert = converters.fetch(name.to_s) do
+                    raise ArgumentError, "Unknown field `#{name}'"
+                  end
+                  record.set_field(name.to_s, convert.call(value))
+                end
+                record.write!
+              rescue CT::Error, ArgumentError, TypeError, RangeError,
+                     JSON::ParserError => e
+                rejects << [ raw, line, e ]
+              end
+            end
+          end
+
+          rejects.each { |raw, line, e| reject(raw, line, e) }
+          @rejects.flush if @rejects
+          written    = batch.size - rejects.size
+          @inserted += written
+          @done      = batch.last[2]
+          save_checkpoint
+          report
+          written
+        end
+
+        def reject(raw, line, error)
+          @rejected += 1
+          @rejects ||= File.open(@reject_path, 'a').tap do |io|
+            io.write(CSV.generate_line(@headers)) if @headers && io.size.zero?
+          end
+          @rejects.write(raw.end_with?("\n") ? raw : raw + "\n")
+          @progress.puts "\rRow #{line}: #{error.message}"
+        end
+
+        # Field name => lambda turning an input value into one #set_field
+        # takes.  Empty CSV cells are NULL except in string fields.
+        def converters_for(table)
+          table.fields.each_with_object({}) do |field, converters|
+            convert = converter(field)
+            converters[field.name] = if field.string?
+              convert
+            else
+              ->(v) { v.is_a?(String) && v.empty? ? nil : convert.call(v) }
+            end
+          end
+        end
+
+        def converter(field)
+          case field.type
+          when CT::BOOL
+            ->(v) { v.is_a?(String) ? TRUE_VALUES.include?(v.downcase) : v }
+          when CT::TINYINT, CT::UTINYINT, CT::SMALLINT, CT::USMALLINT,
+               CT::INTEGER, CT::UINTEGER, CT::BIGINT
+            ->(v) { v.is_a?(String) ? Integer(v, 10) : v }
+          when CT::FLOAT, CT::DOUBLE, CT::EFLOAT
+            ->(v) { v.is_a?(String) ? Float(v) : v }
+          when CT::NUMBER, CT::MONEY, CT::CURRENCY
+            ->(v) { v.is_a?(String) || v.is_a?(Float) ? BigDecimal(v.to_s) : v }
+          when CT::DATE
+            ->(v) { v.is_a?(String) ? ::Date.iso8601(v) : v }
+          when CT::TIMESTAMP
+            ->(v) { v.is_a?(String) ? ::DateTime.iso8601(v) : v }
+          when CT::TIME
+            ->(v) {
+              next v unless v.is_a?(String)
+              h, m, s = v.split(':').collect { |part| Integer(part, 10) }
+              ::Time.new(1970, 1, 1, h, m || 0, s || 0)
+            }
+          else
+            ->(v) { v }
+          end
+        end
+
+        # Delete the indexes after the last unique one, which all allow
+        # duplicates.  Added back in the same order, they keep their numbers.
+        # @return [Array<Hash>] The definitions, to add them back with.
+        def drop_indexes(table)
+          indexes = table.indecies
+          unique  = indexes.rindex { |index| !index.allow_dups? }
+          indexes = indexes[( unique ? unique + 1 : 0 )..-1].collect do |index|
+            { 'name'       => index.name,
+              'key_type'   => index.key_type,
+              'allow_dups' => index.allow_dups?,
+              'allow_nil'  => index.allow_nil?,
+              'segments'   => index.segments.collect { |s| [ s.field_name, s.mode ] } }
+          end
+          return indexes if indexes.empty?
+
+          # Saved before the table changes, so a crash during the alter still
+          # leaves the definitions behind.
+          save_checkpoint_indexes(indexes)
+          indexes.reverse_each { |index| table.delete_index(index['name']) }
+          table.alter(CT::DB_ALTER_NORMAL)
+          @progress.puts "Deferred #{indexes.size} index(es)"
+          indexes
+        end
+
+        def save_checkpoint_indexes(indexes)
+          @indexes = indexes
+          save_checkpoint
+        end
+
+        def restore_indexes(table)
+          return if @indexes.empty?
+
+          @progress.puts "\nBuilding #{@indexes.size} index(es)"
+          @indexes.each do |definition|
+            index = table.add_index(definition['name'], definition['key_type'],
+                                    allow_dups: definition['allow_dups'],
+                                    allow_nil:  definition.fetch('allow_nil', true))
+            definition['segments'].each do |field_name, mode|
+              index.add_segment(table.get_field(field_name), mode)
+            end
+          end
+          table.alter(CT::DB_ALTER_INDEX)
+          @indexes = []
+          save_checkpoint
+        end
+
+        def report(final=false)
+          @progress.update(final) do |elapsed|
+            "%12d rows %10.0f rows/s %8d rejected %8.1fs" %
+              [ @done, ( @done - @resumed ) / elapsed, @rejected, elapsed ]
+          end
+        end
+
+    end
+  end
+end
@@ -0,0 +1,135 @@
+require 'thor'
+require 'erb'
+require 'fileutils'
+require 'yaml'
+
+module CT
+  class CLI < Thor
+    # Writes a small C extension specialised to one table layout, from a
+    # schema file written by `ctdb dump_schema`.  Fields in front of the
+    # first variable length field are decoded straight from the record
+    # buffer at their dumped offset, the rest through ctdbGetFieldAddress.
+    # Types the generator does not decode itself (NUMBER, EFLOAT and the
+    # length prefixed strings) fall back to CT::Record#get_field and
+    # #set_field.
+    #
+    # @example
+    #   CT::CLI::ModelGenerator.new("orders.yml").write("ext/")
+    #   # => ["ext/orders_layout/extconf.rb", "ext/orders_layout/orders_layout.c"]
+    class ModelGenerator
+
+      # C decoder and setter per field type.  Decoders take a pointer to the
+      # field data.
+      TYPES = {
+        'CT_BOOL'      => [ 'layout_bool',      'layout_set_bool' ],
+        'CT_TINYINT'   => [ 'layout_tinyint',   'layout_set_signed' ],
+        'CT_UTINYINT'  => [ 'layout_utinyint',  'layout_set_unsigned' ],
+        'CT_SMALLINT'  => [ 'layout_smallint',  'layout_set_signed' ],
+        'CT_USMALLINT' => [ 'layout_usmallint', 'layout_set_unsigned' ],
+        'CT_INTEGER'   => [ 'layout_integer',   'layout_set_signed' ],
+        'CT_UINTEGER'  => [ 'layout_uinteger',  'layout_set_unsigned' ],
+        'CT_BIGINT'    => [ 'layout_bigint',    'layout_set_bigint' ],
+        'CT_MONEY'     => [ 'layout_money',     'layout_set_money' ],
+        'CT_CURRENCY'  => [ 'layout_currency',  'layout_set_currency' ],
+        'CT_FLOAT'     => [ 'layout_float',     'layout_set_float' ],
+        'CT_DOUBLE'    => [ 'layout_double',    'layout_set_float' ],
+        'CT_DATE'      => [ 'layout_date',      'layout_set_date' ],
+        'CT_TIME'      => [ 'layout_time',      'layout_set_time' ],
+        'CT_TIMESTAMP' => [ 'layout_date_time', 'layout_set_date_time' ],
+        'CT_CHARS'     => [ 'layout_chars',     nil ],
+        'CT_BINARY'    => [ 'layout_binary',    nil ],
+        'CT_VARCHAR'   => [ 'layout_varchar',   nil ],
+        'CT_VARBINARY' => [ 'layout_binary',    nil ],
+        'CT_LVB'       => [ 'layout_binary',    nil ]
+      }.freeze
+
+      # Length prefix in front of the data of a variable length field.
+      PREFIXES = { 'CT_VARCHAR' => 2, 'CT_VARBINARY' => 2, 'CT_LVB' => 4 }.freeze
+
+      Field = Struct.new(:name, :ident, :number, :type, :length, :offset,
+                         :allow_nil) do
+        def decoder
+          return 'layout_double' if type == 'CT_FLOAT' && length == 8
+          TYPES[type] && TYPES[type][0]
+        end
+
+        def setter
+          TYPES[type] && TYPES[type][1]
+        end
+
+        def prefix
+          PREFIXES[type]
+        end
+
+        # Decoded from the record buffer at the offset in the schema.
+        def static?
+          offset >= 0 && prefix.nil?
+        end
+      end
+
+      # @!attribute [r] table_name
+      #   @return [String]
+      attr_reader :table_name
+      # @!attribute [r] fields
+      #   @return [Array<CT::CLI::ModelGenerator::Field>]
+      attr_reader :fields
+
+      # @param [String] schema_path Schema file written by `ctdb dump_schema`
+      def initialize(schema_path)
+        @schema_path = schema_path
+        schema       = YAML.load_file(schema_path)
+        @table_name  = schema['name'].to_s
+        @fields      = schema['fields'].each_with_index.collect do |f, i|
+          Field.new(f['name'].to_s, identifier(f['name']), f['number'] || i,
+                    f['type'].to_s.sub('::', '_'), f['length'].to_i,
+                    f['offset'] || -1, f['allow_nil'] != false)
+        end
+      end
+
+      # @return [String] Name of the extension, e.g. "orders_layout"
+      def extension_name
+        "#{identifier(table_name)}_layout"
+      end
+
+      # @return [String] Name of the module under CT::Layout
+      def module_name
+        identifier(table_name).split('_').collect(&:capitalize).join
+      end
+
+      # @return [String] The extension source
+      def source
+        ERB.new(File.read(template_path('layout.c.erb')), trim_mode: '-').result(binding)
+      end
+
+      # @return [String] The extension extconf.rb
+      def extconf
+        ERB.new(File.read(template_path('extconf.rb.erb')), trim_mode: '-').result(binding)
+      end
+
+      # Write the extension into +dir+/<extension_name>.
+      #
+      # @param [String] dir
+      # @return [Array<String>] The files written
+      def write(dir)
+        path = File.join(dir, extension_name)
+        FileUtils.mkdir_p(path)
+
+        files = { 'extconf.rb' => extconf, "#{extension_name}.c" => source }
+        files.collect do |name, content|
+          File.join(path, name).tap { |file| File.write(file, content) }
+        end
+      end
+
+      private
+
+        def identifier(name)
+          name.to_s.downcase.gsub(/[^a-z0-9_]/, '_').sub(/\A(?=\d)/, '_')
+        end
+
+        def template_path(name)
+          File.join(File.dirname(__FILE__), 'templates', name)
+        end
+
+    end
+  end
+end
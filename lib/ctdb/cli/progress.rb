@@ -0,0 +1,64 @@
+require 'thor'
+
+module CT
+  class CLI < Thor
+    # A progress line rewritten in place on a terminal, at most once per
+    # +interval+ seconds.  Every method is a no-op without an IO, so
+    # commands can report unconditionally.
+    #
+    # @example
+    #   progress = CT::CLI::Progress.new($stderr)
+    #   progress.update { |elapsed| "%d rows %.1fs" % [ rows, elapsed ] }
+    #   progress.update(true) { |elapsed| "done in %.1fs" % elapsed }
+    class Progress
+
+      # Seconds between updates.
+      INTERVAL = 1.0
+
+      # @return [Float] Monotonic seconds
+      def self.clock
+        Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      end
+
+      # @param [IO, nil] io
+      # @param [Numeric] interval
+      def initialize(io, interval=INTERVAL)
+        @io       = io
+        @interval = interval
+        @started  = @reported = Progress.clock
+      end
+
+      # @return [Float] Seconds since the progress started, never zero
+      def elapsed
+        [ Progress.clock - @started, 0.001 ].max
+      end
+
+      # Rewrite the line with the block's result if +interval+ has passed
+      # since the last update, or always when +final+, which also ends the
+      # line.
+      #
+      # @param [Boolean] final
+      # @yield [elapsed] Seconds since the progress started
+      # @yieldreturn [String] The line
+      def update(final=false)
+        return unless @io
+
+        now = Progress.clock
+        return if !final && now - @reported < @interval
+
+        @reported = now
+        @io.print "\r" + yield(elapsed)
+        @io.puts if final
+        @io.flush
+      end
+
+      # Print a message on its own line.
+      #
+      # @param [String] message
+      def puts(message)
+        @io.puts(message) if @io
+      end
+
+    end
+  end
+end
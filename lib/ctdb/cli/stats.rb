@@ -0,0 +1,392 @@
+require 'thor'
+require 'ctdb/cli/progress'
+require 'json'
+
+module CT
+  class CLI < Thor
+    # Profiles the data in a table in one pass: record count, record
+    # lengths, key cardinality and duplication per index, null ratios per
+    # field and the most common values of low cardinality fields.  Distinct
+    # counts come from HyperLogLog sketches and common values from
+    # space-saving counters, so memory does not grow with the table.
+    #
+    # With +sample+ below the record count only +sample+ rows are read.  When
+    # the first index leads with an Integer segment they are read in short
+    # runs from random keys across the whole key range; otherwise they are
+    # the first rows in index order.
+    #
+    # @example
+    #   stats = CT::CLI::Stats.new(sample: 100_000)
+    #   puts CT::CLI::Stats.format(stats.run(table))
+    class Stats
+
+      # Rows read per run when sampling from random keys.
+      RUN_LENGTH = 100
+
+      # Fields with at most this many distinct values list their top values.
+      LOW_CARDINALITY = 50
+
+      # Values per top values list.
+      TOP = 10
+
+      # HyperLogLog distinct counter with 2**PRECISION registers, about 2%
+      # standard error.
+      class HyperLogLog
+
+        PRECISION = 11
+        REGISTERS = 1 << PRECISION
+        MASK      = ( 1 << 64 ) - 1
+        ALPHA     = 0.7213 / ( 1 + 1.079 / REGISTERS )
+
+        def initialize
+          @registers = Array.new(REGISTERS, 0)
+        end
+
+        # @param [Object] value Anything with a stable #hash
+        def add(value)
+          h    = mix(value.hash & MASK)
+          i    = h >> ( 64 - PRECISION )
+          rest = ( h << PRECISION ) & MASK
+          rank = rest.zero? ? 64 - PRECISION + 1 : 64 - rest.bit_length + 1
+          @registers[i] = rank if rank > @registers[i]
+        end
+
+        # @return [Fixnum] Estimated distinct values added
+        def count
+          sum   = @registers.sum { |r| 2.0 ** -r }
+          est   = ALPHA * REGISTERS * REGISTERS / sum
+          zeros = @registers.count(0)
+
+          # Linear counting while most registers are still empty.
+          if est <= 2.5 * REGISTERS && zeros > 0
+            est = REGISTERS * Math.log(REGISTERS.to_f / zeros)
+          end
+          est.round
+        end
+
+        private
+
+          # splitmix64 finalizer, spreads Object#hash over all 64 bits.
+          def mix(h)
+            h = ( ( h ^ ( h >> 30 ) ) * 0xbf58476d1ce4e5b9 ) & MASK
+            h = ( ( h ^ ( h >> 27 ) ) * 0x94d049bb133111eb ) & MASK
+            h ^ ( h >> 31 )
+          end
+
+      end
+
+      # Space-saving top-k counter.  Counts are exact while no more than
+      # +capacity+ distinct values have been seen.  After that a new value
+      # replaces the least counted one and inherits its count as the error,
+      # so each entry's true count lies between count - error and count.
+      class TopValues
+
+        def initialize(capacity)
+          @capacity = capacity
+          @counts   = {}
+        end
+
+        def add(value)
+          if ( entry = @counts[value] )
+            entry[0] += 1
+          elsif @counts.size < @capacity
+            @counts[value] = [ 1, 0 ]
+          else
+            min, ( n, _ ) = @counts.min_by { |_, (c, _)| c }
+            @counts.delete(min)
+            @counts[value] = [ n + 1, n ]
+          end
+        end
+
+        # @param [Fixnum] n
+        # @return [Array] [value, count, error] triples, most common first
+        def top(n=@capacity)
+          @counts.sort_by { |_, (c, _)| -c }.first(n).collect { |v, (c, e)| [ v, c, e ] }
+        end
+
+      end
+
+      # Per field tallies.
+      class FieldProfile
+
+        attr_reader :name, :nulls, :distinct
+
+        def initialize(name)
+          @name     = name
+          @nulls    = 0
+          @distinct = HyperLogLog.new
+          # Room for every value of a low cardinality field, with margin for
+          # the HyperLogLog estimate, so the counts reported are exact.
+          @top      = TopValues.new(LOW_CARDINALITY * 2)
+        end
+
+        def add(value)
+          if value.nil?
+            @nulls += 1
+          else
+            @distinct.add(value)
+            @top.add(value) if @top
+          end
+        end
+
+        # Stop counting values once the field is clearly not low cardinality.
+        def prune
+          @top = nil if @top && @distinct.count > LOW_CARDINALITY * 4
+        end
+
+        def top
+          return nil unless @top && @distinct.count <= LOW_CARDINALITY
+          @top.top(TOP).collect { |value, count, _| [ value, count ] }
+        end
+
+      end
+
+      # Per index tallies.
+      class IndexProfile
+
+        attr_reader :name, :fields, :allow_dups, :distinct
+
+        def initialize(name, fields, allow_dups)
+          @name       = name
+          @fields     = fields
+          @allow_dups = allow_dups
+          @distinct   = HyperLogLog.new
+          @duplicates = TopValues.new(TOP * 4)
+        end
+
+        def add(key)
+          @distinct.add(key)
+          @duplicates.add(key) if @allow_dups
+        end
+
+        # Keys certain to occur more than once, even allowing for the
+        # counter's error.
+        #
+        # @return [Array] [key, count, error] triples, most common first
+        def most_duplicated
+          @duplicates.top.select { |_, count, error| count - error > 1 }.first(TOP)
+        end
+
+      end
+
+      # @param [Hash] opts
+      # @option opts [Fixnum] :sample Rows to read, all of them by default
+      # @option opts [IO] :progress Where progress is reported, if anywhere
+      def initialize(opts={})
+        @sample   = opts[:sample]
+        @progress = Progress.new(opts[:progress])
+      end
+
+      # @param [CT::Table] table
+      # @return [Hash] The statistics
+      def run(table)
+        record = new_record(table)
+        names  = table.field_names
+        count  = record.count
+
+        @fields  = names.collect { |name| FieldProfile.new(name) }
+        @indexes = table.indecies.collect do |index|
+          IndexProfile.new(index.name, index.segments.collect(&:field_name),
+                           index.allow_dups?)
+        end
+        @key_columns = @indexes.collect { |i| i.fields.collect { |f| names.index(f) } }
+        @lengths     = record_lengths(table, record)
+        @rows        = 0
+        @next_prune  = 10_000
+        @length_sum  = 0
+        @length_max  = 0
+
+        if @sample && @sample < count && sampled?(table)
+          read_runs(table, names)
+        else
+          read_all(table, names)
+        end
+
+        report(table, count)
+      end
+
+      # @param [Hash] stats As returned by #run
+      # @return [String]
+      def self.format(stats)
+        lines = []
+        lines << "%s: %d records, %d read%s" %
+            [ stats[:table], stats[:records], stats[:rows],
+              stats[:rows] < stats[:records] ? " (sampled)" : "" ]
+        lines << "Record length: %.1f average, %d max" %
+            [ stats[:record_length][:average], stats[:record_length][:max] ]
+        lines << ""
+        lines << "      Index                Distinct   Rows/key  Most duplicated"
+        lines << "     ------------------   ---------  ---------  ---------------"
+        stats[:indexes].each do |index|
+          top = index[:most_duplicated].first
+          lines << "     %-20s %9d %10.2f  %s" %
+              [ index[:name], index[:distinct], index[:rows_per_key],
+                top ? "#{top[:key].inspect} x#{top[:count]}" : "-" ]
+        end
+        lines << ""
+        lines << "      Field                Distinct     Null %"
+        lines << "     ------------------   ---------  ---------"
+        stats[:fields].each do |field|
+          lines << "     %-20s %9d %9.2f%%" %
+              [ field[:name], field[:distinct], field[:null_ratio] * 100 ]
+          ( field[:top_values] || [] ).each do |top|
+            lines << "         %-30s %9d" % [ top[:value].inspect[0, 30], top[:count] ]
+          end
+        end
+        lines.join("\n")
+      end
+
+      private
+
+        # Modes whose values hash by value.
+        def new_record(table)
+          CT::Record.new(table).clear.tap do |record|
+            record.temporal_mode = :core
+            record.numeric_mode  = :decimal
+          end
+        end
+
+        # Walk the table from the first record.
+        def read_all(table, names)
+          record = new_record(table)
+          return if record.first.nil?
+
+          loop do
+            want  = @sample ? [ @sample - @rows, 10_000 ].min : 10_000
+            batch = record.pluck(names, want)
+            add(batch, names)
+            progress
+
+            break if batch.size < want || ( @sample && @rows >= @sample )
+            break if record.next.nil?
+          end
+        end
+
+        # The first index leads with an Integer segment.
+        def sampled?(table)
+          index = table.indecies.first
+          index && index.segments.first.field.integer?
+        end
+
+        # Read short runs from random keys between the first and last key of
+        # the first index.  A start at or below the last key already read
+        # would re-read rows of the previous run, so it is skipped.
+        def read_runs(table, names)
+          index  = table.indecies.first
+          lead   = index.segments.first.field_name
+          column = names.index(lead)
+          record = new_record(table)
+          record.default_index = index.name
+
+          return if record.first.nil?
+          lo = record.get_field(lead)
+          record.last
+          hi = record.get_field(lead)
+
+          random = Random.new
+          runs   = ( @sample / RUN_LENGTH.to_f ).ceil
+          starts = Array.new(runs) { lo + random.rand(hi - lo + 1) }.sort
+
+          last = nil
+          starts.each do |start|
+            next if last && start <= last
+            record.clear
+            record.set_field(lead, start)
+            begin
+              record.find(CT::FIND_GE)
+            rescue CT::Error
+              next
+            end
+            batch = record.pluck(names, [ RUN_LENGTH, @sample - @rows ].min)
+            next if batch.empty?
+            add(batch, names)
+            last = names.size == 1 ? batch.last : batch.last[column]
+            progress
+            break if @rows >= @sample
+          end
+        end
+
+        def add(batch, names)
+          batch = batch.collect { |v| [ v ] } if names.size == 1
+
+          batch.each do |row|
+            row.each_with_index { |value, i| @fields[i].add(value) }
+            @key_columns.each_with_index do |columns, i|
+              @indexes[i].add(columns.size == 1 ? row[columns[0]] : row.values_at(*columns))
+            end
+            length = record_length(row)
+            @length_sum += length
+            @length_max  = length if length > @length_max
+          end
+
+          @rows += batch.size
+          if @rows >= @next_prune
+            @fields.each(&:prune)
+            @next_prune = @rows + 10_000
+          end
+        end
+
+        # Fixed part of the record and the length prefix of each variable
+        # length field.  Variable length records are measured from their
+        # values rather than read back per row.  Fixed length fields after
+        # the first variable length one count at full length.
+        def record_lengths(table, record)
+          fields   = table.fields
+          variable = fields.index(&:variable_length?)
+          prefixes = { CT::PSTRING => 1, CT::VARCHAR => 2, CT::VARBINARY => 2,
+                       CT::LVB => 4 }
+
+          fixed = if variable
+            record.field_offset(fields[variable].number) +
+              fields[variable..-1].reject(&:variable_length?).sum(&:length)
+          else
+            fields.sum(&:length)
+          end
+
+          columns = fields.each_with_index.select { |f, _| f.variable_length? }
+          [ fixed, columns.collect { |f, i| [ i, prefixes[f.type] ] } ]
+        end
+
+        def record_length(row)
+          fixed, columns = @lengths
+          columns.inject(fixed) do |length, (i, prefix)|
+            length + prefix + ( row[i].is_a?(String) ? row[i].bytesize : 0 )
+          end
+        end
+
+        def progress(final=false)
+          @progress.update(final) { "%12d rows" % @rows }
+        end
+
+        def report(table, count)
+          progress(true)
+          rows = [ @rows, 1 ].max
+
+          { table:   table.name,
+            records: count,
+            rows:    @rows,
+            record_length: { average: @length_sum / rows.to_f, max: @length_max },
+            indexes: @indexes.collect { |index|
+              distinct = [ index.distinct.count, 1 ].max
+              { name:            index.name,
+                fields:          index.fields,
+                allow_dups:      index.allow_dups,
+                distinct:        distinct,
+                rows_per_key:    @rows / distinct.to_f,
+                most_duplicated: index.most_duplicated.collect { |key, n, error|
+                  { key: key, count: n, error: error }
+                } }
+            },
+            fields: @fields.collect { |field|
+              { name:       field.name,
+                distinct:   field.distinct.count,
+                null_ratio: field.nulls / rows.to_f,
+                top_values: field.top && field.top.collect { |value, n|
+                  { value: value, count: n }
+                } }
+            } }
+        end
+
+    end
+  end
+end
@@ -1,9 +1,7 @@
 module CT
-  class Field
-  
-    def inspect
-      "<CT::Field:#{object_id} @name=\"#{self.name}\" @type=\"#{self.human_type}\">"
-    end
+  # Type predicates shared by CT::Field and CT::Schema::Field.  Includers
+  # must respond to #type.
+  module FieldTypes
 
     def string?
       self.type == CT::CHARS || self.type == CT::FPSTRING || 
@@ -33,6 +31,13 @@ module CT
       self.type == CT::DATE
     end
 
+    # Fields whose offset in the record buffer depends on the data before
+    # them.
+    def variable_length?
+      self.type == CT::PSTRING || self.type == CT::VARCHAR ||
+          self.type == CT::VARBINARY || self.type == CT::LVB
+    end
+
     def human_type
       case self.type
       when CT::BOOL       then "CT_BOOL" 
@@ -50,6 +55,7 @@ module CT
       when CT::TIMESTAMP  then "CT_TIMESTAMP"
       when CT::EFLOAT     then "CT_EFLOAT"
       when CT::CHARS      then "CT_CHARS"
+      when CT::BINARY     then "CT_BINARY"
       when CT::FPSTRING   then "CT_FPSTRING"
       when CT::F2STRING   then "CT_F2STRING"
       when CT::F4STRING   then "CT_F4STRING"
@@ -65,6 +71,15 @@ module CT
       end
     end
 
+  end
+
+  class Field
+    include FieldTypes
+  
+    def inspect
+      "<CT::Field:#{object_id} @name=\"#{self.name}\" @type=\"#{self.human_type}\">"
+    end
+
     def to_h
       { 
         name:   self.name, 
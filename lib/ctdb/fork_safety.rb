@@ -0,0 +1,26 @@
+module CT
+  # Forget every handle inherited from the parent process.  The child keeps
+  # the session configuration and the captured table schemas, and logs on
+  # lazily the first time a model needs a session.  Inherited sessions and
+  # tables are never logged out or closed by the child, so the parent's
+  # connections are left untouched.
+  #
+  # Called automatically in the child on Rubies that define Process._fork;
+  # call it by hand after a raw fork(2) on older Rubies.
+  def self.after_fork!
+    RactorLocal[:ct_session_pool] = nil
+    IdentityMap.current = nil
+  end
+
+  # Runs CT.after_fork! in the child of every fork, including forks made by
+  # preloading app servers.
+  module ForkTracker
+    def _fork
+      pid = super
+      CT.after_fork! if pid == 0
+      pid
+    end
+  end
+end
+
+Process.singleton_class.prepend(CT::ForkTracker) if Process.respond_to?(:_fork)
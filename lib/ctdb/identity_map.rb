@@ -0,0 +1,115 @@
+module CT
+  # Tracks every CT::Model loaded or saved within a unit of work so that a
+  # row is represented by a single object, and defers writes until the unit
+  # of work completes.  Maps are scoped to the current thread.
+  #
+  # @see CT::Model.unit_of_work
+  class IdentityMap
+
+    # @return [CT::IdentityMap, nil] The map for the current thread
+    def self.current
+      Thread.current[:ct_identity_map]
+    end
+
+    # @param [CT::IdentityMap, nil] map
+    def self.current=(map)
+      Thread.current[:ct_identity_map] = map
+    end
+
+    def initialize
+      @models    = {}
+      @keys      = {}.compare_by_identity
+      @pending   = {}.compare_by_identity
+      @destroyed = {}.compare_by_identity
+    end
+
+    # Build the map key for a model class and primary key values.
+    #
+    # @param [Class] klass CT::Model subclass
+    # @param [Array] values Primary index segment values
+    # @return [Array]
+    def key(klass, values)
+      [ klass.table_path, klass.table_name, values ]
+    end
+
+    # @param [Class] klass CT::Model subclass
+    # @param [Array] values Primary index segment values
+    # @return [CT::Model, nil] The loaded instance if any
+    def get(klass, values)
+      @models[key(klass, values)]
+    end
+
+    # Register a persisted model, replacing the entry for its old primary
+    # key if that changed.
+    #
+    # @param [CT::Model] model
+    def add(model)
+      old = @keys[model]
+      @models.delete(old) if old && @models[old].equal?(model)
+      new_key = key(model.class, model.primary_key_values)
+      @models[new_key] = model
+      @keys[model]     = new_key
+    end
+
+    # @param [CT::Model] model
+    def remove(model)
+      old = @keys.delete(model)
+      @models.delete(old) if old && @models[old].equal?(model)
+      @pending.delete(model)
+    end
+
+    # Queue a model to be written when the unit of work is flushed.
+    #
+    # @param [CT::Model] model
+    def track(model)
+      @pending[model] = true unless @destroyed.key?(model)
+    end
+
+    # Queue a model to be deleted when the unit of work is flushed.
+    #
+    # @param [CT::Model] model
+    def destroy(model)
+      remove(model)
+      @destroyed[model] = true
+    end
+
+    # @return [Array<CT::Model>] Models with unwritten changes
+    def dirty_models
+      models = @pending.keys + @models.values.reject { |m| @pending.key?(m) }
+      models.select { |m| !m.destroyed? && (m.new_record? || m.dirty?) }
+    end
+
+    # Write every dirty model and delete every destroyed one in a single
+    # transaction.  Models are only marked clean, persisted or destroyed
+    # once it commits, so after a failure they still carry their changes.
+    #
+    # @param [CT::SessionHandler] session
+    def flush(session)
+      models    = dirty_models
+      destroyed = @destroyed.keys
+      session.transaction do
+        models.each { |model| model.send(:write_record) }
+        destroyed.each { |model| model.send(:delete_record) }
+      end unless models.empty? && destroyed.empty?
+
+      models.each { |model| model.send(:mark_persisted) }
+      destroyed.each { |model| model.send(:mark_destroyed) }
+      @pending.clear
+      @destroyed.clear
+      models.each { |model| add(model) }
+    end
+
+    def clear
+      @models.clear
+      @keys.clear
+      @pending.clear
+      @destroyed.clear
+    end
+
+    # @return [Fixnum] Number of loaded models
+    def size
+      @models.size
+    end
+
+  end
+end
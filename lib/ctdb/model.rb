@@ -6,7 +6,7 @@ module CT
     module Querying
       extend Forwardable
 
-      def_delegators :query, :each, :all, :first, :last, :count
+      def_delegators :query, :each, :all, :first, :last, :count, :pluck, :sum
 
       # Helper method to quickly construt a Query object.
       # 
@@ -14,16 +14,33 @@ module CT
       # @see CT::Query
       def query(options={})
         qry = Query.new(table)
-        options[:transformer] ||= begin
-          lambda { |ct_record|
-            instance = allocate
-            instance.init_with(ct_record)
-            instance
-          }
-        end
+        options[:model] ||= self
+        options[:temporal_mode] ||= temporal_mode
+        options[:numeric_mode] ||= numeric_mode
+        options[:transformer] ||= lambda { |ct_record| instantiate(ct_record) }
         qry.merge(options)
       end
 
+      # Build a model from the given CT::Record or Hash of field values.
+      # Within a unit of work the already loaded instance for the row is
+      # returned instead.
+      #
+      # @param [CT::Record, Hash] ct_record
+      # @return [CT::Model]
+      def instantiate(ct_record)
+        map = IdentityMap.current
+        if map
+          values = primary_key_fields.collect { |f| ct_record[f] }
+          instance = map.get(self, values)
+          return instance if instance
+        end
+
+        instance = allocate
+        instance.init_with(ct_record)
+        map.add(instance) if map
+        instance
+      end
+
       # Retrieve a given record or set of records based on the given criteria.
       # 
       # @see CT::Query
@@ -41,31 +58,308 @@ module CT
       #
       # @return [CT::Model, nil, CT::Query] A model of set of models
       def find_by(index_name, segments={})
+        if IdentityMap.current && index_name.to_s == primary_index[:name]
+          values = primary_key_fields.collect do |f|
+            segments.key?(f) ? segments[f] : segments[f.to_sym]
+          end
+          unless values.include?(nil)
+            instance = IdentityMap.current.get(self, values)
+            return instance if instance
+          end
+        end
+
         _query = query.index(index_name).index_segments(segments)
-        table.get_index(index_name.to_s).allow_dups? ? _query : _query.eq
+        schema.index(index_name).allow_dups? ? _query : _query.eq
+      end
+
+      # Load models in batches of +batch_size+ without holding the whole
+      # table in memory.  Walks the primary index unless an index is given.
+      #
+      # @example Resume a job from the last processed key
+      #   Person.find_in_batches(batch_size: 500, start: { id: 9001 }) do |people|
+      #     people.each { |person| archive(person) }
+      #   end
+      #
+      # @param [Hash] options Query options plus :batch_size and :start
+      # @see CT::Query#find_in_batches
+      def find_in_batches(options={}, &block)
+        options, batch = split_batch_options(options)
+        query(options).find_in_batches(batch, &block)
+      end
+
+      # @see #find_in_batches
+      # @see CT::Query#find_each
+      def find_each(options={}, &block)
+        options, batch = split_batch_options(options)
+        query(options).find_each(batch, &block)
       end
 
+      private
+
+        # Separate the batch walk options from the query options.  Resuming
+        # from a key needs an index, so default to the primary index.
+        def split_batch_options(options)
+          options = options.dup
+          batch   = { batch_size: options.delete(:batch_size),
+                      start:      options.delete(:start) }
+          options[:index] ||= primary_index[:name] if batch[:start]
+          [ options, batch ]
+        end
+
     end
 
-    extend Querying 
+    module Associations
+
+      # Declare a reference to another model whose key is held in one of this
+      # model's fields.
+      #
+      # @example
+      #   class Order < CT::Model
+      #     belongs_to :customer, foreign_key: :customer_id
+      #   end
+      #
+      # @param [Symbol] name Association name
+      # @param [Hash] options
+      # @option options [String] :class_name Target model class, defaults to
+      #   the camelized association name.
+      # @option options [Symbol] :foreign_key (name_id) Field on this model
+      # @option options [Symbol] :index Target index whose first segment holds
+      #   the referenced key.  Defaults to the target primary index.
+      def belongs_to(name, options={})
+        name = name.to_s
+        add_association(name, {
+          macro:       :belongs_to,
+          name:        name,
+          class_name:  (options[:class_name] || camelize(name)).to_s,
+          foreign_key: (options[:foreign_key] || "#{name}_id").to_s,
+          index:       options[:index] && options[:index].to_s
+        })
+
+        class_eval <<-RUBY, __FILE__, __LINE__ + 1
+          def #{name}
+            association("#{name}")
+          end
+
+          def #{name}=(model)
+            reflection = self.class.associations["#{name}"]
+            key = model && model[self.class.association_key(reflection)]
+            write_attribute(reflection[:foreign_key], key)
+            association_cache["#{name}"] = model
+          end
+        RUBY
+      end
+
+      # Declare a collection of models that reference this model.
+      #
+      # @example
+      #   class Customer < CT::Model
+      #     has_many :orders, foreign_key: :customer_id, index: :customer_ndx
+      #   end
+      #
+      # @param [Symbol] name Association name
+      # @param [Hash] options
+      # @option options [String] :class_name Target model class, defaults to
+      #   the camelized association name without its trailing "s".
+      # @option options [Symbol] :foreign_key Field on the target model
+      # @option options [Symbol] :primary_key Field on this model referenced
+      #   by the foreign key.  Defaults to the first primary index segment.
+      # @option options [Symbol] :index Target index whose first segment is
+      #   the foreign key.
+      #
+      # @raise [ArgumentError] if :foreign_key or :index is missing
+      def has_many(name, options={})
+        unless options[:foreign_key] && options[:index]
+          raise ArgumentError.new("has_many requires :foreign_key and :index")
+        end
+
+        name = name.to_s
+        add_association(name, {
+          macro:       :has_many,
+          name:        name,
+          class_name:  (options[:class_name] || camelize(name.sub(/s\z/, ''))).to_s,
+          foreign_key: options[:foreign_key].to_s,
+          primary_key: options[:primary_key] && options[:primary_key].to_s,
+          index:       options[:index].to_s
+        })
+
+        class_eval <<-RUBY, __FILE__, __LINE__ + 1
+          def #{name}
+            association("#{name}")
+          end
+        RUBY
+      end
+
+      # @return [Hash] Association definitions keyed by name
+      def associations
+        @associations || {}
+      end
+
+      # Load the named associations for a collection of models.  Keys are
+      # collected from every model, de-duplicated and resolved in index
+      # order, so each association costs one batched lookup or one forward
+      # pass over the target index rather than one lookup per model.
+      #
+      # @example
+      #   orders = Order.all
+      #   Order.preload(orders, :customer)
+      #
+      # @param [Array<CT::Model>] models
+      # @param [Array<Symbol>] names Association names
+      # @return [Array<CT::Model>] models
+      #
+      # @raise [ArgumentError] if an association is not defined
+      def preload(models, *names)
+        models = Array(models).compact
+        return models if models.empty?
+
+        names.flatten.each do |name|
+          unless ( reflection = associations[name.to_s] )
+            raise ArgumentError.new("Unknown association `#{name}'")
+          end
+          send("preload_#{reflection[:macro]}", models, reflection)
+        end
+        models
+      end
+
+      # The target field referenced by a belongs_to association.
+      #
+      # @param [Hash] reflection
+      # @return [String]
+      def association_key(reflection)
+        klass = association_class(reflection)
+        index = reflection[:index] || klass.primary_index[:name]
+        klass.schema.index(index).field_names.first
+      end
 
-    @@session_handler = nil unless defined?(@@session_handler)
+      private
 
-    # Define CT::Session logon configuration
+        # Association definitions are frozen so they can be read from any
+        # Ractor.
+        def add_association(name, reflection)
+          @associations = RactorLocal.make_shareable(
+            associations.merge(name => reflection))
+        end
+
+        def association_class(reflection)
+          Object.const_get(reflection[:class_name])
+        end
+
+        def camelize(name)
+          name.split('_').collect(&:capitalize).join
+        end
+
+        # Resolve every distinct key with one batched CT::Record#find_many.
+        def preload_belongs_to(models, reflection)
+          klass = association_class(reflection)
+          field = association_key(reflection)
+          keys  = models.collect { |m| m[reflection[:foreign_key]] }
+          keys  = keys.compact.uniq
+
+          record = CT::Record.new(klass.table).clear
+          record.temporal_mode = klass.temporal_mode
+          record.numeric_mode  = klass.numeric_mode
+          rows   = record.find_many(keys.collect { |k| { field => k } },
+                     index: reflection[:index] || klass.primary_index[:name])
+
+          found = {}
+          keys.each_with_index do |key, i|
+            found[key] = klass.instantiate(rows[i]) if rows[i]
+          end
+
+          models.each do |m|
+            m.send(:association_cache)[reflection[:name]] = 
+              found[m[reflection[:foreign_key]]]
+          end
+        end
+
+        # Walk the target index forward through the keys in index order.  A
+        # seek is only issued when the walk has not already reached the next
+        # key.  The order follows the leading segment: descending segments
+        # walk high to low, case insensitive ones compare upcased strings and
+        # alternate collating sequences seek every key.
+        def preload_has_many(models, reflection)
+          klass   = association_class(reflection)
+          fk      = reflection[:foreign_key]
+          pk      = reflection[:primary_key] || primary_key_fields.first
+          segment = klass.schema.index(reflection[:index]).segments.first
+          keys    = models.collect { |m| m[pk] }.compact.uniq
+
+          normalize = if segment.uppercase?
+            ->(v) { v.is_a?(String) ? v.upcase : v }
+          else
+            ->(v) { v }
+          end
+          ordered = !segment.alternate_collation?
+          groups  = keys.group_by(&normalize)
+          targets = groups.keys
+          if ordered
+            targets.sort!
+            targets.reverse! if segment.descending?
+          end
+
+          record = CT::Record.new(klass.table).clear
+          record.default_index = reflection[:index]
+          record.temporal_mode = klass.temporal_mode
+          record.numeric_mode  = klass.numeric_mode
+
+          found = {}
+          value = nil # Foreign key at the current position
+          row   = nil # Normalized value, :eof when the walk is done
+          targets.each do |target|
+            break if ordered && row == :eof
+
+            behind = row.nil? || row == :eof ||
+                     ( segment.descending? ? row > target : row < target )
+            if !ordered || behind
+              record.clear
+              record.set_field(fk, groups[target].first)
+              row = begin
+                record.find(CT::FIND_GE)
+                normalize.call(value = record.get_field(fk))
+              rescue CT::Error
+                :eof
+              end
+            end
+
+            while row == target
+              if groups[target].include?(value)
+                (found[value] ||= []) << klass.instantiate(record)
+              end
+              row = record.next ? normalize.call(value = record.get_field(fk)) : :eof
+            end
+          end
+
+          models.each do |m|
+            m.send(:association_cache)[reflection[:name]] = found[m[pk]] || []
+          end
+        end
+
+    end
+
+    extend Querying 
+    extend Associations
+
+    # Define CT::Session logon configuration.  Sessions are pooled, each
+    # thread checks out its own session on first use.  The configuration is
+    # frozen and shared, while every Ractor builds its own CT::SessionPool,
+    # so configure sessions from the main Ractor before starting others.
     # 
     # @param [Hash] hash Configuration definition
     # 
     # @see CT::Session#new
     # @see CT::Session#logon
+    # @see CT::SessionPool#initialize
     # 
     # @example
     #   CT::Model.session = { 
     #     username: "",  
     #     password: "", 
     #     engine:   "FairComs",
-    #     mode:     CT::SESSION_CTREE 
+    #     mode:     CT::SESSION_CTREE,
+    #     pool:     10
     #   }
     def self.session=(hash) # TODO: , scope=:default)
+      hash = hash.dup
       hash.symbolize_keys!
       vars = [:engine, :username, :password, :mode]
       unless vars.all? { |k| hash.key?(k) }
@@ -73,16 +367,72 @@ module CT
                             vars.join(', '))
       end
 
-      _session = CT::Session.new(hash[:mode])
-      _session.logon(hash[:engine], hash[:username], hash[:password])
-      @@session_handler = CT::SessionHandler.new(_session)
+      RactorLocal[:ct_session_pool].disconnect! if RactorLocal[:ct_session_pool]
+      RactorLocal[:ct_session_pool] = nil
+      CT::Model.instance_variable_set(:@session_config, 
+                                      RactorLocal.make_shareable(hash))
     end
 
-    # Access the current +CT::SessionHandler+
+    # @return [Hash, nil] The frozen CT::Session logon configuration
+    def self.session_config
+      CT::Model.instance_variable_get(:@session_config)
+    end
+
+    # Access the +CT::SessionHandler+ checked out by the current thread
     #
-    # @return [CT::SessionHandler]
+    # @return [CT::SessionHandler, nil]
     def self.session# TODO: (scope=:default)
-      @@session_handler
+      pool = session_pool
+      pool && pool.current
+    end
+
+    # Give the session held by the current thread (or fiber) back to the
+    # pool.  Models check a session out on first use and keep it, so call
+    # this when a request or job finishes; CT::ReleaseSession does it for
+    # Rack apps.  The next model call checks a session out again.
+    #
+    # @example
+    #   Rails.application.executor.to_complete { CT::Model.release_session }
+    def self.release_session
+      pool = RactorLocal[:ct_session_pool]
+      pool.release if pool
+    end
+
+    # The session pool of the current Ractor, created on first use.
+    #
+    # @return [CT::SessionPool, nil]
+    def self.session_pool
+      RactorLocal[:ct_session_pool] ||= begin
+        config = session_config
+        config && CT::SessionPool.new(config)
+      end
+    end
+
+    # Run the block as a unit of work.  Every row loaded inside the block is
+    # represented by a single model instance, +save+ is deferred, and all
+    # dirty models are written in one transaction when the block returns.
+    # Nothing is written if the block raises.  Nested calls join the
+    # enclosing unit of work.
+    #
+    # @example
+    #   Person.unit_of_work do
+    #     a = Person.find_by(:id_ndx, id: 1)
+    #     b = Person.find(index: :email_ndx).index_segments(email: e).eq
+    #     a.equal?(b) # => true when both are the same row
+    #     a.name = "Bob"
+    #   end # a is written here
+    #
+    # @yield [map] The CT::IdentityMap for the unit of work
+    # @return [Object] The block result
+    def self.unit_of_work
+      return yield(IdentityMap.current) if IdentityMap.current
+
+      map = IdentityMap.current = IdentityMap.new
+      result = yield map
+      map.flush(session)
+      result
+    ensure
+      IdentityMap.current = nil if map
     end
 
     # Set the table name
@@ -92,7 +442,9 @@ module CT
     #
     # @param [Symbol, #to_s] value The table name
     def self.table_name=(value)
-      @table_name = value && value.to_s
+      @table_name = value && value.to_s.freeze
+      @table_slot = next_table_slot
+      @schema = @primary_key_fields = @schema_verified = nil
     end
 
     # Get the table name
@@ -109,7 +461,9 @@ module CT
     #
     # @param [String] value
     def self.table_path=(value)
-      @table_path = value && value.to_s
+      @table_path = value && value.to_s.freeze
+      @table_slot = next_table_slot
+      @schema = @primary_key_fields = @schema_verified = nil
     end
 
     # Get the table path
@@ -119,6 +473,46 @@ module CT
       @table_path
     end
 
+    # Set how date and time attributes are read.  Subclasses inherit the
+    # setting of CT::Model.
+    #
+    # @example Read DATE fields as ::Date
+    #   self.temporal_mode = :core
+    #
+    # @param [Symbol] mode :ct (default), :core or :epoch
+    # @see CT::Record#temporal_mode=
+    def self.temporal_mode=(mode)
+      unless [ :ct, :core, :epoch ].include?(mode)
+        raise ArgumentError.new("Unknown temporal mode `#{mode}'")
+      end
+      @temporal_mode = mode
+    end
+
+    # @return [Symbol] :ct, :core or :epoch
+    def self.temporal_mode
+      @temporal_mode || ( self == CT::Model ? :ct : superclass.temporal_mode )
+    end
+
+    # Set how NUMBER, MONEY and CURRENCY attributes are read.  Subclasses
+    # inherit the setting of CT::Model.
+    #
+    # @example Read money fields as BigDecimal
+    #   self.numeric_mode = :decimal
+    #
+    # @param [Symbol] mode :float (default), :decimal or :scaled
+    # @see CT::Record#numeric_mode=
+    def self.numeric_mode=(mode)
+      unless [ :float, :decimal, :scaled ].include?(mode)
+        raise ArgumentError.new("Unknown numeric mode `#{mode}'")
+      end
+      @numeric_mode = mode
+    end
+
+    # @return [Symbol] :float, :decimal or :scaled
+    def self.numeric_mode
+      @numeric_mode || ( self == CT::Model ? :float : superclass.numeric_mode )
+    end
+
     # Set the +Model+ primary index.  Takes an optional hash of options.
     #
     # @example Define a primary index
@@ -139,13 +533,101 @@ module CT
     def self.primary_index=(*args)
       args = args.shift
       index_name, opts = ( args.is_a?(Array) ? args : [ args, {} ] )
-      @primary_index             = {}
-      @primary_index[:name]      = index_name && index_name.to_s
-      @primary_index[:increment] = opts[:increment] ? opts[:increment].to_s : nil
+      @primary_index = RactorLocal.make_shareable({
+        name:      index_name && index_name.to_s,
+        increment: opts[:increment] ? opts[:increment].to_s : nil
+      })
+      @primary_key_fields = nil
     end
 
     def self.primary_index
-      @primary_index ||= { name: table.default_index.name, increment: nil }
+      class_cache(:@primary_index) do
+        { name: schema.default_index.name, increment: nil }
+      end
+    end
+
+    # @return [Array<String>] Field names of the primary index segments
+    def self.primary_key_fields
+      class_cache(:@primary_key_fields) do
+        schema.index(primary_index[:name]).field_names
+      end
+    end
+
+    # Load schema snapshots written by `ctdb compile_schema` (or YAML from
+    # `ctdb dump_schema`) so models answer attribute, primary index and
+    # query planning questions at boot without opening their tables.  Each
+    # model's snapshot is checked against the live table the first time it
+    # is opened.  Subclasses inherit the snapshots of CT::Model.
+    #
+    # @example
+    #   CT::Model.schema_snapshot = "config/schema.bin"
+    #
+    # @param [String, nil] path nil to go back to live metadata
+    # @raise [ArgumentError] on an unknown type or segment mode
+    def self.schema_snapshot=(path)
+      @schema_snapshot = path && RactorLocal.make_shareable(CT::Schema.load(path))
+      ( [ self ] + @@models ).each do |model|
+        next unless model <= self
+        model.instance_variable_set(:@schema, nil)
+        model.instance_variable_set(:@primary_key_fields, nil)
+        model.instance_variable_set(:@schema_verified, nil)
+      end
+    end
+
+    # @return [Array<CT::Schema>, nil]
+    def self.schema_snapshot
+      @schema_snapshot || ( self == CT::Model ? nil : superclass.schema_snapshot )
+    end
+
+    # Field and index metadata for the model's table, from the schema
+    # snapshot when it has the table, otherwise captured once and reused
+    # without further server calls.
+    #
+    # @return [CT::Schema]
+    def self.schema
+      class_cache(:@schema) { snapshot_schema || CT::Schema.capture(table) }
+    end
+
+    # Open the tables and capture the metadata of the given models, or of
+    # every model with a table name, in parallel.  Call it at boot (before
+    # forking workers) so the first requests skip metadata lookups.  Tables
+    # stay open on the pooled sessions used to load them.
+    #
+    # @example
+    #   CT::Model.preload!
+    #   CT::Model.preload!(Person, Order, threads: 2)
+    #
+    # @param [Array<Class>] models
+    # @param [Hash] options
+    # @option options [Fixnum] :threads Defaults to the session pool size
+    # @return [Array<Class>] The models loaded
+    def self.preload!(*models)
+      options = models.last.is_a?(Hash) ? models.pop : {}
+      models  = @@models.select(&:table_name) if models.empty?
+      queue   = Queue.new
+      models.each { |model| queue << model }
+
+      threads = options[:threads] || session_pool.size
+      errors  = Queue.new
+      [ threads, models.size ].min.times.collect {
+        Thread.new do
+          session_pool.with_session do |handler|
+            while ( model = (queue.pop(true) rescue nil) )
+              begin
+                table = handler.open_slot(model.table_slot, model.table_path,
+                                          model.table_name)
+                model.send(:verify_schema, table)
+                model.schema
+              rescue CT::Error, CT::SchemaMismatch => e
+                errors << e
+              end
+            end
+          end
+        end
+      }.each(&:join)
+
+      raise errors.pop unless errors.empty?
+      models
     end
 
     # Aquire the current sessions table handle for this model
@@ -154,12 +636,86 @@ module CT
     # 
     # @raise [CT::Error] if the CT::Model#session has not been defined
     def self.table
-      if session.nil?
+      if ( handler = session ).nil?
         raise CT::Error.new("[4003] No session handle.  You must define a " + 
                             "CT::Model#session with CT::Model.session={}")
       end
-      session.open_table(table_path, table_name)
+      table = handler.slots[table_slot]
+      return table if table && table.active?
+      table = handler.open_slot(table_slot, table_path, table_name)
+      begin
+        verify_schema(table)
+      rescue CT::SchemaMismatch
+        # Leave the slot empty so every use raises until the snapshot is fixed.
+        handler.slots[table_slot] = nil
+        raise
+      end
+      table
+    end
+
+    # This model's table in the schema snapshot, matched by name and, when
+    # several tables share it, by path.
+    #
+    # @return [CT::Schema, nil]
+    def self.snapshot_schema
+      return nil unless ( snapshot = schema_snapshot ) && table_name
+      matches = snapshot.select { |s| s.table_name == table_name }
+      matches.find { |s| s.table_path == table_path.to_s } || matches.first
+    end
+    private_class_method :snapshot_schema
+
+    # Compare a snapshot schema with the live table, once per model.
+    #
+    # @raise [CT::SchemaMismatch] if they disagree
+    def self.verify_schema(table)
+      return if @schema_verified
+      schema = snapshot_schema or return
+
+      diffs = schema.diff(CT::Schema.capture(table))
+      unless diffs.empty?
+        raise CT::SchemaMismatch.new("Schema snapshot of `#{table_name}' " +
+                                     "is out of date: #{diffs.join('; ')}")
+      end
+      @schema_verified = true if RactorLocal.main?
     end
+    private_class_method :verify_schema
+
+    @@table_slots = 0 unless defined?(@@table_slots)
+    @@table_slots_lock = Mutex.new unless defined?(@@table_slots_lock)
+
+    # Index of this model's table handle in CT::SessionHandler#slots.  A slot
+    # is taken when the model is defined and again whenever the table name or
+    # path changes.
+    #
+    # @return [Fixnum]
+    def self.table_slot
+      @table_slot
+    end
+
+    def self.next_table_slot
+      @@table_slots_lock.synchronize { (@@table_slots += 1) - 1 }
+    end
+    private_class_method :next_table_slot
+
+    @@models = [] unless defined?(@@models)
+
+    def self.inherited(subclass)
+      super
+      subclass.instance_variable_set(:@table_slot, next_table_slot)
+      @@models << subclass
+    end
+
+    # Memoize a class level value.  Values are frozen so other Ractors can
+    # read them, and only the main Ractor may set class instance variables.
+    def self.class_cache(name)
+      value = instance_variable_get(name)
+      return value unless value.nil?
+
+      value = RactorLocal.make_shareable(yield)
+      instance_variable_set(name, value) if RactorLocal.main?
+      value
+    end
+    private_class_method :class_cache
 
     # @!group Persistence
 
@@ -217,21 +773,30 @@ module CT
     end
     alias :changed? :dirty?
 
+    # Write the model to the table.  Within a unit of work the write is
+    # deferred until the unit of work is flushed.
+    #
+    # @see CT::Model.unit_of_work
     def save
-      result = new_record? ? create_record : update_record
-      result != false
+      if IdentityMap.current
+        IdentityMap.current.track(self)
+        return true
+      end
+      persist
     end
 
+    # Delete the model's row.  Within a unit of work the delete is deferred
+    # until the unit of work is flushed, and #destroyed? stays false until
+    # then.
+    #
+    # @see CT::Model.unit_of_work
     def destroy
-      if persisted?
-        record = Query.new(table) 
-                      .index(primary_index[:name]) 
-                      .index_segments(primary_index_segments)
-                      .eq
-
-        record.delete! unless record.nil?
+      if IdentityMap.current
+        IdentityMap.current.destroy(self)
+        return true
       end
-      @destroyed = true
+      delete_record
+      mark_destroyed
     end
 
     # @!endgroup
@@ -258,14 +823,15 @@ module CT
       yield self if block_given?
     end
 
-    # Initialize a new object based on the given CT::Record.
+    # Initialize a new object based on the given CT::Record or Hash of field
+    # values.
     # 
-    # @param [CT::Record] ct_record
+    # @param [CT::Record, Hash] ct_record
     def init_with(ct_record)
       initialize_internals
       initialize_attributes
       @attributes.keys.each do |field_name|
-        write_attribute(field_name, ct_record.get_field(field_name))
+        write_attribute(field_name, ct_record[field_name])
       end
       @dirty_attributes = {}
     end
@@ -280,6 +846,21 @@ module CT
       self.class.primary_index
     end
 
+    # Read an association, loading it on first access.
+    #
+    # @param [Symbol, #to_s] name Association name
+    # @return [CT::Model, Array<CT::Model>, nil]
+    def association(name)
+      name = name.to_s
+      self.class.preload([self], name) unless association_cache.key?(name)
+      association_cache[name]
+    end
+
+    # @return [Array] Values of the primary index segments
+    def primary_key_values
+      self.class.primary_key_fields.collect { |f| read_attribute(f) }
+    end
+
     # Retrieve a collection of defined attribute names
     # 
     # @return [Array]
@@ -369,36 +950,81 @@ module CT
         @attributes = {}
         @dirty_attributes = {}
         @destroyed = false
+        @association_cache = {}
+      end
+
+      def association_cache
+        @association_cache ||= {}
       end
 
       def initialize_attributes
-        table.get_fields.each do |field|
-          @attributes[field.name] = nil 
-          self.class.class_eval do
-            define_method(field.name) do
-              read_attribute(field.name)
-            end
-            define_method("#{field.name}=") do |value|
-              write_attribute(field.name, value)
-            end
-          end
+        self.class.schema.field_names.each do |name|
+          @attributes[name] = nil 
+          define_attribute_methods(name)
         end
       end
 
+      # Define reader and writer methods for a field once per class.  The
+      # methods are compiled from source rather than closures so they can be
+      # called from any Ractor.
+      def define_attribute_methods(name)
+        return unless name =~ /\A[A-Za-z_]\w*\z/
+        return if self.class.method_defined?(name, false)
+
+        self.class.class_eval <<-RUBY, __FILE__, __LINE__ + 1
+          def #{name}
+            read_attribute("#{name}")
+          end
+
+          def #{name}=(value)
+            write_attribute("#{name}", value)
+          end
+        RUBY
+      end
+
       # Populate a Hash of field => value for each segment of the primary index
       # 
       # @return [Hash]
       def primary_index_segments
-        table.get_index(primary_index[:name]).segments.inject({}) do |h, s|
-          v = read_attribute(s.field_name)
-          h[s.field_name] = v unless v.nil?
+        self.class.primary_key_fields.inject({}) do |h, name|
+          v = read_attribute(name)
+          h[name] = v unless v.nil?
           h
         end
       end
 
+      def persist
+        result = write_record
+        mark_persisted unless result == false
+        result != false
+      end
+
+      # Insert or update the row without touching the model's state flags.
+      def write_record
+        new_record? ? create_record : update_record
+      end
+
+      def mark_persisted
+        @new_record, @dirty_attributes = false, {}
+      end
+
+      def delete_record
+        return unless persisted?
+        record = Query.new(table)
+                      .index(primary_index[:name])
+                      .index_segments(primary_index_segments)
+                      .eq
+
+        record.delete! unless record.nil?
+      end
+
+      def mark_destroyed
+        @destroyed = true
+      end
+
       def create_record
         if primary_index[:increment] && 
-           ( field = table.get_field(primary_index[:increment]) ) &&
+           ( field = self.class.schema.field(primary_index[:increment]) ) &&
            @attributes[field.name].nil?
 
           last_record = Query.new(table)
@@ -422,8 +1048,6 @@ module CT
           record.set_field(field_name, value)
         end
         record.write!
-
-        @dirty_attributes, @new_record = {}, false
         return true
       end
 
@@ -443,8 +1067,6 @@ module CT
           end
           record.write!
         end
-
-        @new_record, @dirty_attributes = false, {}
         return true
       end
 
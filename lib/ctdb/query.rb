@@ -66,7 +66,11 @@ module CT
              :fields,
              :filter,
              :endif,
-             :transformer ].freeze
+             :transformer,
+             :model,
+             :preload,
+             :temporal_mode,
+             :numeric_mode ].freeze
 
 
     # @!attribute [r] table 
@@ -87,6 +91,13 @@ module CT
     # @option opts [Fixnum] :offset
     # @option opts [String] :filter
     # @option opts [Proc] :transformer
+    # @option opts [Class] :model CT::Model class the query belongs to
+    # @option opts [Array<Symbol>] :preload Associations to load for #all and
+    #   #find_in_batches
+    # @option opts [Symbol] :temporal_mode How date and time fields are read,
+    #   see CT::Record#temporal_mode=
+    # @option opts [Symbol] :numeric_mode How NUMBER, MONEY and CURRENCY
+    #   fields are read, see CT::Record#numeric_mode=
     def initialize(table, options={})
       @table   = table
       @record  = CT::Record.new(@table).clear
@@ -128,9 +139,7 @@ module CT
       
       bytes = 0
       options[:index_segments].each do |field, value|
-        segment = default_index.get_segment(field.to_s)
-        bytes += segment.field.length
-        bytes -= 1 if segment.absolute_byte_offset?
+        bytes += segment_length(field.to_s)
       end if options[:index_segments]
       
       set_on(bytes)
@@ -201,6 +210,90 @@ module CT
     def all
       [].tap do |objects|
         each { |obj| objects << obj } 
+        preload_associations(objects)
+      end
+    end
+
+    # Read raw field values for every matching row without instantiating a
+    # CT::Model or CT::Record per row.  The walk happens in C.
+    #
+    # @example
+    #   Person.find(index: :age_ndx).pluck(:id)   # => [1, 2, 3]
+    #   Person.find.pluck(:id, :name)             # => [[1, "Bob"], ...]
+    #
+    # @param [Array<Symbol, String>] names Field names
+    # @return [Array] Arrays of values per row, or a flat Array for a single
+    #   field.
+    def pluck(*names)
+      unless record_set?
+        prepare
+        return [] if @record.first.nil?
+      end
+
+      @record.pluck(names.flatten, options[:limit])
+    end
+
+    # Add up a numeric field over every matching row.  The walk happens in C
+    # and fixed point fields are summed exactly, see CT::Record#sum.
+    #
+    # @example
+    #   Invoice.find.numeric_mode(:decimal).sum(:total) # => 0.123456e4
+    #
+    # @param [Symbol, String] name Field name
+    # @return [Integer, Float, BigDecimal]
+    def sum(name)
+      unless record_set?
+        prepare
+        return @record.sum(name, 0) if @record.first.nil?
+      end
+
+      @record.sum(name, options[:limit])
+    end
+
+    # Walk the query in index order, yielding the transformed records in
+    # arrays of at most +batch_size+.  One record handle is reused for the
+    # whole walk and each batch is dropped once the block returns, so memory
+    # is bounded by the batch size rather than the table size.  Without a
+    # transformer every element is the shared CT::Record handle, so use
+    # #find_each for raw record walks.
+    #
+    # @example Resume an interrupted job
+    #   query.index(:pk).find_in_batches(start: { id: 5001 }) { |batch| }
+    #
+    # @param [Hash] opts
+    # @option opts [Fixnum] :batch_size (1000) Maximum records per batch.
+    # @option opts [Hash] :start Index segment values to resume from.  The
+    #   walk begins at the first key greater than or equal to the start key.
+    # @yield [batch] Array of transformed records.
+    # @return [Enumerator] if no block is given.
+    # @raise [CT::InvalidQuery] if :start is given without an index.
+    def find_in_batches(opts={})
+      return to_enum(:find_in_batches, opts) unless block_given?
+
+      batch_size = opts[:batch_size] || 1000
+      return nil unless start_at(opts[:start])
+
+      batch = []
+      begin
+        batch << cursor
+        if batch.size >= batch_size
+          yield preload_associations(batch)
+          batch = []
+        end
+      end while next_record
+
+      yield preload_associations(batch) unless batch.empty?
+      nil
+    end
+
+    # Yield each transformed record while only holding one batch in memory.
+    #
+    # @see #find_in_batches
+    def find_each(opts={})
+      return to_enum(:find_each, opts) unless block_given?
+
+      find_in_batches(opts) do |batch|
+        batch.each { |obj| yield obj }
       end
     end
 
@@ -243,6 +336,26 @@ module CT
       self
     end
 
+    # @example
+    #   Event.find.temporal_mode(:core).pluck(:at) # => [#<DateTime ...>]
+    #
+    # @param [Symbol] mode :ct, :core or :epoch
+    # @see CT::Record#temporal_mode=
+    def temporal_mode(mode)
+      options[:temporal_mode] = mode
+      self
+    end
+
+    # @example
+    #   Invoice.find.numeric_mode(:scaled).pluck(:total) # => [123456, ...]
+    #
+    # @param [Symbol] mode :float, :decimal or :scaled
+    # @see CT::Record#numeric_mode=
+    def numeric_mode(mode)
+      options[:numeric_mode] = mode
+      self
+    end
+
     # @param [String, Hash] expression Query filter expression
     def filter(expression)
       options[:filter] = expression
@@ -253,6 +366,15 @@ module CT
       options[:endif] = criteria
       self
     end
+
+    # @example
+    #   Order.find.preload(:customer).all
+    #
+    # @param [Array<Symbol>] names Association names
+    def preload(*names)
+      options[:preload] = names.flatten
+      self
+    end
     
     # @!endgroup
 
@@ -273,6 +395,8 @@ module CT
 
     def prepare
       self.default_index = options[:index].to_s if options[:index]
+      record.temporal_mode = options[:temporal_mode] if options[:temporal_mode]
+      record.numeric_mode = options[:numeric_mode] if options[:numeric_mode]
 
       if options[:index_segments]
         options[:index_segments].each do |field, value|
@@ -289,6 +413,72 @@ module CT
 
     private
 
+      # Load the requested associations for a set of models.
+      #
+      # @param [Array<CT::Model>] objects
+      # @return [Array<CT::Model>] objects
+      def preload_associations(objects)
+        if options[:preload] && options[:model] && !objects.empty?
+          options[:model].preload(objects, options[:preload])
+        end
+        objects
+      end
+
+      # Position the record on the first row of a batched walk.
+      #
+      # @param [Hash, nil] start Index segment values to resume from.
+      # @return [Boolean] false if there is nothing to walk.
+      def start_at(start)
+        if start
+          unless options[:index]
+            raise InvalidQuery.new("You must define an index to resume " +
+                                   "from a key.")
+          end
+          prepare
+          start.each { |field, value| set_field(field.to_s, value) }
+          begin
+            find(CT::FIND_GE)
+          rescue CT::Error
+            return false
+          end
+          true
+        elsif record_set?
+          true
+        else
+          prepare
+          !@record.first.nil?
+        end
+      end
+
+      # The model's schema for the query index, so planning needs no
+      # metadata calls once the schema is loaded.
+      #
+      # @return [CT::Schema::Index, nil]
+      def planned_index
+        return nil unless options[:model] && options[:index]
+        options[:model].schema.index(options[:index])
+      end
+
+      def has_segment?(field_name)
+        if ( index = planned_index )
+          !index.segment(field_name).nil?
+        else
+          !@record.default_index.get_segment(field_name).nil?
+        end
+      end
+
+      # Bytes of the key covered by the segment on +field_name+.
+      def segment_length(field_name)
+        if ( index = planned_index )
+          segment = index.segment(field_name)
+          length  = options[:model].schema.field(field_name).length
+        else
+          segment = default_index.get_segment(field_name)
+          length  = segment.field.length
+        end
+        segment.absolute_byte_offset? ? length - 1 : length
+      end
+
       def validate!
         return unless @options.key?(:index_segments) && @options[:index_segments]
         
@@ -300,9 +490,7 @@ module CT
         
         # Make sure the supplied index segments actual exist for the given
         # index.
-        unless @options[:index_segments].all? { |k,_|
-          !@record.default_index.get_segment(k.to_s).nil? 
-        }
+        unless @options[:index_segments].all? { |k,_| has_segment?(k.to_s) }
           raise InvalidQuery.new("Index segments supplied are out of the " +
                                  "scope of `#{@options[:index]}'")
         end
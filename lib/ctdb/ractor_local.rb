@@ -0,0 +1,39 @@
+module CT
+  # Storage that is local to the current Ractor.  Handles (sessions, tables
+  # and records) can not cross Ractors, so anything holding them lives here
+  # while configuration is kept frozen and shareable.  On Rubies without
+  # Ractors there is a single store.
+  module RactorLocal
+
+    STORE = {} unless defined?(Ractor)
+
+    # @return [Boolean] True if running in the main Ractor
+    def self.main?
+      !defined?(Ractor) || Ractor.current == Ractor.main
+    end
+
+    # @param [Symbol] key
+    def self.[](key)
+      defined?(Ractor) ? Ractor.current[key] : STORE[key]
+    end
+
+    # @param [Symbol] key
+    # @param [Object] value
+    def self.[]=(key, value)
+      if defined?(Ractor)
+        Ractor.current[key] = value
+      else
+        STORE[key] = value
+      end
+    end
+
+    # Deep freeze an object so it can be read from any Ractor.
+    #
+    # @param [Object] obj
+    # @return [Object] obj
+    def self.make_shareable(obj)
+      defined?(Ractor) ? Ractor.make_shareable(obj) : obj.freeze
+    end
+
+  end
+end
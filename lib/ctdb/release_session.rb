@@ -0,0 +1,23 @@
+module CT
+  # Rack middleware that gives the request's session back to the pool when
+  # the app returns, so threads of a server larger than the pool do not
+  # hold sessions between requests.  Bodies streamed after the app returns
+  # check a session out again if they touch a model.
+  #
+  # @example config.ru
+  #   use CT::ReleaseSession
+  #   run App
+  class ReleaseSession
+
+    def initialize(app)
+      @app = app
+    end
+
+    def call(env)
+      @app.call(env)
+    ensure
+      CT::Model.release_session
+    end
+
+  end
+end
@@ -0,0 +1,277 @@
+module CT
+  # A frozen snapshot of a table's fields, indexes and segments.  Snapshots
+  # are plain Ruby data, so once captured they answer metadata questions
+  # without server calls, survive fork and can be shared between Ractors.
+  #
+  # @example
+  #   schema = CT::Schema.capture(table)
+  #   schema.field_names             # => ["id", "name"]
+  #   schema.index("id_ndx").field_names # => ["id"]
+  #
+  # Snapshots can also be written ahead of time, from schemas dumped with
+  # `ctdb dump_schema`, and loaded at boot with CT::Schema.load.
+  #
+  # @example
+  #   CT::Schema.compile(CT::Schema.load("orders.yml"), "schema.bin")
+  #   CT::Schema.load("schema.bin") # => [#<CT::Schema ...>]
+  class Schema
+
+    # Leads a compiled snapshot file.
+    MAGIC = "CTSCHEMA1\n".b.freeze
+
+    Field = Struct.new(:name, :number, :type, :length, :scale, :precision) do
+      include FieldTypes
+    end
+
+    Segment = Struct.new(:number, :field_name, :mode) do
+      # @return [Boolean] Keys are stored high to low
+      def descending?
+        mode & CT::SEG_DESCENDING != 0
+      end
+
+      # @return [Boolean] Keys follow an alternate collating sequence, in an
+      #   order Ruby cannot reproduce
+      def alternate_collation?
+        mode & CT::SEG_ALTSEG != 0
+      end
+
+      # @return [Boolean] Strings are compared case insensitively
+      def uppercase?
+        [ CT::SEG_USCHSEG, CT::SEG_UVSCHSEG, CT::SEG_UVARSEG,
+          CT::SEG_UREGSEG ].include?(mode & ~( CT::SEG_DESCENDING | CT::SEG_ALTSEG ))
+      end
+
+      # @see CT::Segment#absolute_byte_offset?
+      def absolute_byte_offset?
+        [ CT::SEG_REGSEG, CT::SEG_UREGSEG, CT::SEG_INTSEG, CT::SEG_SGNSEG,
+          CT::SEG_FLTSEG ].include?(mode)
+      end
+    end
+
+    Index = Struct.new(:name, :number, :allow_dups, :key_length, :segments) do
+      def allow_dups?
+        allow_dups
+      end
+
+      # @return [Array<String>]
+      def field_names
+        segments.collect(&:field_name)
+      end
+
+      # @param [String, #to_s] field_name
+      # @return [CT::Schema::Segment, nil]
+      def segment(field_name)
+        segments.find { |s| s.field_name == field_name.to_s }
+      end
+    end
+
+    # @!attribute [r] table_path
+    #   @return [String]
+    attr_reader :table_path
+    # @!attribute [r] table_name
+    #   @return [String]
+    attr_reader :table_name
+    # @!attribute [r] fields
+    #   @return [Array<CT::Schema::Field>] Fields in record order
+    attr_reader :fields
+    # @!attribute [r] indexes
+    #   @return [Array<CT::Schema::Index>] Indexes in index number order
+    attr_reader :indexes
+    # @!attribute [r] field_names
+    #   @return [Array<String>] Field names in record order
+    attr_reader :field_names
+    # @!attribute [r] index_names
+    #   @return [Array<String>] Index names in index number order
+    attr_reader :index_names
+
+    # Read the metadata of an open table.
+    #
+    # @param [CT::Table] table
+    # @return [CT::Schema]
+    def self.capture(table)
+      fields = table.get_fields.collect do |f|
+        Field.new(f.name, f.number, f.type, f.length, f.scale, f.precision)
+      end
+
+      indexes = table.indecies.each_with_index.collect do |index, n|
+        segments = index.segments.collect do |s|
+          Segment.new(s.number, s.field_name, s.mode)
+        end
+        Index.new(index.name, n, index.allow_dups?, index.key_length, segments)
+      end
+
+      new(table.path, table.name, fields, indexes)
+    end
+
+    # Read snapshots from a file written by CT::Schema.compile, or from YAML
+    # in the `ctdb dump_schema` format.  A YAML file holds one schema or a
+    # list of them.
+    #
+    # @param [String] path
+    # @return [Array<CT::Schema>]
+    def self.load(path)
+      data = File.binread(path)
+      if data.start_with?(MAGIC)
+        Marshal.load(data.byteslice(MAGIC.bytesize..-1)).collect { |h| from_h(h) }
+      else
+        require 'yaml'
+        docs = YAML.safe_load(data)
+        ( docs.is_a?(Array) ? docs : [ docs ] ).collect { |doc| from_yaml(doc) }
+      end
+    end
+
+    # Write snapshots to a compiled file.  It holds nothing but Strings,
+    # Integers, booleans, Arrays and Hashes, so loading it is a single
+    # Marshal.load with no YAML parsing or constant lookups.
+    #
+    # @param [Array<CT::Schema>] schemas
+    # @param [String] path
+    # @return [String] path
+    def self.compile(schemas, path)
+      File.open("#{path}.tmp", 'wb') do |io|
+        io.write(MAGIC)
+        io.write(Marshal.dump(schemas.collect(&:to_h)))
+      end
+      File.rename("#{path}.tmp", path)
+      path
+    end
+
+    # @param [Hash] h As returned by #to_h
+    # @return [CT::Schema]
+    def self.from_h(h)
+      fields = h[:fields].collect do |f|
+        Field.new(*f.values_at(:name, :number, :type, :length, :scale, :precision))
+      end
+      indexes = h[:indexes].collect do |i|
+        segments = i[:segments].collect do |s|
+          Segment.new(*s.values_at(:number, :field_name, :mode))
+        end
+        Index.new(i[:name], i[:number], i[:allow_dups], i[:key_length], segments)
+      end
+      new(h[:table_path], h[:table_name], fields, indexes)
+    end
+
+    # @param [Hash] doc One `ctdb dump_schema` document
+    # @return [CT::Schema]
+    def self.from_yaml(doc)
+      fields = doc.fetch('fields').each_with_index.collect do |f, n|
+        Field.new(f['name'].to_s, f['number'] || n, constant(f['type'], ''),
+                  f['length'], f['scale'], f['precision'])
+      end
+
+      indexes = ( doc['indexes'] || [] ).each_with_index.collect do |i, n|
+        segments = ( i['segments'] || [] ).each_with_index.collect do |s, m|
+          Segment.new(m, s['field_name'].to_s, constant(s['mode'], 'SEG_'))
+        end
+        Index.new(i['name'].to_s, i['number'] || n,
+                  i['allow_dups'].to_s == 'true', i['key_length'], segments)
+      end
+
+      new(doc['path'].to_s, doc.fetch('name').to_s, fields, indexes)
+    end
+
+    # Resolve a type or segment mode written as a name ("CT::BOOL",
+    # "CTSEG_SCHSEG") or a number.
+    def self.constant(value, prefix)
+      return value if value.is_a?(Integer)
+      name = value.to_s.sub(/\ACT(::|_|SEG_)/, '').sub(/\ASEG_/, '')
+      CT.const_get("#{prefix}#{name}")
+    rescue NameError
+      raise ArgumentError, "Unknown type or segment mode `#{value}'"
+    end
+    private_class_method :constant
+
+    # @param [String] table_path
+    # @param [String] table_name
+    # @param [Array<CT::Schema::Field>] fields
+    # @param [Array<CT::Schema::Index>] indexes
+    def initialize(table_path, table_name, fields, indexes)
+      @table_path  = table_path
+      @table_name  = table_name
+      @fields      = fields
+      @indexes     = indexes
+      @field_map   = fields.each_with_object({}) { |f, h| h[f.name] = f }
+      @index_map   = indexes.each_with_object({}) { |i, h| h[i.name] = i }
+      @field_names = fields.collect(&:name)
+      @index_names = indexes.collect(&:name)
+      RactorLocal.make_shareable(self)
+    end
+
+    # @param [String, #to_s] name
+    # @return [CT::Schema::Field, nil]
+    def field(name)
+      @field_map[name.to_s]
+    end
+
+    # @param [String, #to_s] name
+    # @return [CT::Schema::Index, nil]
+    def index(name)
+      @index_map[name.to_s]
+    end
+
+    # The index a new record uses by default.
+    #
+    # @return [CT::Schema::Index, nil]
+    def default_index
+      @indexes.first
+    end
+
+    # @return [Hash] Plain data, see CT::Schema.from_h
+    def to_h
+      { table_path: @table_path,
+        table_name: @table_name,
+        fields:     @fields.collect(&:to_h),
+        indexes:    @indexes.collect { |i|
+          i.to_h.merge(segments: i.segments.collect(&:to_h))
+        } }
+    end
+
+    # Differences that matter to record decoding and key building between
+    # this schema and +other+, usually a snapshot and the live table.
+    # Numbers the snapshot leaves out (key lengths, scale and precision of
+    # a dumped schema) are not compared.  Index order is, since index
+    # numbers and #default_index follow it.
+    #
+    # @param [CT::Schema] other
+    # @return [Array<String>] Empty when they agree
+    def diff(other)
+      diffs = []
+      if field_names != other.field_names
+        diffs << "fields #{field_names.inspect} != #{other.field_names.inspect}"
+      end
+
+      @fields.each do |f|
+        o = other.field(f.name) or next
+        [ :type, :length, :scale, :precision ].each do |attr|
+          next if f[attr].nil? || f[attr] == o[attr]
+          diffs << "field #{f.name} #{attr} #{f[attr].inspect} != #{o[attr].inspect}"
+        end
+      end
+
+      if index_names != other.index_names
+        diffs << "indexes #{index_names.inspect} != #{other.index_names.inspect}"
+      end
+      ( other.index_names - index_names ).each do |name|
+        diffs << "index #{name} unexpected"
+      end
+
+      @indexes.each do |i|
+        o = other.index(i.name)
+        if o.nil?
+          diffs << "index #{i.name} missing"
+          next
+        end
+        if i.allow_dups? != o.allow_dups?
+          diffs << "index #{i.name} allow_dups #{i.allow_dups?} != #{o.allow_dups?}"
+        end
+        segments   = i.segments.collect { |s| [ s.field_name, s.mode ] }
+        o_segments = o.segments.collect { |s| [ s.field_name, s.mode ] }
+        if segments != o_segments
+          diffs << "index #{i.name} segments #{segments.inspect} != #{o_segments.inspect}"
+        end
+      end
+      diffs
+    end
+
+  end
+end
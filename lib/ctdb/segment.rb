@@ -22,7 +22,7 @@ module CT
     def human_mode
       case self.mode
       when CT::SEG_SCHSEG     then "CTSEG_SCHSEG"
-      when CT::SET_USCHSEG    then "CTSEG_USCHSEG"
+      when CT::SEG_USCHSEG    then "CTSEG_USCHSEG"
       when CT::SEG_VSCHSEG    then "CTSEG_VSCHSEG"
       when CT::SEG_UVSCHSEG   then "CTSEG_UVSCHSEG"
       when CT::SEG_SCHSRL     then "CTSEG_SCHSRL"
@@ -17,5 +17,25 @@ module CT
       self.lock!(CT::LOCK_FREE)
     end
 
+    # Run the block inside a transaction.  The transaction is committed when
+    # the block returns and aborted if it raises.  Nested calls join the
+    # transaction already in progress.
+    #
+    # @example
+    #   session.transaction { record.write! }
+    def transaction
+      return yield if transaction_active?
+
+      begin_transaction
+      begin
+        result = yield
+        commit_transaction
+        result
+      rescue Exception
+        abort_transaction if transaction_active?
+        raise
+      end
+    end
+
   end
 end
@@ -8,22 +8,68 @@ module CT
     # @return [Hash] Collection of CT::Table objects for the given session.
     attr_reader :tables
 
+    # !@attribute [r] slots
+    # @return [Array] CT::Table handles indexed by CT::Model table slot
+    attr_reader :slots
+
     def initialize(session)
       @session = session
       @tables  = {} 
+      @slots   = []
     end
 
-    # Retrieve or create a CT::Table resource handle
+    # Retrieve or create a CT::Table resource handle.  Inactive handles are
+    # reopened.
     # @param [String] path Dirname of absolute table path
     # @param [Symbol, #to_s] name Table name
     # @return [CT::Table]
     def open_table(path, name)
-      name = name.to_s
-      @tables[File.join(path, name)] ||= begin
-        table = CT::Table.new(@session)
-        table.path = path
-        table.open(name, CT::OPEN_NORMAL)
+      name  = name.to_s
+      key   = File.join(path, name)
+      table = @tables[key]
+      return table if table && table.active?
+
+      table = CT::Table.new(@session)
+      table.path = path
+      @tables[key] = table.open(name, CT::OPEN_NORMAL)
+    end
+
+    # Open a table handle and store it in the given slot so later lookups
+    # are a single Array read.
+    # @param [Fixnum] slot
+    # @param [String] path Dirname of absolute table path
+    # @param [Symbol, #to_s] name Table name
+    # @return [CT::Table]
+    def open_slot(slot, path, name)
+      @slots[slot] = open_table(path, name)
+    end
+
+    # @return [Boolean] True if the session is still logged on
+    def active?
+      @session.active?
+    end
+
+    # @return [Boolean] True if a transaction or locks are still active
+    def pending?
+      @session.active? && ( @session.transaction_active? || @session.locked? )
+    end
+
+    # Abort any transaction left open, release locks, close every open table
+    # and log out of the session.
+    def disconnect
+      if @session.active?
+        @session.abort_transaction if @session.transaction_active?
+        @session.unlock if @session.locked?
       end
+      @tables.each_value { |table| table.close if table.active? }
+      @tables.clear
+      @slots.clear
+      @session.logout if @session.active?
+    end
+
+    # @see CT::Session#transaction
+    def transaction(&block)
+      @session.transaction(&block)
     end
 
     # @return [Array] List of all open tables
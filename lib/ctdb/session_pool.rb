@@ -0,0 +1,274 @@
+require 'monitor'
+
+module CT
+  # A fixed size pool of logged on sessions.  Each thread (or fiber) checks
+  # out its own CT::SessionHandler so table and record handles are never
+  # shared between threads.  Sessions are created and logged on lazily,
+  # validated on checkout, reclaimed from threads that have died and logged
+  # out once they sit idle for too long.
+  #
+  # @example
+  #   pool = CT::SessionPool.new(engine: "FAIRCOMS", username: "",
+  #                              password: "", mode: CT::SESSION_CTREE,
+  #                              pool: 8, checkout_timeout: 2)
+  #   pool.with_session { |handler| handler.open_table(path, name) }
+  class SessionPool
+
+    Entry = Struct.new(:handler, :owner, :count, :last_used_at)
+
+    # @!attribute [r] size
+    #   @return [Fixnum] Maximum number of sessions
+    attr_reader :size
+    # @!attribute [r] checkout_timeout
+    #   @return [Numeric] Seconds to wait for a free session
+    attr_reader :checkout_timeout
+    # @!attribute [r] idle_timeout
+    #   @return [Numeric, nil] Seconds before an idle session is logged out
+    attr_reader :idle_timeout
+    # @!attribute [r] affinity
+    #   @return [Symbol] :thread or :fiber
+    attr_reader :affinity
+
+    # @param [Hash] config CT::Session logon configuration
+    # @option config [String] :engine
+    # @option config [String] :username
+    # @option config [String] :password
+    # @option config [Fixnum] :mode
+    # @option config [Fixnum] :pool (5) Maximum number of sessions
+    # @option config [Numeric] :checkout_timeout (5) Seconds to wait for a
+    #   free session before raising CT::CheckoutTimeout
+    # @option config [Numeric] :idle_timeout (300) Seconds an unused session
+    #   is kept logged on, nil to keep it forever
+    # @option config [Numeric] :reaping_frequency Run #reap in a background
+    #   thread every n seconds
+    # @option config [Symbol] :affinity (:thread) Check sessions out per
+    #   :thread or per :fiber
+    def initialize(config)
+      @config           = config
+      @size             = config.fetch(:pool, 5)
+      @checkout_timeout = config.fetch(:checkout_timeout, 5)
+      @idle_timeout     = config.fetch(:idle_timeout, 300)
+      @affinity         = config.fetch(:affinity, :thread)
+
+      @monitor   = Monitor.new
+      @available = @monitor.new_cond
+      @idle      = []
+      @in_use    = {}
+      @created   = 0
+
+      start_reaper(config[:reaping_frequency]) if config[:reaping_frequency]
+    end
+
+    # The session checked out by the current thread or fiber.  One is
+    # checked out and kept until #release is called or the owner dies, so
+    # long lived threads (app server workers, job runners) must call
+    # #release, or CT::Model.release_session, when each unit of work ends.
+    #
+    # @return [CT::SessionHandler]
+    # @raise [CT::CheckoutTimeout]
+    def current
+      entry = @in_use[owner]
+      entry ? entry.handler : checkout
+    end
+
+    # Check out a session for the current thread or fiber.  Nested checkouts
+    # by the same owner return the same session.
+    #
+    # @return [CT::SessionHandler]
+    # @raise [CT::CheckoutTimeout] if no session frees up in time
+    def checkout
+      key    = owner
+      doomed = []
+      entry  = begin
+        @monitor.synchronize do
+          if ( entry = @in_use[key] )
+            entry.count += 1
+            return entry.handler
+          end
+          acquire(doomed)
+        end
+      ensure
+        disconnect(doomed)
+      end
+
+      # A new session logs on outside the lock, so other checkouts and
+      # checkins do not wait on the network.
+      entry ||= Entry.new(new_handler, nil, 0, Time.now)
+
+      @monitor.synchronize do
+        entry.owner, entry.count = key, 1
+        @in_use[key] = entry
+      end
+      entry.handler
+    end
+
+    # Give the current owner's session back to the pool once every checkout
+    # has been matched.
+    def checkin
+      key = owner
+      @monitor.synchronize do
+        return unless ( entry = @in_use[key] )
+        entry.count -= 1
+        release_entry(key) if entry.count <= 0
+      end
+    end
+
+    # Give the current owner's session back to the pool regardless of how
+    # many times it was checked out.
+    def release
+      @monitor.synchronize { release_entry(owner) if @in_use.key?(owner) }
+    end
+
+    # Run the block with a checked out session.
+    #
+    # @yield [handler] CT::SessionHandler
+    def with_session
+      handler = checkout
+      yield handler
+    ensure
+      checkin if handler
+    end
+
+    # Reclaim sessions held by dead threads or fibers and log out sessions
+    # that have been idle longer than #idle_timeout.
+    def reap
+      doomed = @monitor.synchronize do
+        doomed = reclaim_dead_owners
+        if idle_timeout
+          cutoff = Time.now - idle_timeout
+          stale, @idle = @idle.partition { |e| e.last_used_at < cutoff }
+          doomed.concat(stale.each { |entry| forget(entry) })
+        end
+        doomed
+      end
+      disconnect(doomed)
+    end
+
+    # Stop the reaper and log out every session.  Sessions checked out at
+    # the time are logged out as well.
+    def disconnect!
+      if @reaper
+        @reaper.kill.join
+        @reaper = nil
+      end
+
+      doomed = @monitor.synchronize do
+        doomed = @idle + @in_use.values
+        doomed.each { |entry| forget(entry) }
+        @idle.clear
+        @in_use.clear
+        doomed
+      end
+      disconnect(doomed)
+    end
+
+    # @return [Hash] Pool counters
+    def stat
+      @monitor.synchronize do
+        { size: size, connections: @created, idle: @idle.size,
+          busy: @in_use.size }
+      end
+    end
+
+    private
+
+      def owner
+        affinity == :fiber ? Fiber.current : Thread.current
+      end
+
+      # Take a healthy idle session, reserve room for a new one (returning
+      # nil) if the pool has room, or wait for one to be checked in.
+      # Sessions found unusable on the way are added to doomed for the
+      # caller to log out once the monitor is released.
+      def acquire(doomed)
+        deadline = Time.now + checkout_timeout
+        loop do
+          while ( entry = @idle.pop )
+            return entry if entry.handler.active?
+            doomed << forget(entry)
+          end
+
+          if @created < size
+            @created += 1
+            return nil
+          end
+
+          doomed.concat(reclaim_dead_owners)
+          next unless @idle.empty?
+
+          remaining = deadline - Time.now
+          if remaining <= 0
+            raise CT::CheckoutTimeout.new("Could not obtain a CT::Session " +
+                                          "within #{checkout_timeout} seconds")
+          end
+          @available.wait(remaining)
+        end
+      end
+
+      # Log on a session for room reserved by #acquire.
+      def new_handler
+        session = CT::Session.new(@config[:mode])
+        session.logon(@config[:engine], @config[:username], @config[:password])
+        CT::SessionHandler.new(session)
+      rescue Exception
+        @monitor.synchronize do
+          @created -= 1
+          @available.signal
+        end
+        raise
+      end
+
+      def release_entry(key)
+        entry = @in_use.delete(key)
+        entry.owner, entry.count, entry.last_used_at = nil, 0, Time.now
+        @idle.push(entry)
+        @available.signal
+      end
+
+      # Return the sessions of dead owners to the pool.  A session left
+      # inside a transaction or holding locks is not reused, so the next
+      # owner cannot commit a dead thread's half finished work; it is
+      # returned for the caller to log out, which aborts that work.
+      def reclaim_dead_owners
+        doomed = []
+        @in_use.keys.each do |key|
+          next if key.alive?
+          if @in_use[key].handler.pending?
+            doomed << forget(@in_use.delete(key))
+          else
+            release_entry(key)
+          end
+        end
+        doomed
+      end
+
+      # Give up an entry's room in the pool.  The caller logs it out with
+      # #disconnect after releasing the monitor.
+      def forget(entry)
+        @created -= 1
+        @available.signal
+        entry
+      end
+
+      # Log out sessions outside the monitor, so checkouts and checkins do
+      # not wait on the network.
+      def disconnect(entries)
+        entries.each do |entry|
+          begin
+            entry.handler.disconnect
+          rescue CT::Error
+          end
+        end
+      end
+
+      def start_reaper(frequency)
+        @reaper = Thread.new do
+          loop do
+            sleep(frequency)
+            reap
+          end
+        end
+      end
+
+  end
+end
@@ -0,0 +1,257 @@
+module CT
+  # Buffers inserts from any number of threads and writes them from a single
+  # background thread on a dedicated session.  Rows are grouped into batches,
+  # each committed in one transaction, once +batch_size+ rows are waiting or
+  # the oldest row has waited +flush_interval+ seconds.
+  #
+  # Rows are written as given, so every field the table requires (including
+  # any manually incremented key) must be present.
+  #
+  # @example
+  #   buffer = CT::WriteBuffer.new(Event, batch_size: 500,
+  #              on_error: ->(row, e) { logger.error("#{row}: #{e}") })
+  #   buffer << { kind: "click", at: Time.now }
+  #   buffer.flush! # everything pushed so far is committed
+  #   buffer.close
+  class WriteBuffer
+
+    # SizedQueue#pop accepts a timeout from Ruby 3.2.
+    POP_TIMEOUT = SizedQueue.instance_method(:pop).parameters.any? { |_, name| 
+      name == :timeout 
+    }
+
+    # Marks a point in the queue that a #flush! caller is waiting on.
+    class Barrier
+      def initialize
+        @done = Queue.new
+      end
+
+      def signal(error=nil)
+        @done << error
+      end
+
+      def wait
+        error = @done.pop
+        raise error if error
+      end
+    end
+
+    # @!attribute [r] written
+    #   @return [Fixnum] Rows committed so far
+    attr_reader :written
+    # @!attribute [r] failed
+    #   @return [Fixnum] Rows that could not be written
+    attr_reader :failed
+
+    # @param [Class, Hash] target A CT::Model subclass or a Hash with
+    #   :table_path and :table_name
+    # @param [Hash] options
+    # @option options [Fixnum] :capacity (10000) Rows the queue holds before
+    #   #push blocks
+    # @option options [Fixnum] :batch_size (500) Rows per transaction
+    # @option options [Numeric] :flush_interval (0.05) Seconds a row may wait
+    #   before a partial batch is written
+    # @option options [Hash] :session CT::Session logon configuration,
+    #   defaults to the CT::Model.session= configuration
+    # @option options [Proc] :on_error Called with the row and the error for
+    #   every row that fails to write
+    def initialize(target, options={})
+      @table_path, @table_name = if target.is_a?(Hash)
+        [ target[:table_path], target[:table_name] ]
+      else
+        [ target.table_path, target.table_name ]
+      end
+
+      @batch_size     = options.fetch(:batch_size, 500)
+      @flush_interval = options.fetch(:flush_interval, 0.05)
+      @on_error       = options[:on_error]
+      @config         = options[:session] || CT::Model.session_config
+      @queue          = SizedQueue.new(options.fetch(:capacity, 10_000))
+      @written        = 0
+      @failed         = 0
+      @closed         = false
+
+      raise CT::Error.new("[4003] No session configuration.") unless @config
+
+      connect
+      @thread = Thread.new { run }
+    end
+
+    # Queue a row.  Blocks while the queue is full.
+    #
+    # @param [Hash] row Field name => value
+    # @return [CT::WriteBuffer]
+    # @raise [CT::Error] if the buffer is closed
+    def push(row)
+      raise closed_error if @closed
+      @queue.push(row)
+      self
+    rescue ClosedQueueError
+      raise closed_error
+    end
+    alias :<< :push
+
+    # Queue a row unless the queue is full.
+    #
+    # @param [Hash] row Field name => value
+    # @return [Boolean] false if the row was not queued
+    def try_push(row)
+      raise closed_error if @closed
+      @queue.push(row, true)
+      true
+    rescue ThreadError
+      false
+    rescue ClosedQueueError
+      raise closed_error
+    end
+
+    # Block until every row pushed before the call has been committed.  On
+    # a closed buffer this waits for #close to finish.
+    #
+    # @raise [CT::Error] if the batch transaction failed
+    def flush!
+      if @closed
+        @thread.join
+        return
+      end
+      barrier = Barrier.new
+      @queue.push(barrier)
+      barrier.wait
+    rescue ClosedQueueError
+      @thread.join
+      nil
+    end
+
+    # Flush pending rows, stop the writer thread and log out.  Rows pushed
+    # while the buffer closes are either written or reported to +on_error+;
+    # pushes still blocked on a full queue raise CT::Error.
+    def close
+      return if @closed
+      @closed = true
+      begin
+        @queue.push(:close)
+      rescue ClosedQueueError
+        # The writer thread has already stopped.
+      end
+      @thread.join
+    end
+
+    # @return [Fixnum] Rows waiting to be written
+    def pending
+      @queue.size
+    end
+
+    private
+
+      def run
+        loop do
+          batch, barriers, stop = next_batch
+          write_batch(batch, barriers)
+          break if stop
+        end
+      ensure
+        @queue.close
+        drain
+        disconnect
+      end
+
+      def closed_error
+        CT::Error.new("CT::WriteBuffer is closed")
+      end
+
+      # Report whatever landed behind the close request.  The queue is
+      # closed first, so nothing can be added while it drains.
+      def drain
+        error = closed_error
+        while ( item = ( @queue.pop(true) rescue nil ) )
+          case item
+          when :close  then next
+          when Barrier then item.signal(error)
+          else failed_row(item, error)
+          end
+        end
+      end
+
+      def connect
+        session = CT::Session.new(@config[:mode])
+        session.logon(@config[:engine], @config[:username], @config[:password])
+        @handler = CT::SessionHandler.new(session)
+        @record  = CT::Record.new(@handler.open_table(@table_path, @table_name))
+      end
+
+      def disconnect
+        @handler.disconnect if @handler
+      rescue CT::Error
+      end
+
+      # Collect rows until the batch is full, the oldest row has waited
+      # long enough, or a flush or close is requested.
+      def next_batch
+        batch, barriers = [], []
+        item     = @queue.pop
+        deadline = Time.now + @flush_interval
+
+        loop do
+          case item
+          when :close   then return [ batch, barriers, true ]
+          when Barrier  then return [ batch, barriers << item, false ]
+          else batch << item
+          end
+
+          return [ batch, barriers, false ] if batch.size >= @batch_size
+          remaining = deadline - Time.now
+          return [ batch, barriers, false ] if remaining <= 0
+          return [ batch, barriers, false ] if ( item = poll(remaining) ).nil?
+        end
+      end
+
+      def poll(timeout)
+        if POP_TIMEOUT
+          @queue.pop(timeout: timeout)
+        else
+          expire_at = Time.now + timeout
+          begin
+            @queue.pop(true)
+          rescue ThreadError
+            return nil if Time.now >= expire_at
+            sleep(0.001)
+            retry
+          end
+        end
+      end
+
+      def write_batch(batch, barriers)
+        errors = []
+        unless batch.empty?
+          @handler.transaction do
+            batch.each do |row|
+              begin
+                write_row(row)
+              rescue CT::Error => e
+                errors << [ row, e ]
+              end
+            end
+          end
+          @written += batch.size - errors.size
+        end
+        errors.each { |row, e| failed_row(row, e) }
+        barriers.each(&:signal)
+      rescue Exception => e
+        batch.each { |row| failed_row(row, e) }
+        barriers.each { |barrier| barrier.signal(e) }
+      end
+
+      def write_row(row)
+        @record.clear
+        row.each { |field, value| @record.set_field(field.to_s, value) }
+        @record.write!
+      end
+
+      def failed_row(row, error)
+        @failed += 1
+        @on_error.call(row, error) if @on_error
+      rescue Exception
+      end
+
+  end
+end
@@ -0,0 +1,153 @@
+require File.join(File.dirname(__FILE__), 'test_helper')
+require 'timeout'
+
+class TestCTAsync < Test::Unit::TestCase
+  include TestHelper
+
+  # Just enough of a Fiber::Scheduler to run fibers blocked on IO readiness,
+  # which is how the worker pool signals a finished call.
+  class Scheduler
+    attr_reader :waits
+
+    def initialize
+      @readable = {}
+      @ready    = []
+      @waits    = 0
+    end
+
+    def fiber(&block)
+      Fiber.new(blocking: false, &block).tap(&:resume)
+    end
+
+    def io_wait(io, events, timeout)
+      @waits += 1
+      @readable[io] = Fiber.current
+      Fiber.yield
+      events
+    end
+
+    def kernel_sleep(duration=nil)
+      @ready << Fiber.current
+      Fiber.yield
+    end
+
+    def block(blocker, timeout=nil)
+      @ready << Fiber.current
+      Fiber.yield
+    end
+
+    def unblock(blocker, fiber)
+      @ready << fiber
+    end
+
+    def close
+      run
+    end
+
+    def run
+      until @readable.empty? && @ready.empty?
+        ready, @ready = @ready, []
+        ready.each { |fiber| fiber.resume if fiber.alive? }
+        next if @readable.empty?
+
+        readable, = IO.select(@readable.keys, nil, nil, 1)
+        ( readable || [] ).each { |io| @readable.delete(io).resume }
+      end
+    end
+  end
+
+  def setup
+    skip "Built without Fiber scheduler support" if CT.async_pool_size.zero?
+    @size = CT.async_pool_size
+  end
+
+  def teardown
+    CT.async_pool_size = @size if @size
+  end
+
+  def open_table
+    session = CT::Session.new(CT::SESSION_CTREE)
+    session.logon(_c[:engine], _c[:username], _c[:password])
+    table = CT::Table.new(session)
+    table.path = _c[:table_path]
+    table.open(_c[:table_name], CT::OPEN_NORMAL)
+    [ session, table ]
+  end
+
+  # Each fiber uses its own session, as threads would.
+  def run_fibers(n)
+    results   = Array.new(n)
+    scheduler = Scheduler.new
+    Thread.new do
+      Fiber.set_scheduler(scheduler)
+      n.times do |i|
+        Fiber.schedule do
+          session, table = open_table
+          record = CT::Record.new(table).clear
+          record.first
+          key = record.get_field("uinteger")
+          record.clear
+          record.set_field("uinteger", key)
+          record.find(CT::FIND_EQ)
+          results[i] = [ record.get_field("uinteger"),
+                         record.pluck(["uinteger"]) ]
+          table.close
+          session.logout
+        end
+      end
+    end.join
+    [ results, scheduler ]
+  end
+
+  def expected
+    session, table = open_table
+    record = CT::Record.new(table).clear
+    record.first
+    [ record.get_field("uinteger"), record.pluck(["uinteger"]) ]
+  ensure
+    table.close
+    session.logout
+  end
+
+  def test_fibers
+    results, scheduler = Timeout.timeout(30) { run_fibers(4) }
+    assert_equal([ expected ] * 4, results)
+    assert_operator(scheduler.waits, :>, 0)
+  end
+
+  def test_fibers_without_pool
+    CT.async_pool_size = 0
+    results, scheduler = Timeout.timeout(30) { run_fibers(2) }
+    assert_equal([ expected ] * 2, results)
+    assert_equal(0, scheduler.waits)
+  end
+
+  def test_pool_size
+    assert_raise(ArgumentError) { CT.async_pool_size = -1 }
+    assert_raise(ArgumentError) { CT.async_pool_size = 65 }
+    assert_raise(TypeError) { CT.async_pool_size = "8" }
+    CT.async_pool_size = 64
+    assert_equal(64, CT.async_pool_size)
+    CT.async_pool_size = 0
+    assert_equal(0, CT.async_pool_size)
+  end
+
+  # Workers do not survive fork, so a child left with the parent's pool
+  # would queue calls nobody runs and hang.
+  def test_fork_resets_pool
+    skip "fork is not available" unless Process.respond_to?(:fork)
+    run_fibers(1)
+
+    pid = fork do
+      begin
+        results, = Timeout.timeout(30) { run_fibers(2) }
+        exit!(results.all? { |r| r == expected } ? 0 : 1)
+      rescue Exception
+        exit!(2)
+      end
+    end
+    _, status = Process.wait2(pid)
+    assert(status.success?, "Child exited with #{status.inspect}")
+  end
+
+end
@@ -0,0 +1,114 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'ctdb/cli'
+
+class TestCTCLIBench < Test::Unit::TestCase
+
+  Bench     = CT::CLI::Bench
+  Histogram = CT::CLI::Bench::Histogram
+
+  def test_parse_duration
+    assert_equal(60.0,   Bench.parse_duration("60"))
+    assert_equal(60.0,   Bench.parse_duration("60s"))
+    assert_equal(0.5,    Bench.parse_duration("500ms"))
+    assert_equal(90.0,   Bench.parse_duration("1.5m"))
+    assert_equal(7200.0, Bench.parse_duration("2h"))
+    [ "", "s", "-1s", "10d", "1 m" ].each do |value|
+      assert_raise(ArgumentError, value) { Bench.parse_duration(value) }
+    end
+  end
+
+  def test_options
+    assert_raise(ArgumentError) { Bench.new(workload: 'scan') }
+    assert_raise(ArgumentError) { Bench.new(workload: 'mixed', mix: { 'scan' => 1 }) }
+    assert_nothing_raised { Bench.new(workload: 'mixed') }
+  end
+
+  def test_schedule
+    bench = Bench.new(workload: 'mixed', mix: { 'point' => 3, 'range' => 1 })
+    schedule = bench.send(:schedule, %w[ point range ])
+    assert_equal(75, schedule.count('point'))
+    assert_equal(25, schedule.count('range'))
+    assert_equal(%w[ point ], bench.send(:schedule, %w[ point ]))
+  end
+
+  def test_histogram_empty
+    h = Histogram.new
+    assert_equal(0, h.count)
+    assert_equal(0.0, h.mean)
+    assert_equal(0.0, h.percentile(99))
+  end
+
+  def test_histogram_percentile
+    h = Histogram.new
+    ( 1..1000 ).each { |ms| h.record(ms / 1000.0) }
+    assert_equal(1000, h.count)
+    assert_in_delta(0.5005, h.mean, 1e-9)
+    assert_equal(1.0, h.max)
+    { 50 => 0.5, 90 => 0.9, 99 => 0.99 }.each do |p, expected|
+      assert_in_delta(expected, h.percentile(p), expected * 0.02, "p#{p}")
+      assert_operator(h.percentile(p), :>=, expected, "p#{p}")
+    end
+    assert_equal(1.0, h.percentile(100))
+    assert_in_delta(0.001, h.percentile(0), 0.001 * 0.02)
+  end
+
+  def test_histogram_tiny_values
+    h = Histogram.new
+    h.record(0.0)
+    h.record(1e-9)
+    assert_equal(1e-9, h.percentile(100))
+  end
+
+  def test_histogram_merge
+    a = Histogram.new
+    b = Histogram.new
+    100.times { a.record(0.001) }
+    100.times { b.record(0.1) }
+    assert_same(a, a.merge!(b))
+    assert_equal(200, a.count)
+    assert_equal(0.1, a.max)
+    assert_in_delta(0.001, a.percentile(50), 0.001 * 0.02)
+    assert_in_delta(0.1, a.percentile(51), 0.1 * 0.02)
+  end
+
+  def test_report
+    h = Histogram.new
+    4.times { h.record(0.002) }
+    report = Bench::Report.new('point', 2, 2.0, { 'point' => h }, { 'point' => 1 })
+    hash = report.to_h
+    assert_equal(2.0, hash[:throughput])
+    point = hash[:operations]['point']
+    assert_equal(4, point[:count])
+    assert_equal(1, point[:errors])
+    assert_equal(%w[ p50 p90 p99 p999 ],
+                 point[:latency_ms].keys.grep(String))
+    assert_in_delta(2.0, point[:latency_ms]['p999'], 0.04)
+    assert_match(/\Apoint workload, 2 thread\(s\), 2\.0s, 2 ops\/s/, report.to_s)
+    assert_equal(false, hash[:serialized])
+    assert_no_match(/serialized/, report.to_s)
+
+    report = Bench::Report.new('point', 2, 2.0, { 'point' => h }, { 'point' => 0 }, true)
+    assert_equal(true, report.to_h[:serialized])
+    assert_match(/^Threads were serialized/, report.to_s)
+    report = Bench::Report.new('point', 1, 2.0, { 'point' => h }, { 'point' => 0 }, true)
+    assert_equal(false, report.to_h[:serialized])
+  end
+
+  def test_cleanup_after_failure
+    bench   = Bench.new(workload: 'insert', duration: 5)
+    cleaned = nil
+    bench.define_singleton_method(:prepare) { |table, operations| @max_key = 0 }
+    bench.define_singleton_method(:drive) do |table, seed, stop_at|
+      @inserted << 1
+      raise TypeError, "bad value"
+    end
+    bench.define_singleton_method(:cleanup) { |connect| cleaned = @inserted.size }
+
+    report, Thread.report_on_exception = Thread.report_on_exception, false
+    assert_raise(TypeError) { bench.run { |&block| block.call(nil) } }
+    assert_equal(1, cleaned)
+  ensure
+    Thread.report_on_exception = report
+  end
+
+end
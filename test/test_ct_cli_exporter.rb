@@ -0,0 +1,120 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'stringio'
+require 'ctdb/cli'
+
+class TestCTCLIExporter < Test::Unit::TestCase
+
+  Field = Struct.new(:type) do
+    include CT::FieldTypes
+  end
+
+  def exporter(opts={})
+    CT::CLI::Exporter.new({ format: 'csv' }.merge(opts))
+  end
+
+  def test_options
+    assert_raise(ArgumentError) { exporter(format: 'xml') }
+    assert_raise(ArgumentError) { exporter(from: ['1']) }
+    assert_nothing_raised { exporter(index: 'id_ndx', from: ['1']) }
+  end
+
+  def test_past
+    e     = exporter(index: 'id_ndx')
+    names = %w[ id seq ]
+    limit = [ [ 'id', 5, 1 ] ]
+    assert_equal(false, e.send(:past?, [ 4, 9 ], names, limit))
+    assert_equal(false, e.send(:past?, [ 5, 9 ], names, limit))
+    assert_equal(true,  e.send(:past?, [ 6, 0 ], names, limit))
+
+    limit = [ [ 'id', 5, 1 ], [ 'seq', 2, -1 ] ]
+    assert_equal(false, e.send(:past?, [ 5, 3 ], names, limit))
+    assert_equal(true,  e.send(:past?, [ 5, 1 ], names, limit))
+  end
+
+  def test_key_value
+    e = exporter(index: 'id_ndx')
+    assert_equal(42, e.send(:key_value, Field.new(CT::INTEGER), '42'))
+    assert_equal(BigDecimal('19.99'), e.send(:key_value, Field.new(CT::MONEY), '19.99'))
+    assert_equal(Date.new(2024, 2, 29), e.send(:key_value, Field.new(CT::DATE), '2024-02-29'))
+    assert_equal(DateTime.new(2024, 2, 29, 12, 30), 
+                 e.send(:key_value, Field.new(CT::TIMESTAMP), '2024-02-29T12:30:00'))
+    assert_equal(Time.new(1970, 1, 1, 8, 15), e.send(:key_value, Field.new(CT::TIME), '08:15'))
+    assert_equal(false, e.send(:key_value, Field.new(CT::BOOL), 'false'))
+    assert_equal('abc', e.send(:key_value, Field.new(CT::CHARS), 'abc'))
+    assert_raise_kind_of(ArgumentError) { e.send(:key_value, Field.new(CT::DATE), 'soon') }
+  end
+
+  def test_past_core_values
+    e     = exporter(index: 'day_ndx')
+    keys  = [ [ 'day', Field.new(CT::DATE), 1, CT::SEG_SCHSEG ] ]
+    limit = e.send(:bound, keys, [ '2024-02-29' ])
+    assert_equal(false, e.send(:past?, [ Date.new(2024, 2, 28) ], %w[ day ], limit))
+    assert_equal(true,  e.send(:past?, [ Date.new(2024, 3, 1) ], %w[ day ], limit))
+    assert_equal(false, e.send(:past?, [ nil ], %w[ day ], limit))
+    assert_raise(ArgumentError) { e.send(:past?, [ 'x' ], %w[ day ], limit) }
+  end
+
+  def test_past_uppercase
+    e     = exporter(index: 'name_ndx')
+    keys  = [ [ 'name', Field.new(CT::CHARS), 1, CT::SEG_USCHSEG ] ]
+    limit = e.send(:bound, keys, [ 'm' ])
+    assert_equal([ [ 'name', 'M', 1, true ] ], limit)
+    assert_equal(false, e.send(:past?, [ 'apple' ], %w[ name ], limit))
+    assert_equal(false, e.send(:past?, [ 'm' ], %w[ name ], limit))
+    assert_equal(true,  e.send(:past?, [ 'Zed' ], %w[ name ], limit))
+
+    keys = [ [ 'name', Field.new(CT::CHARS), 1, CT::SEG_SCHSEG | CT::SEG_ALTSEG ] ]
+    assert_raise(ArgumentError) { e.send(:bound, keys, [ 'm' ]) }
+  end
+
+  def test_start_not_found
+    e      = exporter(index: 'id_ndx')
+    keys   = [ [ 'id', Field.new(CT::INTEGER), 1, CT::SEG_SCHSEG ] ]
+    record = Object.new
+    def record.default_index=(name); end
+    def record.set_field(name, value); end
+    def record.find(mode); raise CT::Error, @message; end
+
+    record.instance_variable_set(:@message, "[#{CT::INOT_ERR}] ctdbFindRecord failed.")
+    assert_equal(false, e.send(:start, record, keys, [ '9' ]))
+    record.instance_variable_set(:@message, "[12] ctdbFindRecord failed.")
+    assert_raise(CT::Error) { e.send(:start, record, keys, [ '9' ]) }
+  end
+
+  def test_truncate
+    e     = exporter(index: 'id_ndx')
+    batch = [ [ 1 ], [ 2 ], [ 3 ], [ 4 ] ]
+    assert(e.send(:truncate, batch, %w[ id ], [ [ 'id', 2, 1 ] ]))
+    assert_equal([ [ 1 ], [ 2 ] ], batch)
+    assert_equal(false, e.send(:truncate, batch, %w[ id ], [ [ 'id', 9, 1 ] ]))
+  end
+
+  def test_split_range
+    e = exporter(index: 'id_ndx', parallel: 3, from: [ '1', 'a' ], to: [ '9' ])
+    assert_equal([ [ [ '1', 'a' ], [ '3' ] ],
+                   [ [ '4' ], [ '6' ] ],
+                   [ [ '7' ], [ '9' ] ] ], e.send(:split_range, 1, 9))
+
+    e = exporter(index: 'id_ndx', parallel: 4)
+    ranges = e.send(:split_range, 1, 2)
+    assert_equal([ [ [], [ '1' ] ], [ [ '2' ], [] ] ], ranges)
+    assert_equal([ [ [], [] ] ], e.send(:split_range, 5, 1))
+  end
+
+  def test_csv_encoder
+    io = StringIO.new
+    encoder = CT::CLI::Exporter::CSVEncoder.new(io)
+    encoder.header(%w[ id price ])
+    encoder.header(%w[ id price ])
+    encoder.rows(%w[ id price ], [ [ 1, BigDecimal("19.99") ], [ 2, nil ] ])
+    assert_equal("id,price\n1,19.99\n2,\n", io.string)
+  end
+
+  def test_json_lines_encoder
+    io = StringIO.new
+    encoder = CT::CLI::Exporter::JSONLinesEncoder.new(io)
+    encoder.rows(%w[ id blob ], [ [ 1, "\xFF".b ] ])
+    assert_equal(%Q({"id":1,"blob":"/w=="}\n), io.string)
+  end
+
+end
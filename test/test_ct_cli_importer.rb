@@ -0,0 +1,172 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'tmpdir'
+require 'ctdb/cli'
+
+class TestCTCLIImporter < Test::Unit::TestCase
+
+  Field = Struct.new(:name, :type, :string) do
+    def string?; string; end
+  end
+
+  Index = Struct.new(:name, :key_type, :allow_dups, :segments, :allow_nil) do
+    def allow_dups?; allow_dups; end
+    def allow_nil?; allow_nil; end
+    def add_segment(field, mode); segments << [ field, mode ]; end
+  end
+
+  # Records the index changes drop_indexes and restore_indexes make.
+  class Table
+    attr_reader :indecies, :deleted, :added, :altered
+
+    def initialize(indecies)
+      @indecies = indecies
+      @deleted  = []
+      @added    = []
+    end
+
+    def delete_index(name); @deleted << name; end
+    def alter(mode); @altered = mode; end
+    def get_field(name); name; end
+
+    def add_index(name, key_type, opts)
+      Index.new(name, key_type, opts[:allow_dups], [], opts[:allow_nil]).tap do |index|
+        @added << index
+      end
+    end
+  end
+
+  def setup
+    @dir  = Dir.mktmpdir('ctdb_import')
+    @path = File.join(@dir, 'rows.csv')
+    File.write(@path, "id,name\n1,a\n2,b\n3,c\n4,d\n")
+  end
+
+  def teardown
+    FileUtils.remove_entry(@dir)
+  end
+
+  def importer(opts={})
+    CT::CLI::Importer.new(@path, opts)
+  end
+
+  def test_format
+    assert_equal('csv', importer.format)
+    assert_equal('jsonl', importer(format: 'ndjson').format)
+    assert_raise(ArgumentError) { importer(format: 'xml') }
+  end
+
+  def test_checkpoint
+    first = importer
+    assert_equal({ 'rows' => 0, 'inserted' => 0, 'rejected' => 0 },
+                 first.send(:load_checkpoint))
+
+    first.instance_variable_set(:@done, 2)
+    first.instance_variable_set(:@inserted, 1)
+    first.instance_variable_set(:@rejected, 1)
+    first.instance_variable_set(:@indexes, [])
+    first.send(:save_checkpoint)
+    assert(File.exist?("#{@path}.checkpoint"))
+    assert(!File.exist?("#{@path}.checkpoint.tmp"))
+
+    state = importer.send(:load_checkpoint)
+    assert_equal([ 2, 1, 1 ], state.values_at('rows', 'inserted', 'rejected'))
+
+    other = CT::CLI::Importer.new(File.join(@dir, 'other.csv'),
+                                  checkpoint: "#{@path}.checkpoint")
+    assert_equal(0, other.send(:load_checkpoint)['rows'])
+  end
+
+  def test_resume_skips_done_rows
+    resumed = importer
+    resumed.instance_variable_set(:@done, 2)
+    rows = []
+    resumed.send(:each_row) { |raw, row, line| rows << [ line, row['id'] ] }
+    assert_equal([ [ 3, '3' ], [ 4, '4' ] ], rows)
+  end
+
+  def test_json_lines
+    path = File.join(@dir, 'rows.jsonl')
+    File.write(path, %Q({"id":1}\n\nnot json\n))
+    jsonl = CT::CLI::Importer.new(path)
+    jsonl.instance_variable_set(:@done, 0)
+    rows = []
+    jsonl.send(:each_row) { |raw, row, line| rows << [ line, row ] }
+    assert_equal([ 1, { 'id' => 1 } ], rows[0])
+    assert_equal(3, rows[1][0])
+    assert_kind_of(JSON::ParserError, rows[1][1])
+  end
+
+  def test_converters
+    table = Struct.new(:fields).new([
+      Field.new('flag',  CT::BOOL,      false),
+      Field.new('count', CT::INTEGER,   false),
+      Field.new('price', CT::MONEY,     false),
+      Field.new('day',   CT::DATE,      false),
+      Field.new('name',  CT::CHARS,     true)
+    ])
+    converters = importer.send(:converters_for, table)
+    assert_equal(true,  converters['flag'].call('Yes'))
+    assert_equal(false, converters['flag'].call('0'))
+    assert_equal(42,    converters['count'].call('42'))
+    assert_nil(converters['count'].call(''))
+    assert_raise(ArgumentError) { converters['count'].call('4x') }
+    assert_equal(BigDecimal('19.99'), converters['price'].call('19.99'))
+    assert_equal(Date.new(2020, 2, 29), converters['day'].call('2020-02-29'))
+    assert_equal('', converters['name'].call(''))
+  end
+
+  def loader
+    importer.tap do |loader|
+      loader.instance_variable_set(:@done, 0)
+      loader.instance_variable_set(:@inserted, 0)
+      loader.instance_variable_set(:@rejected, 0)
+    end
+  end
+
+  def test_drop_indexes_keeps_unique
+    table = Table.new([
+      Index.new('id_ndx',   CT::INDEX_FIXED, false, [], true),
+      Index.new('name_ndx', CT::INDEX_FIXED, true,  [], true),
+      Index.new('day_ndx',  CT::INDEX_FIXED, true,  [], false)
+    ])
+    indexes = loader.send(:drop_indexes, table)
+    assert_equal(%w[ name_ndx day_ndx ], indexes.collect { |i| i['name'] })
+    assert_equal([ true, false ], indexes.collect { |i| i['allow_nil'] })
+    assert_equal(%w[ day_ndx name_ndx ], table.deleted)
+    assert_equal(CT::DB_ALTER_NORMAL, table.altered)
+  end
+
+  # Indexes before a unique one stay, so re-adding at the end keeps order.
+  def test_drop_indexes_keeps_order
+    table = Table.new([
+      Index.new('name_ndx', CT::INDEX_FIXED, true,  [], true),
+      Index.new('id_ndx',   CT::INDEX_FIXED, false, [], true),
+      Index.new('day_ndx',  CT::INDEX_FIXED, true,  [], true)
+    ])
+    indexes = loader.send(:drop_indexes, table)
+    assert_equal(%w[ day_ndx ], indexes.collect { |i| i['name'] })
+    assert_equal(%w[ day_ndx ], table.deleted)
+
+    table = Table.new([ Index.new('id_ndx', CT::INDEX_FIXED, false, [], true) ])
+    assert_equal([], loader.send(:drop_indexes, table))
+    assert_nil(table.altered)
+  end
+
+  def test_restore_indexes
+    table   = Table.new([])
+    restore = loader
+    restore.instance_variable_set(:@indexes, [
+      { 'name' => 'name_ndx', 'key_type' => CT::INDEX_FIXED, 'allow_dups' => true,
+        'allow_nil' => false, 'segments' => [ [ 'name', 4 ] ] },
+      { 'name' => 'day_ndx', 'key_type' => CT::INDEX_FIXED, 'allow_dups' => true,
+        'segments' => [ [ 'day', 4 ] ] }
+    ])
+    restore.send(:restore_indexes, table)
+
+    assert_equal(%w[ name_ndx day_ndx ], table.added.collect(&:name))
+    assert_equal([ false, true ], table.added.collect(&:allow_nil))
+    assert_equal([ [ 'name', 4 ] ], table.added.first.segments)
+    assert_equal(CT::DB_ALTER_INDEX, table.altered)
+  end
+
+end
@@ -0,0 +1,29 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'stringio'
+require 'ctdb/cli'
+
+class TestCTCLIProgress < Test::Unit::TestCase
+
+  def test_rate_limited
+    io = StringIO.new
+    progress = CT::CLI::Progress.new(io, 60)
+    progress.update { "first" }
+    assert_equal("", io.string)
+    progress.update(true) { |elapsed| elapsed > 0 ? "done" : "zero" }
+    assert_equal("\rdone\n", io.string)
+  end
+
+  def test_every_update
+    io = StringIO.new
+    progress = CT::CLI::Progress.new(io, 0)
+    2.times { |i| progress.update { "#{i}" } }
+    assert_equal("\r0\r1", io.string)
+  end
+
+  def test_without_io
+    progress = CT::CLI::Progress.new(nil)
+    assert_nil(progress.update(true) { flunk("not called") })
+    assert_nil(progress.puts("ignored"))
+  end
+
+end
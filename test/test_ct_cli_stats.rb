@@ -0,0 +1,181 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'ctdb/cli'
+
+class TestCTCLIStats < Test::Unit::TestCase
+
+  Stats = CT::CLI::Stats
+
+  Field = Struct.new(:name, :number, :type, :length, :variable) do
+    def variable_length?; variable; end
+    def integer?; type == CT::INTEGER; end
+  end
+  Segment = Struct.new(:field_name, :field)
+  Index   = Struct.new(:name, :segments) do
+    def allow_dups?; false; end
+  end
+  Table   = Struct.new(:name, :fields, :indecies) do
+    def field_names; fields.collect(&:name); end
+  end
+
+  # Rows sorted on their first column, which the first index leads with.
+  class Record
+    attr_accessor :temporal_mode, :numeric_mode, :default_index
+    attr_reader :plucked
+
+    def initialize(rows, offset)
+      @rows, @offset, @plucked = rows, offset, []
+    end
+
+    def clear; self; end
+    def count; @rows.size; end
+    def field_offset(number); @offset; end
+    def first; @pos = 0; self; end
+    def last; @pos = @rows.size - 1; self; end
+    def get_field(name); @rows[@pos][0]; end
+    def set_field(name, value); @key = value; end
+
+    def find(mode)
+      @pos = @rows.index { |row| row[0] >= @key } or raise CT::Error
+      self
+    end
+
+    def pluck(names, limit)
+      batch = @rows[@pos, limit]
+      @pos += batch.size - 1
+      @plucked.concat(batch.collect(&:first))
+      names.size == 1 ? batch.collect(&:first) : batch
+    end
+  end
+
+  def stats(opts, rows, fields, offset)
+    record = Record.new(rows, offset)
+    index  = Index.new('id_ndx', [ Segment.new(fields[0].name, fields[0]) ])
+    table  = Table.new('orders', fields, [ index ])
+    stats  = Stats.new(opts)
+    stats.define_singleton_method(:new_record) { |t| record }
+    [ stats.run(table), record ]
+  end
+
+  def test_hyper_log_log
+    hll = Stats::HyperLogLog.new
+    assert_equal(0, hll.count)
+
+    100.times { |i| hll.add(i) }
+    assert_in_delta(100, hll.count, 3)
+
+    3.times { 100.times { |i| hll.add(i) } }
+    assert_in_delta(100, hll.count, 3)
+
+    ( 100...10_000 ).each { |i| hll.add("key#{i}") }
+    assert_in_delta(10_000, hll.count, 500)
+
+    hll = Stats::HyperLogLog.new
+    100_000.times { |i| hll.add(i) }
+    assert_in_delta(100_000, hll.count, 5_000)
+  end
+
+  def test_top_values_exact
+    top = Stats::TopValues.new(3)
+    %w[ a b a c a b ].each { |v| top.add(v) }
+    assert_equal([ [ 'a', 3, 0 ], [ 'b', 2, 0 ], [ 'c', 1, 0 ] ], top.top)
+    assert_equal([ [ 'a', 3, 0 ] ], top.top(1))
+  end
+
+  def test_top_values_error
+    top = Stats::TopValues.new(2)
+    %w[ a a a b c ].each { |v| top.add(v) }
+
+    # c replaced b and inherited its count as the error.
+    assert_equal([ [ 'a', 3, 0 ], [ 'c', 2, 1 ] ], top.top)
+  end
+
+  def test_top_values_bounds
+    top    = Stats::TopValues.new(10)
+    values = Array.new(1000) { |i| i % 7 == 0 ? 'hot' : "cold#{i}" }
+    values.each { |v| top.add(v) }
+
+    value, count, error = top.top(1).first
+    assert_equal('hot', value)
+    assert_operator(count - error, :<=, values.count('hot'))
+    assert_operator(count, :>=, values.count('hot'))
+  end
+
+  def test_field_profile_low_cardinality
+    # Value i occurs i + 1 times, added round robin so every value is seen
+    # before any is counted twice.
+    field    = Stats::FieldProfile.new('state')
+    distinct = Stats::LOW_CARDINALITY - 5
+    distinct.times do |round|
+      ( round...distinct ).each { |i| field.add(i) }
+    end
+    field.add(nil)
+
+    assert_equal(1, field.nulls)
+    top = field.top
+    assert_equal(Stats::TOP, top.size)
+    assert_equal([ distinct - 1, distinct ], top.first)
+    assert_equal([ distinct - 10, distinct - 9 ], top.last)
+  end
+
+  def test_field_profile_high_cardinality
+    field = Stats::FieldProfile.new('id')
+    1000.times { |i| field.add(i) }
+    assert_nil(field.top)
+    field.prune
+    assert_nil(field.top)
+  end
+
+  def test_index_profile_most_duplicated
+    index = Stats::IndexProfile.new('name_ndx', %w[ name ], true)
+    1000.times { |i| index.add("unique#{i}") }
+    3.times { index.add('dup') }
+
+    keys = index.most_duplicated.collect(&:first)
+    assert_equal([ 'dup' ], keys)
+
+    unique = Stats::IndexProfile.new('id_ndx', %w[ id ], false)
+    3.times { unique.add(1) }
+    assert_equal([], unique.most_duplicated)
+  end
+
+  def test_runs_do_not_overlap
+    fields = [ Field.new('id', 0, CT::INTEGER, 4, false) ]
+    rows   = Array.new(1000) { |i| [ i ] }
+    result, record = stats({ sample: 900 }, rows, fields, 0)
+
+    assert_equal(record.plucked.uniq, record.plucked)
+    assert_equal(record.plucked.size, result[:rows])
+  end
+
+  def test_record_length
+    fields = [ Field.new('id',   0, CT::INTEGER, 4, false),
+               Field.new('name', 1, CT::VARCHAR, 2, true),
+               Field.new('qty',  2, CT::INTEGER, 4, false),
+               Field.new('note', 3, CT::VARCHAR, 2, true) ]
+    result, = stats({}, [ [ 1, 'abc', 2, 'hello' ] ], fields, 4)
+
+    # 4 + 4 fixed, 2 + 3 and 2 + 5 variable.
+    assert_equal(20, result[:record_length][:max])
+  end
+
+  def test_format
+    stats = {
+      table: 'orders', records: 10, rows: 5,
+      record_length: { average: 12.5, max: 20 },
+      indexes: [ { name: 'id_ndx', distinct: 5, rows_per_key: 1.0,
+                   most_duplicated: [] },
+                 { name: 'name_ndx', distinct: 2, rows_per_key: 2.5,
+                   most_duplicated: [ { key: 'x', count: 3, error: 0 } ] } ],
+      fields: [ { name: 'name', distinct: 2, null_ratio: 0.2,
+                  top_values: [ { value: 'x', count: 3 } ] } ]
+    }
+    text = Stats.format(stats)
+    assert_match(/\Aorders: 10 records, 5 read \(sampled\)$/, text)
+    assert_match(/Record length: 12\.5 average, 20 max/, text)
+    assert_match(/id_ndx\s+5\s+1\.00  -$/, text)
+    assert_match(/name_ndx\s+2\s+2\.50  "x" x3$/, text)
+    assert_match(/name\s+2\s+20\.00%$/, text)
+    assert_match(/^\s+"x"\s+3$/, text)
+  end
+
+end
@@ -0,0 +1,99 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'tmpdir'
+require 'rbconfig'
+require 'ctdb/cli'
+
+# Generates, builds and loads the fixed layout extension for the test table
+# once, then checks its accessors against CT::Record.
+class TestCTLayout < Test::Unit::TestCase
+  include TestHelper
+
+  def self.build(config)
+    @build ||= begin
+      dir   = Dir.mktmpdir('ctdb_layout')
+      table = File.join(config[:table_path], config[:table_name])
+      cli   = CT::CLI.new([], 'server'   => config[:engine],
+                              'username' => config[:username],
+                              'password' => config[:password])
+      cli.dump_schema(table, dir + '/')
+
+      generator = CT::CLI::ModelGenerator.new(File.join(dir, "#{config[:table_name]}.yml"))
+      generator.write(dir)
+      ext = File.join(dir, generator.extension_name)
+      Dir.chdir(ext) do
+        system(RbConfig.ruby, 'extconf.rb', out: File::NULL) &&
+          system('make', out: File::NULL) or raise "Building #{ext} failed"
+      end
+      $:.unshift(ext)
+      require generator.extension_name
+      CT::Layout.const_get(generator.module_name)
+    end
+  end
+
+  def setup
+    @layout  = self.class.build(_c)
+    @session = CT::Session.new(CT::SESSION_CTREE)
+    @session.logon(_c[:engine], _c[:username], _c[:password])
+    @table = CT::Table.new(@session)
+    @table.path = _c[:table_path]
+    @table.open(_c[:table_name], CT::OPEN_NORMAL)
+    @record = CT::Record.new(@table).clear
+    @record.temporal_mode = :epoch
+    @record.numeric_mode  = :scaled
+    @record.first
+  end
+
+  def teardown
+    @table.close
+    @session.logout
+  end
+
+  def test_verify
+    assert_equal(true, @layout.verify!(@record))
+  end
+
+  def test_getters
+    %w[ uinteger integer smallint bool money date time chars ].each do |name|
+      assert_equal(@record.get_field(name), @layout.send("get_#{name}", @record),
+                   "get_#{name}")
+    end
+  end
+
+  def test_to_h
+    hash = @layout.to_h(@record)
+    assert_equal(@table.field_names, hash.keys)
+    assert_equal(@record.get_field("uinteger"), hash["uinteger"])
+  end
+
+  # A copy of the test table verifies until an alter changes its layout on
+  # the same table handle.
+  def test_verify_after_alter
+    name  = "#{_c[:table_name]}_layout"
+    table = CT::Table.new(@session)
+    @table.get_fields.each { |f| table.add_field(f.name, f.type, f.length) }
+    table.path = _c[:table_path]
+    table.create(name, CT::CREATE_NORMAL)
+    table.open(name, CT::OPEN_EXCLUSIVE)
+
+    record = CT::Record.new(table).clear
+    assert_equal(true, @layout.verify!(record))
+
+    table.add_field("extra", CT::INTEGER, 4)
+    table.alter(CT::DB_ALTER_NORMAL)
+    assert_raise(CT::Error) { @layout.verify!(record) }
+    assert_raise(CT::Error) { @layout.get_integer(record) }
+  ensure
+    table.close if table && table.open?
+    Dir[File.join(_c[:table_path], "#{name}.*")].each { |f| File.delete(f) }
+  end
+
+  def test_setters
+    @layout.set_integer(@record, -42)
+    assert_equal(-42, @record.get_field("integer"))
+    @layout.set_money(@record, 1999)
+    assert_equal(1999, @record.get_field("money"))
+    assert_raise(RangeError) { @layout.set_money(@record, 2**32 + 1999) }
+    assert_equal(1999, @record.get_field("money"))
+  end
+
+end
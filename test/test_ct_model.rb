@@ -1,4 +1,5 @@
 require File.dirname(__FILE__) + '/test_helper'
+require 'tmpdir'
 
 class TestCTModel < Test::Unit::TestCase
   include TestHelper
@@ -87,6 +88,120 @@ class TestCTModel < Test::Unit::TestCase
     assert_equal(false, @model.dirty?)
   end
 
+  def test_table_slot
+    table = TestModel.table
+    assert_same(table, TestModel.table)
+    assert_same(table, CT::Model.session.slots[TestModel.table_slot])
+  end
+
+  def test_ractor_session
+    return unless defined?(Ractor)
+
+    expected = TestModel.first.uinteger
+    ractor = Ractor.new do
+      model = TestHelper::TestModel.first
+      [ model.uinteger, CT::Model.session_pool.equal?(nil) ]
+    end
+    assert_equal([expected, false], ractor.take)
+  end
+
+  def test_ractor_decimal_and_date
+    return unless defined?(Ractor)
+
+    ractor = Ractor.new do
+      rows = CT::Query.new(TestHelper::TestModel.table).temporal_mode(:core)
+                      .numeric_mode(:decimal).pluck(:money, :date)
+      rows.find { |money, date| money && date }.collect(&:class)
+    end
+    assert_equal([ BigDecimal, Date ], ractor.take)
+  end
+
+  def test_schema
+    schema = TestModel.schema
+    assert_instance_of(CT::Schema, schema)
+    assert(schema.frozen?)
+    assert_same(schema, TestModel.schema)
+    assert_equal(TestModel.table.field_names, schema.field_names)
+    assert_equal(['uinteger'], schema.index(:index_on_uinteger).field_names)
+    assert(schema.field(:uinteger).unsigned_integer?)
+  end
+
+  def test_schema_snapshot
+    live = CT::Schema.capture(TestModel.table)
+    path = File.join(Dir.tmpdir, "ctdb_schema_#{$$}.bin")
+    CT::Schema.compile([ live ], path)
+
+    CT::Model.schema_snapshot = path
+    assert_equal([], CT::Schema.load(path).first.diff(live))
+    assert_equal(live.field_names, TestModel.schema.field_names)
+    assert_equal(live.table_name, TestModel.schema.table_name)
+    assert_nothing_raised { TestModel.first }
+
+    h = live.to_h
+    h[:fields].first[:length] += 1
+    CT::Schema.compile([ CT::Schema.from_h(h) ], path)
+    CT::Model.schema_snapshot = path
+    TestModel.session.slots[TestModel.table_slot] = nil
+    assert_raise(CT::SchemaMismatch) { TestModel.table }
+  ensure
+    CT::Model.schema_snapshot = nil
+    File.delete(path) if path && File.exist?(path)
+  end
+
+  def test_schema_diff_indexes
+    index = ->(name, number) {
+      { name: name, number: number, allow_dups: false, key_length: 4,
+        segments: [ { number: 0, field_name: 'uinteger', mode: CT::SEG_SCHSEG } ] }
+    }
+    schema = ->(*names) {
+      CT::Schema.from_h(table_path: '', table_name: 't',
+                        fields: [ { name: 'uinteger', number: 0, type: CT::UINTEGER,
+                                    length: 4 } ],
+                        indexes: names.each_with_index.collect(&index))
+    }
+
+    assert_equal([], schema.('a', 'b').diff(schema.('a', 'b')))
+    assert_equal([ 'indexes ["a"] != ["a", "b"]', 'index b unexpected' ],
+                 schema.('a').diff(schema.('a', 'b')))
+    assert_equal([ 'indexes ["a", "b"] != ["b", "a"]' ],
+                 schema.('a', 'b').diff(schema.('b', 'a')))
+  end
+
+  def test_preload!
+    assert_equal([TestModel], CT::Model.preload!(TestModel))
+    assert_not_nil(TestModel.instance_variable_get(:@schema))
+  end
+
+  def test_release_session
+    app = CT::ReleaseSession.new(->(env) { [ 200, {}, [ TestModel.first.uinteger.to_s ] ] })
+    Thread.new { app.call({}) }.join
+    TestModel.first
+    assert_equal(1, CT::Model.session_pool.stat[:busy])
+    CT::Model.release_session
+    assert_equal(0, CT::Model.session_pool.stat[:busy])
+  end
+
+  def test_fork
+    parent = TestModel.session
+    assert(parent.active?)
+
+    reader, writer = IO.pipe
+    pid = fork do
+      reader.close
+      child = TestModel.session
+      writer.write([ parent.active?, child.equal?(parent), child.active?,
+                     !TestModel.first.nil? ].inspect)
+      writer.close
+      exit!(0)
+    end
+    writer.close
+    Process.wait(pid)
+
+    assert_equal([ false, false, true, true ].inspect, reader.read)
+    assert(parent.active?)
+    assert_not_nil(TestModel.first)
+  end
+
   def test_count
     assert_instance_of(Fixnum, TestModel.count)
   end
@@ -110,6 +225,120 @@ class TestCTModel < Test::Unit::TestCase
     end
   end
 
+  def test_find_in_batches
+    batches = []
+    TestModel.find_in_batches(batch_size: 2) do |batch|
+      assert(batch.size <= 2)
+      batches << batch.collect(&:uinteger)
+    end
+    assert_equal([1, 2], batches.first)
+    assert_equal((1..batches.flatten.size).to_a, batches.flatten)
+  end
+
+  def test_find_each_with_start
+    ids = TestModel.find_each(start: { uinteger: 2 }).collect(&:uinteger)
+    assert_equal([2, 3], ids.first(2))
+  end
+
+  def test_unit_of_work
+    varchar = nil
+    TestModel.unit_of_work do |map|
+      a = TestModel.find_by(:index_on_uinteger, {uinteger: 1})
+      b = TestModel.find(index: :index_on_uinteger).first
+      assert_same(a, b)
+      assert_same(a, TestModel.find_by(:index_on_uinteger, {uinteger: 1}))
+      varchar = a.varchar = "unit of work #{rand(1000)}"
+      assert(a.save)
+      assert(a.dirty?)
+      assert_same(map, CT::IdentityMap.current)
+    end
+    assert_nil(CT::IdentityMap.current)
+
+    @model = TestModel.find_by(:index_on_uinteger, {uinteger: 1})
+    assert_equal(varchar, @model.varchar)
+    assert_equal(false, @model.dirty?)
+  end
+
+  def test_unit_of_work_discards_on_error
+    original = TestModel.find_by(:index_on_uinteger, {uinteger: 1}).varchar
+    assert_raise(RuntimeError) do
+      TestModel.unit_of_work do
+        TestModel.find_by(:index_on_uinteger, {uinteger: 1}).varchar = "lost"
+        raise "rollback"
+      end
+    end
+    assert_nil(CT::IdentityMap.current)
+    assert_equal(original, 
+                 TestModel.find_by(:index_on_uinteger, {uinteger: 1}).varchar)
+  end
+
+  def test_unit_of_work_defers_destroy
+    assert_raise(RuntimeError) do
+      TestModel.unit_of_work do
+        model = TestModel.find_by(:index_on_uinteger, {uinteger: 1})
+        assert(model.destroy)
+        assert_equal(false, model.destroyed?)
+        raise "rollback"
+      end
+    end
+    assert_not_nil(TestModel.find_by(:index_on_uinteger, {uinteger: 1}))
+  end
+
+  def test_identity_map_flush_failure_keeps_changes
+    a = TestModel.find_by(:index_on_uinteger, {uinteger: 1})
+    b = TestModel.find_by(:index_on_uinteger, {uinteger: 2})
+    original = a.varchar
+    a.varchar = b.varchar = "not written #{rand(1000)}"
+    b.define_singleton_method(:write_record) { raise CT::Error.new("[0] failed") }
+
+    map = CT::IdentityMap.new
+    map.add(a)
+    map.add(b)
+    assert_raise(CT::Error) { map.flush(TestModel.session) }
+    assert(a.dirty?)
+    assert(b.dirty?)
+    assert_equal(original,
+                 TestModel.find_by(:index_on_uinteger, {uinteger: 1}).varchar)
+  end
+
+  def test_identity_map_rekeys_changed_primary_key
+    map   = CT::IdentityMap.new
+    model = TestModel.new(@fixture)
+    model.uinteger = 100
+    map.add(model)
+    model.uinteger = 101
+    map.add(model)
+    assert_nil(map.get(TestModel, model.primary_key_values.tap { |v| v[0] = 100 }))
+    assert_same(model, map.get(TestModel, model.primary_key_values))
+    assert_equal(1, map.size)
+  end
+
+  def test_preload
+    models = TestModel.all.first(3)
+    assert_equal(models, TestModel.preload(models, :self_ref, :self_refs))
+    models.each do |m|
+      assert_equal(m.uinteger, m.self_ref.uinteger)
+      assert_equal([m.uinteger], m.self_refs.collect(&:uinteger))
+    end
+    assert_raise(ArgumentError) { TestModel.preload(models, :unknown) }
+  end
+
+  def test_preload_segment_order
+    segment = CT::Schema::Segment.new(0, "varchar",
+                                      CT::SEG_USCHSEG | CT::SEG_DESCENDING)
+    assert(segment.descending?)
+    assert(segment.uppercase?)
+    assert_equal(false, segment.alternate_collation?)
+    assert_equal(false, CT::Schema::Segment.new(0, "f", CT::SEG_SCHSEG).descending?)
+  end
+
+  def test_query_preload
+    TestModel.find.preload(:self_ref).all.each do |m|
+      assert(m.send(:association_cache).key?('self_ref'))
+      assert_equal(m.uinteger, m.self_ref.uinteger)
+    end
+  end
+
   def test_each
     n = 0
     TestModel.each do |obj|
@@ -106,6 +106,43 @@ class TestQuery < Test::Unit::TestCase
     #end
   end
 
+  def test_pluck
+    assert_equal([1, 2, 3], @query.pluck(:uinteger).first(3))
+    rows = @query.index(:"#{_c[:index_name]}").pluck('uinteger', 'chars')
+    assert_instance_of(Array, rows.first)
+    assert_equal([1, 2, 3], rows.first(3).collect(&:first))
+    assert_equal([], CT::Query.new(@table).filter(%Q[fpstring == 'X']).pluck(:uinteger))
+  end
+
+  def test_sum
+    assert_equal(@query.pluck(:uinteger).sum, @query.sum(:uinteger))
+    cents = CT::Query.new(@table).numeric_mode(:scaled).pluck(:money).compact.sum
+    assert_equal(cents, CT::Query.new(@table).numeric_mode(:scaled).sum(:money))
+    assert_equal(0, CT::Query.new(@table).filter(%Q[fpstring == 'X']).sum(:uinteger))
+  end
+
+  def test_find_each
+    n = 0
+    @query.find_each do |record|
+      assert_instance_of(CT::Record, record)
+      assert_equal(n+=1, record.get_field('uinteger'))
+    end
+    assert_equal(3, n)
+  end
+
+  def test_find_in_batches_from_start_key
+    seen = []
+    @query.index(:"#{_c[:index_name]}")
+          .find_in_batches(batch_size: 1, start: { uinteger: 2 }) do |batch|
+      assert_equal(1, batch.size)
+      seen << batch.first.get_field('uinteger')
+    end
+    assert_equal([2, 3], seen)
+    assert_raise(CT::InvalidQuery) do
+      CT::Query.new(@table).find_in_batches(start: { uinteger: 2 }) { }
+    end
+  end
+
   private
 
     def primary_index_query(uinteger)
@@ -18,6 +18,32 @@ class TestCTRecord < Test::Unit::TestCase
     @session.logout
   end
 
+  def test_memsize
+    require 'objspace'
+    @r = CT::Record.new(@table).clear
+    assert_operator(ObjectSpace.memsize_of(@r), :>, ObjectSpace.memsize_of(CT::Date.today))
+    assert_raise(TypeError) { CT::Record.new(@session) }
+  end
+
+  def test_owners_outlive_records
+    session = CT::Session.new(CT::SESSION_CTREE)
+    session.logon(_c[:engine], _c[:username], _c[:password])
+    table = CT::Table.new(session)
+    table.path = _c[:table_path]
+    table.open(_c[:table_name], CT::OPEN_NORMAL)
+    record = CT::Record.new(table)
+    fields = table.get_fields
+
+    session = table = nil
+    GC.start
+    GC.compact if GC.respond_to?(:compact)
+
+    assert_not_nil(record.first)
+    assert_instance_of(String, fields.first.name)
+    record = fields = nil
+    assert_nothing_raised { GC.start }
+  end
+
   def test_create
     (0..2).each do |n|
       x  = fixtures[n]
@@ -195,6 +221,136 @@ class TestCTRecord < Test::Unit::TestCase
     assert_nil(@r.prev) # => end of file
   end
 
+  def test_temporal_mode
+    @r = CT::Record.new(@table).clear
+    @r.first
+    assert_equal(:ct, @r.temporal_mode)
+    ct_date = @r.get_field("date")
+    ct_stamp = @r.get_field("timestamp")
+
+    @r.temporal_mode = :core
+    assert_equal(ct_date.to_date, @r.get_field("date"))
+    assert_equal(ct_stamp.to_datetime, @r.get_field("timestamp"))
+    assert_instance_of(::Time, @r.get_field("time"))
+
+    @r.temporal_mode = :epoch
+    assert_equal((ct_date.to_date - Date.new(1970, 1, 1)).to_i * 86400,
+                 @r.get_field("date"))
+    assert_equal(ct_stamp.to_datetime.to_time.to_i, @r.get_field("timestamp"))
+    assert_equal(@r.get_field("date"), @r.duplicate.get_field("date"))
+
+    assert_raise(ArgumentError) { @r.temporal_mode = :unix }
+  end
+
+  def test_numeric_mode
+    require 'bigdecimal'
+    @r = CT::Record.new(@table).clear
+    @r.first
+    assert_equal(:float, @r.numeric_mode)
+    assert_equal(fixtures[0]["bigint"], @r.get_field_as_bigint("bigint"))
+    money = @r.get_field("money")
+    currency = @r.get_field("currency")
+
+    @r.numeric_mode = :decimal
+    assert_equal(BigDecimal(money.to_s), @r.get_field("money"))
+    assert_equal(BigDecimal(currency.to_s), @r.get_field("currency"))
+    assert_instance_of(BigDecimal, @r.get_field_as_money("money"))
+    assert_equal(BigDecimal(money.to_s), @r.get_field_as_money("money"))
+    assert_equal(BigDecimal(currency.to_s), @r.get_field_as_currency("currency"))
+
+    @r.numeric_mode = :scaled
+    assert_equal((money * 100).round, @r.get_field("money"))
+    assert_equal((currency * 10_000).round, @r.get_field("currency"))
+    assert_equal((money * 100).round, @r.get_field_as_money("money"))
+    assert_equal((currency * 10_000).round, @r.get_field_as_currency("currency"))
+    @r.set_field("money", 1999)
+    assert_equal(1999, @r.get_field("money"))
+    assert_equal(1999, @r.duplicate.get_field("money"))
+    @r.set_field("money", 2**31 - 1)
+    assert_equal(2**31 - 1, @r.get_field("money"))
+    assert_raise(RangeError) { @r.set_field("money", 2**31) }
+    assert_raise(RangeError) { @r.set_field("money", -2**31 - 1) }
+    assert_equal(2**31 - 1, @r.get_field("money"))
+
+    @r.numeric_mode = :decimal
+    @r.set_field("money", BigDecimal("0.1") + BigDecimal("0.2"))
+    assert_equal(BigDecimal("0.3"), @r.get_field("money"))
+
+    assert_raise(ArgumentError) { @r.numeric_mode = :rational }
+  end
+
+  def test_field_io
+    require 'stringio'
+    @r = CT::Record.new(@table).clear
+    data = "head\0" + ("x" * 70_000) + "\0tail"
+    @r.field_io("lvb", "w") do |io|
+      data.scan(/.{1,4096}/m).each { |chunk| io << chunk }
+    end
+    assert_equal(data.b, @r.get_field("lvb"))
+
+    io = @r.field_io("lvb")
+    assert_equal(data.bytesize, io.size)
+    assert_equal("head\0".b, io.read(5))
+    io.seek(-5, IO::SEEK_END)
+    assert_equal("\0tail".b, io.read)
+    assert_nil(io.read(1))
+    io.rewind
+    out = StringIO.new
+    IO.copy_stream(io, out)
+    assert_equal(data.b, out.string)
+    io.close
+    assert_raise(IOError) { io.read }
+    assert_raise(TypeError) { @r.field_io("chars") }
+  end
+
+  def test_set_fixed_string
+    @r = CT::Record.new(@table).clear
+    value = "abc".freeze
+    assert_nothing_raised { @r.set_field("chars", value) }
+    assert_equal("abc", value)
+    assert_equal("abc", @r.get_field("chars"))
+    assert_equal("abc" + @table.pad_char * 28, @r.get_field_as_binary("chars")[0, 31])
+  end
+
+  def test_sum
+    @r = CT::Record.new(@table).clear
+    @r.numeric_mode = :scaled
+    @r.first
+    cents = @r.pluck(["money"]).compact.sum
+    @r.first
+    assert_equal(cents, @r.sum("money"))
+    @r.first
+    total = @r.pluck(["uinteger"]).compact.sum
+    @r.first
+    assert_equal(total, @r.sum(:uinteger))
+    assert_raise(TypeError) { @r.sum("chars") }
+  end
+
+  def test_pluck
+    assert_nothing_raised { @r = CT::Record.new(@table) }
+    assert_nothing_raised { @r.clear }
+    assert_nothing_raised { @r.first }
+    assert_equal([1, 2], @r.pluck(['uinteger'], 2))
+    assert_equal(2, @r.get_field('uinteger'))
+    assert_not_nil(@r.next)
+    rows = @r.pluck([:uinteger, :chars])
+    assert_equal(3, rows.first.first)
+    assert_equal(fixtures[2]['chars'], rows.first.last)
+    assert_raise(ArgumentError) { @r.pluck([]) }
+  end
+
+  def test_find_many
+    assert_nothing_raised { @r = CT::Record.new(@table) }
+    rows = @r.find_many([3, { 'uinteger' => 1 }, 999, 3], 
+                        index: 'index_on_uinteger')
+    assert_equal(4, rows.size)
+    assert_equal(3, rows[0]['uinteger'])
+    assert_equal(fixtures[0]['chars'], rows[1]['chars'])
+    assert_nil(rows[2])
+    assert_equal(rows[0], rows[3])
+    assert_equal([], @r.find_many([], index: 'index_on_uinteger'))
+  end
+
   #def test_record_set
     #assert_nothing_raised { @r = CT::Record.new(@table) }
     #assert_nothing_raised { @r.clear }
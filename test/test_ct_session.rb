@@ -48,4 +48,20 @@ class TestCTSession < Test::Unit::TestCase
     assert_nothing_raised { @session.logout }
   end
 
+  def test_transaction
+    assert_nothing_raised { @session = CT::Session.new(CT::SESSION_CTREE) }
+    assert_nothing_raised do
+      @session.logon(_c[:engine], _c[:username], _c[:password])
+    end
+    assert_equal(false, @session.transaction_active?)
+    assert_equal(:done, @session.transaction { 
+      assert(@session.transaction_active?)
+      :done
+    })
+    assert_equal(false, @session.transaction_active?)
+    assert_raise(RuntimeError) { @session.transaction { raise "abort" } }
+    assert_equal(false, @session.transaction_active?)
+    assert_nothing_raised { @session.logout }
+  end
+
 end
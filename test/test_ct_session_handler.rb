@@ -24,4 +24,17 @@ class CTTestSessionHandler < Test::Unit::TestCase
     assert_equal(1, @session_handler.open_tables.size)
   end
 
+  def test_open_slot
+    table = @session_handler.open_slot(3, TestModel.table_path, 
+                                          TestModel.table_name)
+    assert_same(table, @session_handler.slots[3])
+    assert_same(table, @session_handler.open_table(TestModel.table_path,
+                                                   TestModel.table_name))
+    table.close
+    reopened = @session_handler.open_slot(3, TestModel.table_path, 
+                                             TestModel.table_name)
+    assert(reopened.active?)
+    assert_not_same(table, reopened)
+  end
+
 end
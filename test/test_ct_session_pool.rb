@@ -0,0 +1,100 @@
+require File.dirname(__FILE__) + '/test_helper'
+
+class TestCTSessionPool < Test::Unit::TestCase
+  include TestHelper
+
+  def setup
+    @pool = CT::SessionPool.new(_c.merge(pool: 2, checkout_timeout: 0.2))
+  end
+
+  def teardown
+    @pool.disconnect!
+  end
+
+  def test_lazy_logon
+    assert_equal(0, @pool.stat[:connections])
+    assert_instance_of(CT::SessionHandler, @pool.current)
+    assert(@pool.current.active?)
+    assert_equal(1, @pool.stat[:connections])
+  end
+
+  def test_thread_affinity
+    handler = @pool.checkout
+    assert_same(handler, @pool.checkout)
+    assert_same(handler, @pool.current)
+    other = Thread.new { @pool.with_session { |h| h } }.value
+    assert_not_same(handler, other)
+    assert_equal(1, @pool.stat[:busy])
+  end
+
+  def test_checkin
+    handler = @pool.checkout
+    @pool.checkin
+    assert_equal(0, @pool.stat[:busy])
+    assert_same(handler, Thread.new { @pool.current }.value)
+  end
+
+  def test_checkout_timeout
+    2.times { Thread.new { @pool.with_session { sleep(0.5) } } }
+    sleep(0.1)
+    assert_raise(CT::CheckoutTimeout) { @pool.checkout }
+  end
+
+  def test_reclaims_dead_threads
+    2.times { Thread.new { @pool.current }.join }
+    assert_instance_of(CT::SessionHandler, @pool.checkout)
+    assert_equal(2, @pool.stat[:connections])
+  end
+
+  def test_discards_dead_threads_mid_transaction
+    pool = CT::SessionPool.new(_c.merge(pool: 1, checkout_timeout: 0.2))
+    dead = Thread.new {
+      pool.current.tap { |h| h.session.begin_transaction }
+    }.value
+    handler = pool.checkout
+    assert_not_same(dead, handler)
+    assert(!dead.active?)
+    assert(!handler.pending?)
+    assert_equal(1, pool.stat[:connections])
+  ensure
+    pool.disconnect!
+  end
+
+  def test_release_frees_live_threads
+    done  = Queue.new
+    holds = 2.times.collect {
+      Thread.new { @pool.current; @pool.release; done << true; sleep(0.5) }
+    }
+    2.times { done.pop }
+    assert_equal(0, @pool.stat[:busy])
+    assert_instance_of(CT::SessionHandler, @pool.checkout)
+    holds.each(&:kill)
+  end
+
+  def test_reap_idle
+    pool    = CT::SessionPool.new(_c.merge(idle_timeout: 0))
+    handler = pool.with_session { |h| h }
+    assert_equal(1, pool.stat[:idle])
+
+    # Logging out happens after the monitor is released.
+    monitor = pool.instance_variable_get(:@monitor)
+    owned   = nil
+    handler.define_singleton_method(:disconnect) do
+      owned = monitor.mon_owned?
+      super()
+    end
+    pool.reap
+    assert_equal(false, owned)
+    assert_equal(0, pool.stat[:idle])
+    assert_equal(0, pool.stat[:connections])
+  end
+
+  def test_disconnect_stops_reaper
+    pool   = CT::SessionPool.new(_c.merge(reaping_frequency: 0.01))
+    reaper = pool.instance_variable_get(:@reaper)
+    assert(reaper.alive?)
+    pool.disconnect!
+    assert(!reaper.alive?)
+  end
+
+end
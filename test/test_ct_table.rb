@@ -85,6 +85,31 @@ class TestCTTable < Test::Unit::TestCase
     assert_nothing_raised { @table.close }
   end
 
+  def test_delete_index
+    @table = CT::Table.new(@session)
+    @table.path = _c[:table_path]
+    @table.open(_c[:table_name], CT::OPEN_EXCLUSIVE)
+
+    index = @table.add_index("integer_ndx", CT::INDEX_FIXED, allow_dups: true,
+                                                            allow_nil: false)
+    index.add_segment(@table.get_field("integer"), CT::SEG_SCHSEG)
+    @table.alter(CT::DB_ALTER_NORMAL)
+    assert_equal(2, @table.indecies.size)
+    assert(@table.get_index("integer_ndx").allow_dups?)
+    assert_equal(false, @table.get_index("integer_ndx").allow_nil?)
+
+    stale = @table.get_index("integer_ndx")
+    assert_nothing_raised { @table.delete_index("integer_ndx") }
+    assert_raise(CT::Error) { stale.name }
+    @table.alter(CT::DB_ALTER_NORMAL)
+    assert_equal(1, @table.indecies.size)
+    assert_raise(CT::Error) { @table.get_index("integer_ndx") }
+
+    assert_nothing_raised { @table.rebuild(CT::DB_REBUILD_INDEX) }
+  ensure
+    @table.close if @table && @table.open?
+  end
+
   def test_table_attributes
     assert_nothing_raised { @table = CT::Table.new(@session) }
     assert_nothing_raised { @table.path = _c[:table_path] }
@@ -100,4 +125,47 @@ class TestCTTable < Test::Unit::TestCase
     assert_nothing_raised { @table.close }
   end
 
+  def test_open_exclusive
+    @table = CT::Table.new(@session)
+    @table.path = _c[:table_path]
+    @table.open(_c[:table_name], CT::OPEN_EXCLUSIVE)
+
+    other = CT::Session.new(CT::SESSION_CTREE)
+    other.logon(_c[:engine], _c[:username], _c[:password])
+    shared = CT::Table.new(other)
+    shared.path = _c[:table_path]
+    assert_raise(CT::Error) { shared.open(_c[:table_name], CT::OPEN_NORMAL) }
+    assert_raise(TypeError) { @table.open(_c[:table_name], "normal") }
+  ensure
+    @table.close if @table.open?
+    other.logout if other
+  end
+
+  def test_metadata_cache
+    @table = CT::Table.new(@session)
+    @table.path = _c[:table_path]
+    @table.open(_c[:table_name], CT::OPEN_NORMAL)
+
+    fields = @table.get_fields
+    assert(fields.frozen?)
+    assert(fields.all?(&:frozen?))
+    assert_same(fields, @table.fields)
+    assert_same(fields.first, @table.get_field(0))
+    assert_same(fields.first, @table.get_field_by_name(fields.first.name))
+
+    index = @table.indecies.first
+    assert_same(index, @table.get_index(0))
+    assert_same(index.segments, index.segments)
+    assert_same(index.segments.first.field, index.get_segment(0).field)
+    assert_raise(FrozenError) { index.allow_dups = true }
+
+    @table.close
+    assert_raise(CT::Error) { fields.first.name }
+    assert_raise(CT::Error) { index.segments.first.field_name }
+    @table.open(_c[:table_name], CT::OPEN_NORMAL)
+    assert_not_same(fields, @table.get_fields)
+    assert_equal(fields.size, @table.get_fields.size)
+    @table.close
+  end
+
 end
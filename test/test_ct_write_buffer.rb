@@ -0,0 +1,59 @@
+require File.dirname(__FILE__) + '/test_helper'
+require 'timeout'
+
+class TestCTWriteBuffer < Test::Unit::TestCase
+  include TestHelper
+
+  def setup
+    CT::Model.session ||= _c
+    @fixture = fixtures[0].dup
+    @buffer  = CT::WriteBuffer.new(TestModel, batch_size: 2, capacity: 4,
+                 on_error: lambda { |row, e| (@errors ||= []) << row })
+  end
+
+  def teardown
+    @buffer.close
+  end
+
+  def test_flush
+    base = TestModel.last.uinteger
+    3.times { |n| @buffer << @fixture.merge('uinteger' => base + n + 1) }
+    assert_nothing_raised { @buffer.flush! }
+    assert_equal(3, @buffer.written)
+    assert_equal(0, @buffer.pending)
+    assert_not_nil(TestModel.find_by(:index_on_uinteger, uinteger: base + 3))
+  end
+
+  def test_row_errors
+    existing = TestModel.first.uinteger
+    @buffer << @fixture.merge('uinteger' => existing)
+    @buffer.flush!
+    assert_equal(1, @buffer.failed)
+    assert_equal(existing, @errors.first['uinteger'])
+  end
+
+  def test_closed
+    @buffer.close
+    assert_raise(CT::Error) { @buffer << @fixture }
+  end
+
+  def test_flush_after_close
+    @buffer.close
+    assert_nothing_raised { Timeout.timeout(2) { @buffer.flush! } }
+  end
+
+  def test_push_blocked_by_close
+    base = TestModel.last.uinteger
+    rows = 8.times.collect { |n| @fixture.merge('uinteger' => base + n + 1) }
+    pushers = rows.collect { |row|
+      Thread.new { begin; @buffer << row; :queued; rescue CT::Error; :refused; end }
+    }
+    @buffer.close
+    results = pushers.collect(&:value)
+
+    # Every row was written, reported or refused, none silently dropped.
+    accounted = @buffer.written + @buffer.failed + results.count(:refused)
+    assert_equal(rows.size, accounted)
+  end
+
+end
@@ -27,6 +27,13 @@ module TestHelper
     self.table_name    = :test_ctdb_rb
     self.table_path    = File.expand_path(File.dirname(__FILE__))
     self.primary_index = :index_on_uinteger, { increment: :uinteger }
+
+    belongs_to :self_ref, class_name: 'TestHelper::TestModel', 
+                          foreign_key: :uinteger
+    has_many :self_refs, class_name: 'TestHelper::TestModel', 
+                         foreign_key: :uinteger,
+                         primary_key: :uinteger,
+                         index: :index_on_uinteger
   end
 
 end
@@ -10,8 +10,17 @@ fi
 rm test_ctdb_rb.*
 ruby test_ct_data_types.rb
 ruby test_ct_session.rb
+ruby test_ct_session_pool.rb
 ruby test_ct_table.rb
 ruby test_ct_field.rb
 ruby test_ct_record.rb
 ruby test_ct_query.rb
 ruby test_ct_model.rb
+ruby test_ct_layout.rb
+ruby test_ct_write_buffer.rb
+ruby test_ct_async.rb
+ruby test_ct_cli_progress.rb
+ruby test_ct_cli_exporter.rb
+ruby test_ct_cli_importer.rb
+ruby test_ct_cli_bench.rb
+ruby test_ct_cli_stats.rb